@@ -0,0 +1,694 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+#include <limits>
+#include <iostream>
+#include <sstream>
+
+#include "scoped.hpp"
+#include "util_misc.hpp"
+#include "util_bench.hpp"
+#include "util_progcache.hpp"
+#include "pure_macro.hpp"
+
+#include "rendVertAttr.hpp"
+#include "rendVertLayout.hpp"
+
+using util::scoped_ptr;
+using util::scoped_functor;
+using util::deinit_resources_t;
+
+namespace {
+
+struct Vertex {
+	GLfloat pos[2];
+};
+
+} // namespace
+
+template <>
+const rend::VertAttrFormat rend::VertexLayout< Vertex >::attr[] = {
+	REND_VERT_ATTR(Vertex, pos, vertex, GL_FALSE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< Vertex >::count = REND_VERT_LAYOUT_COUNT(Vertex);
+
+namespace hook {
+
+static const char* arg_prefix    = "-";
+static const char* arg_app       = "app";
+
+static const char* arg_layers    = "layers";
+static const char* arg_blend     = "blend";
+static const char* arg_depth     = "depth";
+static const char* arg_alu       = "alu";
+static const char* arg_budget_ms = "budget_ms";
+static const char* arg_warmup    = "warmup";
+static const char* arg_frames    = "frames";
+
+static const char scene_name[] = "fillrate";
+
+static const char* const toggle_name[] = {
+	"off",
+	"on"
+};
+
+static const unsigned max_list_len = 16;
+
+struct ParamList {
+	unsigned value[max_list_len];
+	unsigned count;
+};
+
+static ParamList g_layers = { { 1, 2, 4, 8, 16, 32, 64 }, 7 };
+static ParamList g_blend  = { { 0, 1 }, 2 };
+static ParamList g_depth  = { { 0, 1 }, 2 };
+static ParamList g_alu    = { { 0, 8, 32 }, 3 };
+
+static float g_budget_ms = 1000.f / 60.f;
+static unsigned g_warmup = 8;
+static unsigned g_frames = 32;
+
+#if PLATFORM_GLX == 0
+static EGLDisplay g_display = EGL_NO_DISPLAY;
+static EGLContext g_context = EGL_NO_CONTEXT;
+
+#endif
+#if PLATFORM_GLES
+#if PLATFORM_GL_OES_vertex_array_object
+static PFNGLBINDVERTEXARRAYOESPROC    glBindVertexArrayOES;
+static PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOES;
+static PFNGLGENVERTEXARRAYSOESPROC    glGenVertexArraysOES;
+static PFNGLISVERTEXARRAYOESPROC      glIsVertexArrayOES;
+
+#endif
+#endif
+// one program per entry in the alu list
+enum {
+	PROG_COUNT = max_list_len,
+	PROG_FORCE_UINT = -1U
+};
+
+enum {
+	UNI_DEPTH,
+	UNI_COLOR,
+
+	UNI_COUNT,
+	UNI_FORCE_UINT = -1U
+};
+
+enum {
+	VBO_QUAD_VTX,
+
+	VBO_COUNT,
+	VBO_FORCE_UINT = -1U
+};
+
+static GLint g_uni[PROG_COUNT][UNI_COUNT];
+
+#if PLATFORM_GL_OES_vertex_array_object
+static GLuint g_vao[PROG_COUNT];
+
+#endif
+static GLuint g_vbo[VBO_COUNT];
+static GLuint g_shader_vert[PROG_COUNT];
+static GLuint g_shader_frag[PROG_COUNT];
+static GLuint g_shader_prog[PROG_COUNT];
+
+static rend::ActiveAttrSemantics g_active_attr_semantics[PROG_COUNT];
+
+// sweep state
+static unsigned g_config;
+static unsigned g_config_count;
+static bool g_config_ready;
+
+// per-group (all layer counts of a blend/depth/alu combination) tracking of the budget crossing
+static unsigned g_crossing_layers;
+static double g_peak_pixels_per_s;
+
+static util::BenchPhase* g_phase;
+
+struct Config {
+	unsigned layers;
+	unsigned blend;
+	unsigned depth;
+	unsigned alu; // index into the alu list
+};
+
+// decompose a linear config index; layers is the innermost dimension so that each group can be
+// searched for the layer count at which the frame time crosses the budget
+static Config get_config(
+	const unsigned index)
+{
+	unsigned i = index;
+	Config c;
+
+	c.layers = g_layers.value[i % g_layers.count]; i /= g_layers.count;
+	c.blend  = g_blend.value[i % g_blend.count];   i /= g_blend.count;
+	c.depth  = g_depth.value[i % g_depth.count];   i /= g_depth.count;
+	c.alu    = i % g_alu.count;
+
+	return c;
+}
+
+bool set_num_drawcalls(
+	const unsigned)
+{
+	return false;
+}
+
+unsigned get_num_drawcalls()
+{
+	return g_layers.value[g_layers.count - 1];
+}
+
+bool requires_depth()
+{
+	return std::find(g_depth.value, g_depth.value + g_depth.count, 1U) != g_depth.value + g_depth.count;
+}
+
+bool parse_cli(
+    const unsigned argc,
+    const char* const* argv)
+{
+	bool cli_err = false;
+	const unsigned prefix_len = strlen(arg_prefix);
+
+	for (unsigned i = 1; i < argc && !cli_err; ++i) {
+		if (strncmp(argv[i], arg_prefix, prefix_len) ||
+			strcmp(argv[i] + prefix_len, arg_app)) {
+			continue;
+		}
+
+		if (++i < argc) {
+			if (i + 1 < argc && !strcmp(argv[i], arg_layers)) {
+				if (0 != (g_layers.count = util::parseUintList(argv[i + 1], g_layers.value, max_list_len)) &&
+					0 != *std::min_element(g_layers.value, g_layers.value + g_layers.count)) {
+
+					std::sort(g_layers.value, g_layers.value + g_layers.count);
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_blend)) {
+				if (0 != (g_blend.count = util::parseNameList(argv[i + 1],
+						toggle_name, sizeof(toggle_name) / sizeof(toggle_name[0]), g_blend.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_depth)) {
+				if (0 != (g_depth.count = util::parseNameList(argv[i + 1],
+						toggle_name, sizeof(toggle_name) / sizeof(toggle_name[0]), g_depth.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_alu)) {
+				if (0 != (g_alu.count = util::parseUintList(argv[i + 1], g_alu.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_budget_ms)) {
+				if (1 == sscanf(argv[i + 1], "%f", &g_budget_ms) && 0.f < g_budget_ms) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_warmup)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_warmup)) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_frames)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_frames) && 0 < g_frames) {
+					i += 1;
+					continue;
+				}
+			}
+		}
+
+		cli_err = true;
+	}
+
+	if (cli_err) {
+		std::cerr << "app options:\n"
+			"\t" << arg_prefix << arg_app << " " << arg_layers <<
+			" <n>[,<n>..]\t\t: sweep the specified numbers of fullscreen layers per frame\n"
+			"\t" << arg_prefix << arg_app << " " << arg_blend <<
+			" <off|on>[,<off|on>]\t: sweep with blending off and/or on\n"
+			"\t" << arg_prefix << arg_app << " " << arg_depth <<
+			" <off|on>[,<off|on>]\t: sweep with depth test off and/or on; layers go back to front\n"
+			"\t" << arg_prefix << arg_app << " " << arg_alu <<
+			" <n>[,<n>..]\t\t: sweep the specified fragment shader costs, in mad+fract steps\n"
+			"\t" << arg_prefix << arg_app << " " << arg_budget_ms <<
+			" <ms>\t\t\t: report the layer count at which frame time crosses the specified budget\n"
+			"\t" << arg_prefix << arg_app << " " << arg_warmup <<
+			" <n>\t\t\t: use the specified number of warmup frames per configuration\n"
+			"\t" << arg_prefix << arg_app << " " << arg_frames <<
+			" <n>\t\t\t: use the specified number of measured frames per configuration\n" << std::endl;
+	}
+
+	return !cli_err;
+}
+
+static bool setupQuad(
+	const GLuint vbo_arr)
+{
+	assert(vbo_arr);
+
+	static const Vertex arr[] = {
+		{ { -1.f, -1.f } },
+		{ {  1.f, -1.f } },
+		{ { -1.f,  1.f } },
+		{ {  1.f,  1.f } }
+	};
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_arr);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(arr), arr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (util::reportGLError()) {
+		std::cerr << __FUNCTION__ <<
+			" failed at glBindBuffer/glBufferData for ARRAY_BUFFER" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool check_context(
+	const char* prefix)
+{
+	bool context_correct = true;
+
+#if PLATFORM_GLX == 0
+	if (g_display != eglGetCurrentDisplay()) {
+		std::cerr << prefix << " encountered foreign display" << std::endl;
+		context_correct = false;
+	}
+
+	if (g_context != eglGetCurrentContext()) {
+		std::cerr << prefix << " encountered foreign context" << std::endl;
+		context_correct = false;
+	}
+
+#endif
+	return context_correct;
+}
+
+bool deinit_resources()
+{
+	if (!check_context(__FUNCTION__))
+		return false;
+
+	for (unsigned i = 0; i < sizeof(g_shader_prog) / sizeof(g_shader_prog[0]); ++i)
+	{
+		glDeleteProgram(g_shader_prog[i]);
+		g_shader_prog[i] = 0;
+	}
+
+	for (unsigned i = 0; i < sizeof(g_shader_vert) / sizeof(g_shader_vert[0]); ++i)
+	{
+		glDeleteShader(g_shader_vert[i]);
+		g_shader_vert[i] = 0;
+	}
+
+	for (unsigned i = 0; i < sizeof(g_shader_frag) / sizeof(g_shader_frag[0]); ++i)
+	{
+		glDeleteShader(g_shader_frag[i]);
+		g_shader_frag[i] = 0;
+	}
+
+#if PLATFORM_GL_OES_vertex_array_object
+	glDeleteVertexArraysOES(sizeof(g_vao) / sizeof(g_vao[0]), g_vao);
+	memset(g_vao, 0, sizeof(g_vao));
+
+#endif
+	glDeleteBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+	memset(g_vbo, 0, sizeof(g_vbo));
+
+	delete g_phase;
+	g_phase = 0;
+
+#if PLATFORM_GLX == 0
+	g_display = EGL_NO_DISPLAY;
+	g_context = EGL_NO_CONTEXT;
+
+#endif
+	return true;
+}
+
+static bool addProgramVariant(
+	util::ProgramBatch& batch,
+	const unsigned prog,
+	const unsigned alu)
+{
+	std::ostringstream defines;
+	defines <<
+		"#define ALU_OPS " << alu << "\n";
+
+	g_shader_vert[prog] = glCreateShader(GL_VERTEX_SHADER);
+	assert(g_shader_vert[prog]);
+
+	g_shader_frag[prog] = glCreateShader(GL_FRAGMENT_SHADER);
+	assert(g_shader_frag[prog]);
+
+	g_shader_prog[prog] = glCreateProgram();
+	assert(g_shader_prog[prog]);
+
+	if (!batch.add(
+			g_shader_prog[prog],
+			g_shader_vert[prog],
+			g_shader_frag[prog],
+			"fillrate.glslv",
+			"fillrate.glslf",
+			defines.str()))
+	{
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch::add" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool setupProgramVariantBindings(
+	const unsigned prog)
+{
+	g_uni[prog][UNI_DEPTH] = glGetUniformLocation(g_shader_prog[prog], "depth");
+	g_uni[prog][UNI_COLOR] = glGetUniformLocation(g_shader_prog[prog], "color");
+
+	g_active_attr_semantics[prog].registerVertexAttr(
+		glGetAttribLocation(g_shader_prog[prog], "at_Vertex"));
+
+	if (!rend::validateVertexLayout< Vertex >(g_shader_prog[prog], g_active_attr_semantics[prog])) {
+		std::cerr << __FUNCTION__ << " failed at rend::validateVertexLayout" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool init_resources()
+{
+#if PLATFORM_GLES
+#if PLATFORM_GL_OES_vertex_array_object
+	glBindVertexArrayOES    = (PFNGLBINDVERTEXARRAYOESPROC)    eglGetProcAddress("glBindVertexArrayOES");
+	glDeleteVertexArraysOES = (PFNGLDELETEVERTEXARRAYSOESPROC) eglGetProcAddress("glDeleteVertexArraysOES");
+	glGenVertexArraysOES    = (PFNGLGENVERTEXARRAYSOESPROC)    eglGetProcAddress("glGenVertexArraysOES");
+	glIsVertexArrayOES      = (PFNGLISVERTEXARRAYOESPROC)      eglGetProcAddress("glIsVertexArrayOES");
+
+#endif
+#endif
+#if PLATFORM_GLX == 0
+	g_display = eglGetCurrentDisplay();
+
+	if (EGL_NO_DISPLAY == g_display) {
+		std::cerr << __FUNCTION__ << " encountered nil display" << std::endl;
+		return false;
+	}
+
+	g_context = eglGetCurrentContext();
+
+	if (EGL_NO_CONTEXT == g_context) {
+		std::cerr << __FUNCTION__ << " encountered nil context" << std::endl;
+		return false;
+	}
+
+#endif
+	scoped_ptr< deinit_resources_t, scoped_functor > on_error(deinit_resources);
+
+	/////////////////////////////////////////////////////////////////
+
+	if (requires_depth()) {
+		GLint depth_bits = 0;
+		glGetIntegerv(GL_DEPTH_BITS, &depth_bits);
+
+		if (0 == depth_bits) {
+			std::cerr << __FUNCTION__ << " depth test requested but surface has no depth buffer" << std::endl;
+			return false;
+		}
+	}
+
+	glDisable(GL_CULL_FACE);
+	glDepthFunc(GL_LESS);
+	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+	const GLclampf red = 0.f;
+	const GLclampf green = 0.f;
+	const GLclampf blue = 0.f;
+	const GLclampf alpha = 1.f;
+
+	glClearColor(
+		red,
+		green,
+		blue,
+		alpha);
+
+	/////////////////////////////////////////////////////////////////
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		for (unsigned j = 0; j < UNI_COUNT; ++j)
+			g_uni[i][j] = -1;
+
+	// build all variants in one batch, so the driver can compile them concurrently
+	util::ProgramBatch batch;
+
+	for (unsigned i = 0; i < g_alu.count; ++i)
+		if (!addProgramVariant(batch, i, g_alu.value[i])) {
+			std::cerr << __FUNCTION__ << " failed at addProgramVariant" << std::endl;
+			return false;
+		}
+
+	if (!batch.submit() || !batch.finish()) {
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch" << std::endl;
+		return false;
+	}
+
+	for (unsigned i = 0; i < g_alu.count; ++i)
+		if (!setupProgramVariantBindings(i))
+			return false;
+
+	/////////////////////////////////////////////////////////////////
+
+#if PLATFORM_GL_OES_vertex_array_object
+	glGenVertexArraysOES(sizeof(g_vao) / sizeof(g_vao[0]), g_vao);
+
+	for (unsigned i = 0; i < sizeof(g_vao) / sizeof(g_vao[0]); ++i)
+		assert(g_vao[i]);
+
+#endif
+	glGenBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+
+	for (unsigned i = 0; i < sizeof(g_vbo) / sizeof(g_vbo[0]); ++i)
+		assert(g_vbo[i]);
+
+	if (!setupQuad(g_vbo[VBO_QUAD_VTX])) {
+		std::cerr << __FUNCTION__ << " failed at setupQuad" << std::endl;
+		return false;
+	}
+
+#if PLATFORM_GL_OES_vertex_array_object
+	for (unsigned i = 0; i < g_alu.count; ++i) {
+		glBindVertexArrayOES(g_vao[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_QUAD_VTX]);
+
+		if (!rend::setupVertexAttrPointers< Vertex >(g_active_attr_semantics[i])) {
+			std::cerr << __FUNCTION__ <<
+				" failed at rend::setupVertexAttrPointers" << std::endl;
+			return false;
+		}
+
+		for (unsigned j = 0; j < g_active_attr_semantics[i].num_active_attr; ++j)
+			glEnableVertexAttribArray(g_active_attr_semantics[i].active_attr[j]);
+	}
+
+	glBindVertexArrayOES(0);
+
+#endif
+	/////////////////////////////////////////////////////////////////
+
+	g_phase = new util::BenchPhase(g_warmup, g_frames);
+
+	g_config = 0;
+	g_config_count = g_layers.count * g_blend.count * g_depth.count * g_alu.count;
+	g_config_ready = false;
+
+	std::cout << scene_name << ": " << g_config_count << " configurations, " <<
+		g_warmup << " warmup + " << g_frames << " measured frames each" << std::endl;
+
+	on_error.reset();
+	return true;
+}
+
+static void report_config(
+	const Config& c,
+	const GLint (& vp)[4])
+{
+	util::BenchStats stats;
+
+	if (!g_phase->getStats(stats))
+		return;
+
+	const double pixels_per_layer = double(vp[2]) * vp[3];
+	const double pixels_per_s = pixels_per_layer * c.layers / (stats.median * 1e-3);
+
+	if (c.layers == g_layers.value[0]) {
+		g_crossing_layers = 0;
+		g_peak_pixels_per_s = 0.0;
+	}
+
+	if (0 == g_crossing_layers && stats.median > g_budget_ms)
+		g_crossing_layers = c.layers;
+
+	g_peak_pixels_per_s = std::max(g_peak_pixels_per_s, pixels_per_s);
+
+	util::BenchRecord()
+		.param("layers", c.layers)
+		.param("blend", toggle_name[c.blend])
+		.param("depth", toggle_name[c.depth])
+		.param("alu", g_alu.value[c.alu])
+		.param("width", vp[2])
+		.param("height", vp[3])
+		.metric("frame_ms", stats)
+		.metric("pixels_per_s", pixels_per_s)
+		.emit(scene_name);
+
+	// once all layer counts of the group are done, summarize where the budget gets crossed
+	if (c.layers != g_layers.value[g_layers.count - 1])
+		return;
+
+	const double nan = std::numeric_limits< double >::quiet_NaN();
+
+	util::BenchRecord()
+		.param("summary", "budget")
+		.param("blend", toggle_name[c.blend])
+		.param("depth", toggle_name[c.depth])
+		.param("alu", g_alu.value[c.alu])
+		.param("width", vp[2])
+		.param("height", vp[3])
+		.metric("budget_ms", g_budget_ms)
+		.metric("peak_pixels_per_s", g_peak_pixels_per_s)
+		.metric("crossing_layers", g_crossing_layers ? double(g_crossing_layers) : nan)
+		.metric("estimated_layers", g_budget_ms * 1e-3 * g_peak_pixels_per_s / pixels_per_layer)
+		.emit(scene_name);
+}
+
+bool render_frame()
+{
+	if (!check_context(__FUNCTION__))
+		return false;
+
+	if (g_config == g_config_count)
+		return false;
+
+	const Config c = get_config(g_config);
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+
+	if (!g_config_ready) {
+		if (c.blend)
+			glEnable(GL_BLEND);
+		else
+			glDisable(GL_BLEND);
+
+		if (c.depth)
+			glEnable(GL_DEPTH_TEST);
+		else
+			glDisable(GL_DEPTH_TEST);
+
+		g_phase->reset();
+		g_config_ready = true;
+	}
+
+	glClear(GL_COLOR_BUFFER_BIT | (c.depth ? GL_DEPTH_BUFFER_BIT : 0));
+
+	/////////////////////////////////////////////////////////////////
+
+	glUseProgram(g_shader_prog[c.alu]);
+
+	DEBUG_GL_ERR()
+
+#if PLATFORM_GL_OES_vertex_array_object
+	glBindVertexArrayOES(g_vao[c.alu]);
+
+#else
+	glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_QUAD_VTX]);
+
+	if (!rend::setupVertexAttrPointers< Vertex >(g_active_attr_semantics[c.alu]))
+		return false;
+
+	for (unsigned i = 0; i < g_active_attr_semantics[c.alu].num_active_attr; ++i)
+		glEnableVertexAttribArray(g_active_attr_semantics[c.alu].active_attr[i]);
+
+#endif
+	DEBUG_GL_ERR()
+
+	// drain the clear and any outstanding work so that only this frame's layers get timed
+	glFinish();
+	const uint64_t t0 = util::time_ns();
+
+	for (unsigned i = 0; i < c.layers; ++i) {
+		// back to front, so that with depth test on every layer passes and no fragment gets rejected early
+		const GLfloat depth = 1.f - 2.f * (i + 1) / (c.layers + 1);
+		const GLfloat color[4] = {
+			GLfloat(i & 1),
+			GLfloat(i >> 1 & 1),
+			GLfloat(i >> 2 & 1),
+			.5f
+		};
+
+		if (-1 != g_uni[c.alu][UNI_DEPTH])
+			glUniform1f(g_uni[c.alu][UNI_DEPTH], depth);
+
+		if (-1 != g_uni[c.alu][UNI_COLOR])
+			glUniform4fv(g_uni[c.alu][UNI_COLOR], 1, color);
+
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+	}
+
+	glFinish();
+	const uint64_t t1 = util::time_ns();
+
+	DEBUG_GL_ERR()
+
+#if PLATFORM_GL_OES_vertex_array_object == 0
+	for (unsigned i = 0; i < g_active_attr_semantics[c.alu].num_active_attr; ++i)
+		glDisableVertexAttribArray(g_active_attr_semantics[c.alu].active_attr[i]);
+
+#endif
+	if (g_phase->addFrame(t1 - t0)) {
+		report_config(c, vp);
+
+		++g_config;
+		g_config_ready = false;
+	}
+
+	return true;
+}
+
+} // namespace hook
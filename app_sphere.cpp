@@ -14,37 +14,88 @@
 #include <stdlib.h>
 #include <assert.h>
 #include <math.h>
+#include <string>
+#include <vector>
+#include <algorithm>
 #include <iostream>
 
 #include "scoped.hpp"
 #include "util_tex.hpp"
 #include "util_misc.hpp"
+#include "util_mesh.hpp"
+#include "util_matx.hpp"
+#include "util_preproc.hpp"
+#include "util_progcache.hpp"
+#include "util_permute.hpp"
+#include "util_watch.hpp"
+#include "util_bench.hpp"
 #include "pure_macro.hpp"
 
 #include "rendVertAttr.hpp"
+#include "rendVertLayout.hpp"
+#include "rendVertArray.hpp"
+#include "rendInstancing.hpp"
+#include "rendUniformBlock.hpp"
+#include "rendDrawList.hpp"
+#include "rendRenderPass.hpp"
+#include "rendFrameGraph.hpp"
+#include "rendOverdraw.hpp"
 
 using util::scoped_ptr;
 using util::scoped_functor;
 using util::deinit_resources_t;
+using util::matx3;
+using util::matx3_mul;
+using util::matx3_rotate;
 
 namespace {
 
-#define SETUP_VERTEX_ATTR_POINTERS_MASK ( \
-		SETUP_VERTEX_ATTR_POINTERS_MASK_vertex | \
-		SETUP_VERTEX_ATTR_POINTERS_MASK_normal | \
-		SETUP_VERTEX_ATTR_POINTERS_MASK_tcoord)
-
-#include "rendVertAttr_setupVertAttrPointers.hpp"
-#undef SETUP_VERTEX_ATTR_POINTERS_MASK
-
 struct Vertex {
 	GLfloat pos[3];
 	GLfloat nrm[3];
 	GLfloat txc[2];
+	GLfloat tng[4];
+};
+
+// object within a batch, in a stream of its own
+struct ObjectIndex {
+	GLfloat idx;
+};
+
+// corner of the full-screen triangle of post-processing
+struct PostVertex {
+	GLfloat pos[2];
 };
 
 } // namespace
 
+template <>
+const rend::VertAttrFormat rend::VertexLayout< Vertex >::attr[] = {
+	REND_VERT_ATTR(Vertex, pos, vertex, GL_FALSE, 0),
+	REND_VERT_ATTR(Vertex, nrm, normal, GL_FALSE, 0),
+	REND_VERT_ATTR(Vertex, txc, tcoord, GL_FALSE, 0),
+	REND_VERT_ATTR(Vertex, tng, tangent, GL_FALSE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< Vertex >::count = REND_VERT_LAYOUT_COUNT(Vertex);
+
+template <>
+const rend::VertAttrFormat rend::VertexLayout< ObjectIndex >::attr[] = {
+	REND_VERT_ATTR(ObjectIndex, idx, index, GL_FALSE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< ObjectIndex >::count = REND_VERT_LAYOUT_COUNT(ObjectIndex);
+
+template <>
+const rend::VertAttrFormat rend::VertexLayout< PostVertex >::attr[] = {
+	REND_VERT_ATTR(PostVertex, pos, vertex, GL_FALSE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< PostVertex >::count = REND_VERT_LAYOUT_COUNT(PostVertex);
+
 namespace hook {
 
 static const char* arg_prefix    = "-";
@@ -54,6 +105,23 @@ static const char* arg_normal    = "normal_map";
 static const char* arg_albedo    = "albedo_map";
 static const char* arg_tile      = "tile";
 static const char* arg_anim_step = "anim_step";
+static const char* arg_features  = "features";
+static const char* arg_budget    = "budget";
+static const char* arg_shininess = "shininess";
+static const char* arg_spec      = "spec";
+static const char* arg_watch     = "watch";
+static const char* arg_prewarm   = "prewarm";
+static const char* arg_optimized = "optimized";
+static const char* arg_grid      = "grid";
+static const char* arg_sort      = "sort";
+static const char* arg_vao       = "vao";
+static const char* arg_batch     = "batch";
+static const char* arg_instanced = "instanced";
+static const char* arg_discard   = "discard";
+static const char* arg_post      = "post";
+static const char* arg_depth     = "depth";
+static const char* arg_overlap   = "overlap";
+static const char* arg_overdraw  = "overdraw";
 
 struct TexDesc {
 	const char* filename;
@@ -68,19 +136,148 @@ static float g_tile = 2.f;
 static float g_angle = 0.f;
 static float g_angle_step = 3.f / 40.f;
 
+// optional shader features of the sphere, each a macro of phong_bump_tang.glslf and .glslv
+enum {
+	FEATURE_TCOORD_TANGENT,
+	FEATURE_MESH_NORMAL,
+	FEATURE_ALBEDO_MAP,
+	FEATURE_VERTEX_TANGENT,
+
+	FEATURE_COUNT,
+	FEATURE_FORCE_UINT = -1U
+};
+
+static const char* const feature_name[FEATURE_COUNT] = {
+	"tcoord_tangent",
+	"mesh_normal",
+	"albedo_map",
+	"vertex_tangent"
+};
+
+static const char* const feature_macro[FEATURE_COUNT] = {
+	"FEATURE_TCOORD_TANGENT",
+	"FEATURE_MESH_NORMAL",
+	"FEATURE_ALBEDO_MAP",
+	"FEATURE_VERTEX_TANGENT"
+};
+
+static util::ShaderPermutations g_permutations(FEATURE_COUNT, feature_name, feature_macro);
+
+struct Material {
+	const char* name;
+	unsigned required; // features the material cannot do without
+	unsigned desired;  // features the material looks best with
+};
+
+static Material g_material = {
+	"rockwall",
+	1U << FEATURE_ALBEDO_MAP,
+	(1U << FEATURE_COUNT) - 1
+};
+
+// GPU time budget per sphere draw, in ms; negative for no budget
+static float g_budget = -1.f;
+
+// feature mask of the variant in use
+static unsigned g_variant;
+
+// light and viewer are non-local - w of their positions in object space
+static const GLfloat g_light_w = 0.f;
+static const GLfloat g_viewer_w = 0.f;
+
+static float g_shininess = 64.f;
+
+// bake the values fixed for the run into the shaders, as specialization constants
+static bool g_spec = true;
+
+// #define block of the specialization constants, common to all variants
+static std::string g_spec_defines;
+
+// spheres per side of the grid drawn, in alternating materials
+static unsigned g_grid = 1;
+static const unsigned max_grid = 16;
+
+// submit the draw list in state order rather than in grid order
+static bool g_sort = true;
+
+// use native vertex array objects where the driver has them, rather than emulate them
+static bool g_vao_native = true;
+
+// draw the grid in batches of spheres of a material, one draw per batch
+static bool g_batch;
+static const unsigned max_batch_size = 16;
+
+// spheres per batch, within the limits of the palette and of the index type; 0 when not batching
+static unsigned g_batch_size;
+
+// batch through instanced arrays where the driver has them, rather than through pseudo-instancing
+static bool g_instanced_arrays = true;
+static rend::InstancedArrays g_instanced;
+
+// tell the driver that depth and stencil, which the app does not use, need neither loading nor storing
+static bool g_discard = true;
+
+// blur passes between the scene and the back buffer, through the frame graph; none draws the scene
+// straight into the back buffer
+static unsigned g_post;
+static const unsigned max_post = 8;
+
+// how the grid resolves visibility once its spheres overlap
+enum {
+	DEPTH_NONE,    // no depth buffer; spheres land in submission order
+	DEPTH_TEST,    // depth test, with draws sorted front to back ahead of state
+	DEPTH_PREPASS, // and a position-only depth prepass, so that shading runs once per pixel
+
+	DEPTH_COUNT,
+	DEPTH_FORCE_UINT = -1U
+};
+
+static const char* const depth_name[DEPTH_COUNT] = {
+	"none",
+	"test",
+	"prepass"
+};
+
+static unsigned g_depth = DEPTH_NONE;
+
+// sphere size relative to its grid cell; above 1 spheres overlap their neighbours, which sit at
+// depths from the back, in grid order, to the front
+static float g_overlap = 1.f;
+static const float max_overlap = 4.f;
+
+// debug mode: re-render every frame into a count target, for shaded and rasterized fragments per pixel
+enum {
+	OVERDRAW_OFF,
+	OVERDRAW_MEASURE,
+	OVERDRAW_HEATMAP, // and show the shaded counts in place of the scene
+
+	OVERDRAW_COUNT,
+	OVERDRAW_FORCE_UINT = -1U
+};
+
+static unsigned g_overdraw = OVERDRAW_OFF;
+
+// polar sphere grid dimensions
+static const int sphere_rows = 33;
+static const int sphere_cols = 65;
+
+// use the sources build.sh emits through the offline optimizer, one pair per variant
+static bool g_optimized;
+
+// draw with every program ahead of the first frame, for the driver to finish deferred compilation
+static bool g_prewarm = true;
+
+// rebuild shaders and reload textures as they change on disk, and report live draw times
+static bool g_watch;
+static util::FileWatcher g_watcher;
+static util::BenchPhase g_live(0, 60);
+
 #if PLATFORM_GLX == 0
 static EGLDisplay g_display = EGL_NO_DISPLAY;
 static EGLContext g_context = EGL_NO_CONTEXT;
 
 #endif
 #if PLATFORM_GLES
-#if PLATFORM_GL_OES_vertex_array_object
-static PFNGLBINDVERTEXARRAYOESPROC    glBindVertexArrayOES;
-static PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOES;
-static PFNGLGENVERTEXARRAYSOESPROC    glGenVertexArraysOES;
-static PFNGLISVERTEXARRAYOESPROC      glIsVertexArrayOES;
-
-#endif
 #if PLATFORM_GL_KHR_debug
 static PFNGLDEBUGMESSAGECONTROLKHRPROC  glDebugMessageControlKHR;
 static PFNGLDEBUGMESSAGEINSERTKHRPROC   glDebugMessageInsertKHR;
@@ -99,13 +296,19 @@ static PFNGLGETPOINTERVKHRPROC          glGetPointervKHR;
 enum {
 	TEX_NORMAL,
 	TEX_ALBEDO,
+	TEX_CHECKER, // albedo of every other sphere in the grid
 
 	TEX_COUNT,
 	TEX_FORCE_UINT = -1U
 };
 
+// sphere program variants are indexed by feature mask, from PROG_SPHERE on
 enum {
 	PROG_SPHERE,
+	PROG_POST = PROG_SPHERE + (1U << FEATURE_COUNT),
+	PROG_PREPASS,
+	PROG_OVERDRAW, // position-only, counting fragments
+	PROG_HEATMAP,
 
 	PROG_COUNT,
 	PROG_FORCE_UINT = -1U
@@ -114,10 +317,8 @@ enum {
 enum {
 	UNI_SAMPLER_NORMAL,
 	UNI_SAMPLER_ALBEDO,
-
-	UNI_LP_OBJ,
-	UNI_VP_OBJ,
-	UNI_MVP,
+	UNI_SAMPLER_SOURCE, // of post-processing
+	UNI_BLUR_STEP,
 
 	UNI_COUNT,
 	UNI_FORCE_UINT = -1U
@@ -125,6 +326,7 @@ enum {
 
 enum {
 	MESH_SPHERE,
+	MESH_POST,
 
 	MESH_COUNT,
 	MESH_FORCE_UINT = -1U
@@ -133,6 +335,8 @@ enum {
 enum {
 	VBO_SPHERE_VTX,
 	VBO_SPHERE_IDX,
+	VBO_SPHERE_OBJ, // object indices of a batch
+	VBO_POST_VTX,
 
 	VBO_COUNT,
 	VBO_FORCE_UINT = -1U
@@ -140,10 +344,10 @@ enum {
 
 static GLint g_uni[PROG_COUNT][UNI_COUNT];
 
-#if PLATFORM_GL_OES_vertex_array_object
-static GLuint g_vao[PROG_COUNT];
+// vertex arrays by mesh, native or emulated
+static rend::VertexArrays g_vertex_arrays;
+static GLuint g_vao[MESH_COUNT];
 
-#endif
 static GLuint g_tex[TEX_COUNT];
 static GLuint g_vbo[VBO_COUNT];
 static GLuint g_shader_vert[PROG_COUNT];
@@ -152,7 +356,62 @@ static GLuint g_shader_prog[PROG_COUNT];
 
 static unsigned g_num_faces[MESH_COUNT];
 
-static rend::ActiveAttrSemantics g_active_attr_semantics[PROG_COUNT];
+// attributes are at fixed locations in all programs, so vertex state is per mesh
+static rend::ActiveAttrSemantics g_active_attr_semantics[MESH_COUNT];
+
+// emulated uniform blocks of the sphere shaders, by update frequency; mind the layout in
+// phong_bump_tang.glslv and phong_bump_tang.glslf
+struct FrameBlock {
+	GLfloat lp_obj[4];
+	GLfloat vp_obj[4];
+};
+
+struct MaterialBlock {
+	GLfloat shininess[4]; // x
+};
+
+// a batch reads as many consecutive object blocks as its palette
+struct ObjectBlock {
+	GLfloat mvp[4][4];
+};
+
+static rend::UniformBlocks g_uniform_blocks;
+static FrameBlock g_frame_block;
+static MaterialBlock g_material_block;
+static ObjectBlock g_sphere_object; // of single-sphere draws
+static std::vector< ObjectBlock > g_object; // of the grid, in batches when batching
+static std::vector< unsigned > g_object_cell; // grid cell of each object; -1U for batch padding
+
+static rend::DrawList g_draw_list;
+static rend::DrawList g_prepass_list; // position-only draws of the grid, ahead of g_draw_list
+static rend::DrawList g_overdraw_list; // counting draws of the grid, in the order of g_draw_list
+
+static rend::OverdrawCounter g_overdraw_counter;
+static rend::OverdrawStats g_overdraw_stats;
+
+// the frame's pass into the default framebuffer
+static rend::RenderPass g_frame_pass;
+
+// with post-processing, the passes of the frame, built for the extent of the viewport
+static rend::FrameGraph g_frame_graph;
+static GLsizei g_graph_width;
+static GLsizei g_graph_height;
+
+// post-processing pass: the target it samples, and the texture-space step of its blur taps
+struct PostPass {
+	unsigned source;
+	GLfloat blur_step[2];
+};
+
+static std::vector< PostPass > g_post_pass;
+
+// draw-list state changes of the frame in flight
+static rend::DrawStats g_frame_draw_stats;
+
+// draw-list state changes and attachment traffic, summed over all frames
+static rend::DrawStats g_draw_stats;
+static rend::RenderPassStats g_pass_stats;
+static unsigned g_num_frames;
 
 bool set_num_drawcalls(
 	const unsigned)
@@ -165,12 +424,26 @@ unsigned get_num_drawcalls()
 	return 1;
 }
 
+// with post-processing, depth is a transient target of the frame graph
 bool requires_depth()
 {
-	return false;
+	return DEPTH_NONE != g_depth && 0 == g_post;
 }
 
-static bool parse_cli(
+// shader file of a sphere variant, by extension - .glslv or .glslf
+static std::string shaderFilename(
+	const unsigned mask,
+	const char* const ext)
+{
+	if (!g_optimized)
+		return std::string("phong_bump_tang") + ext;
+
+	char name[64];
+	snprintf(name, sizeof(name), "opt/phong_bump_tang.%u%s", mask, ext);
+	return name;
+}
+
+bool parse_cli(
     const unsigned argc,
     const char* const* argv)
 {
@@ -217,6 +490,173 @@ static bool parse_cli(
 					continue;
 				}
 			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_features)) {
+				unsigned feature[FEATURE_COUNT * 2];
+				const size_t count = strcmp(argv[i + 1], "none") ? util::parseNameList(argv[i + 1],
+					feature_name, FEATURE_COUNT, feature, sizeof(feature) / sizeof(feature[0])) : 0;
+
+				if (0 != count || !strcmp(argv[i + 1], "none")) {
+					g_material.desired = 0;
+
+					for (size_t j = 0; j < count; ++j)
+						g_material.desired |= 1U << feature[j];
+
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_budget)) {
+				if (1 == sscanf(argv[i + 1], "%f", &g_budget) && 0.f <= g_budget) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_shininess)) {
+				if (1 == sscanf(argv[i + 1], "%f", &g_shininess) && 0.f < g_shininess) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_spec)) {
+				unsigned spec;
+
+				if (1 == sscanf(argv[i + 1], "%u", &spec) && 1 >= spec) {
+					g_spec = 0 != spec;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_watch)) {
+				unsigned watch;
+
+				if (1 == sscanf(argv[i + 1], "%u", &watch) && 1 >= watch) {
+					g_watch = 0 != watch;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_prewarm)) {
+				unsigned prewarm;
+
+				if (1 == sscanf(argv[i + 1], "%u", &prewarm) && 1 >= prewarm) {
+					g_prewarm = 0 != prewarm;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_optimized)) {
+				unsigned optimized;
+
+				if (1 == sscanf(argv[i + 1], "%u", &optimized) && 1 >= optimized) {
+					g_optimized = 0 != optimized;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_grid)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_grid) && 0 < g_grid && max_grid >= g_grid) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_sort)) {
+				unsigned sort;
+
+				if (1 == sscanf(argv[i + 1], "%u", &sort) && 1 >= sort) {
+					g_sort = 0 != sort;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_vao)) {
+				unsigned vao;
+
+				if (1 == sscanf(argv[i + 1], "%u", &vao) && 1 >= vao) {
+					g_vao_native = 0 != vao;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_batch)) {
+				unsigned batch;
+
+				if (1 == sscanf(argv[i + 1], "%u", &batch) && 1 >= batch) {
+					g_batch = 0 != batch;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_instanced)) {
+				unsigned instanced;
+
+				if (1 == sscanf(argv[i + 1], "%u", &instanced) && 1 >= instanced) {
+					g_instanced_arrays = 0 != instanced;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_discard)) {
+				unsigned discard;
+
+				if (1 == sscanf(argv[i + 1], "%u", &discard) && 1 >= discard) {
+					g_discard = 0 != discard;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_post)) {
+				unsigned post;
+
+				if (1 == sscanf(argv[i + 1], "%u", &post) && max_post >= post) {
+					g_post = post;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_depth)) {
+				unsigned depth;
+
+				if (1 == sscanf(argv[i + 1], "%u", &depth) && DEPTH_COUNT > depth) {
+					g_depth = depth;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_overdraw)) {
+				unsigned overdraw;
+
+				if (1 == sscanf(argv[i + 1], "%u", &overdraw) && OVERDRAW_COUNT > overdraw) {
+					g_overdraw = overdraw;
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_overlap)) {
+				float overlap;
+
+				if (1 == sscanf(argv[i + 1], "%f", &overlap) && 1.f <= overlap && max_overlap >= overlap) {
+					g_overlap = overlap;
+					i += 1;
+					continue;
+				}
+			}
 		}
 
 		cli_err = true;
@@ -231,7 +671,59 @@ static bool parse_cli(
 			"\t" << arg_prefix << arg_app << " " << arg_tile <<
 			" <n>\t\t\t\t\t: tile texture maps the specified number of times along U, half as much along V\n"
 			"\t" << arg_prefix << arg_app << " " << arg_anim_step <<
-			" <step>\t\t\t\t: use specified rotation step\n" << std::endl;
+			" <step>\t\t\t\t: use specified rotation step\n"
+			"\t" << arg_prefix << arg_app << " " << arg_features <<
+			" <feature>[,<feature>..]|none\t: desired shader features, out of tcoord_tangent, mesh_normal, albedo_map"
+			" and vertex_tangent;"
+			" all by default; the material requires albedo_map regardless\n"
+			"\t" << arg_prefix << arg_app << " " << arg_budget <<
+			" <ms>\t\t\t\t: time every shader variant between the required and the desired features,"
+			" and use the richest one whose sphere draw fits the specified GPU time\n"
+			"\t" << arg_prefix << arg_app << " " << arg_shininess <<
+			" <exponent>\t\t\t: use specified specular exponent; default 64\n"
+			"\t" << arg_prefix << arg_app << " " << arg_spec <<
+			" 0|1\t\t\t\t: bake light model and shininess into the shaders (1) or pass them as uniforms (0);"
+			" default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_watch <<
+			" 0|1\t\t\t\t: rebuild shaders and reload textures as they change in the working directory,"
+			" and report the sphere draw time every 60 frames (1); default 0\n"
+			"\t" << arg_prefix << arg_app << " " << arg_prewarm <<
+			" 0|1\t\t\t\t: draw with every shader variant at init, so that the driver does not finish"
+			" compiling them on first use mid-frame (1); default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_optimized <<
+			" 0|1\t\t\t: use the offline-optimized shaders build.sh emits under opt/ (1), which take"
+			" no specialization constants; default 0\n"
+			"\t" << arg_prefix << arg_app << " " << arg_grid <<
+			" <n>\t\t\t\t\t: draw a grid of n x n spheres, alternating between two albedo maps;"
+			" n up to " << max_grid << ", default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_sort <<
+			" 0|1\t\t\t\t: submit draws in state order (1) or in grid order (0); default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_vao <<
+			" 0|1\t\t\t\t: use native vertex array objects where available (1) or emulate them (0);"
+			" default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_batch <<
+			" 0|1\t\t\t\t: draw the grid in batches of up to " << max_batch_size << " spheres of a material,"
+			" one draw call per batch (1); default 0\n"
+			"\t" << arg_prefix << arg_app << " " << arg_instanced <<
+			" 0|1\t\t\t: batch through instanced arrays where available (1) or through"
+			" pseudo-instancing (0); default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_discard <<
+			" 0|1\t\t\t\t: clear depth and stencil at the start of the frame and discard them at the end,"
+			" where GL_EXT_discard_framebuffer is present (1), or leave them to the driver (0); default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_post <<
+			" <n>\t\t\t\t\t: render the scene into a transient target and blur it in n alternating horizontal and"
+			" vertical passes on the way to the back buffer, scheduled by a frame graph; n up to " << max_post <<
+			", default 0\n"
+			"\t" << arg_prefix << arg_app << " " << arg_depth <<
+			" 0|1|2\t\t\t\t: draw the grid without depth (0), with a depth test and front-to-back order (1),"
+			" or with a position-only depth prepass ahead of shading as well (2); default 0\n"
+			"\t" << arg_prefix << arg_app << " " << arg_overlap <<
+			" <f>\t\t\t\t: scale spheres to f times their grid cell, stacked back to front in grid order;"
+			" f from 1 up to " << max_overlap << ", default 1\n"
+			"\t" << arg_prefix << arg_app << " " << arg_overdraw <<
+			" 0|1|2\t\t\t: debug: count the fragments every frame shades and rasterizes per pixel, through"
+			" an offscreen re-render and a readback, and report their histogram (1), and show the shaded counts"
+			" as a heatmap in place of the scene (2); default 0\n" << std::endl;
 	}
 
 	return !cli_err;
@@ -247,135 +739,82 @@ public:
 	}
 };
 
+// create the sphere mesh; when batching, also the object indices of a batch - per instance with
+// instanced arrays, otherwise per vertex of a mesh replicated once per object; num_faces is that of a
+// single sphere either way
 static bool createIndexedPolarSphere(
 	const GLuint vbo_arr,
 	const GLuint vbo_idx,
+	const GLuint vbo_obj,
 	unsigned& num_faces)
 {
-	assert(vbo_arr && vbo_idx);
+	assert(vbo_arr && vbo_idx && vbo_obj);
 
 	const float r = 1.f;
 
 	// bend a polar sphere from a grid of the following dimensions:
-	const int rows = 33;
-	const int cols = 65;
+	const int rows = sphere_rows;
+	const int cols = sphere_cols;
 
 	assert(rows > 2);
 	assert(cols > 3);
 
 	typedef uint16_t Index;
-	const size_t num_verts = (rows - 2) * cols + 2 * (cols - 1);
-	const size_t num_tris = ((rows - 3) * 2 + 2) * (cols - 1);
+	const size_t num_verts = util::polarSphereNumVerts(rows, cols);
+	const size_t num_tris = util::polarSphereNumTris(rows, cols);
 	num_faces = num_tris;
 
 	scoped_ptr< Vertex, generic_free > arr(
 		reinterpret_cast< Vertex* >(malloc(sizeof(Vertex) * num_verts)));
-	unsigned ai = 0;
-
-	// north pole
-	for (int j = 0; j < cols - 1; ++j) {
-		assert(ai < num_verts);
 
-		arr()[ai].pos[0] = 0.f;
-		arr()[ai].pos[1] = 0.f;
-		arr()[ai].pos[2] = r;
+	util::fillPolarSphereVerts(arr(), rows, cols, r, g_tile);
 
-		arr()[ai].nrm[0] = 0.f;
-		arr()[ai].nrm[1] = 0.f;
-		arr()[ai].nrm[2] = 1.f;
+	scoped_ptr< Index[3], generic_free > idx(
+		reinterpret_cast< Index(*)[3] >(malloc(sizeof(Index[3]) * num_tris)));
 
-		arr()[ai].txc[0] = g_tile * (j + .5f) / (cols - 1);
-		arr()[ai].txc[1] = g_tile * .5f;
-		++ai;
-	}
+	util::fillPolarSphereIndices(idx(), rows, cols);
+	util::fillTangents(arr(), num_verts, idx(), num_tris);
 
-	// interior
-	for (int i = 1; i < rows - 1; ++i)
-		for (int j = 0; j < cols; ++j) {
-			assert(ai < num_verts);
+	std::cout << "number of vertices: " << num_verts << "\nnumber of faces: " << num_tris << std::endl;
 
-			const float azim = j * 2 * M_PI / (cols - 1);
-			const float decl = M_PI_2 - i * M_PI / (rows - 1);
-			const float sin_azim = sinf(azim);
-			const float cos_azim = cosf(azim);
-			const float sin_decl = sinf(decl);
-			const float cos_decl = cosf(decl);
+	const unsigned copies = 0 != g_batch_size && !g_instanced.isAvailable() ? g_batch_size : 1;
 
-			arr()[ai].pos[0] = r * cos_decl * cos_azim;
-			arr()[ai].pos[1] = r * cos_decl * sin_azim;
-			arr()[ai].pos[2] = r * sin_decl;
+	if (1 != copies) {
+		scoped_ptr< Vertex, generic_free > rep_arr(
+			reinterpret_cast< Vertex* >(malloc(sizeof(Vertex) * num_verts * copies)));
 
-			arr()[ai].nrm[0] = cos_decl * cos_azim;
-			arr()[ai].nrm[1] = cos_decl * sin_azim;
-			arr()[ai].nrm[2] = sin_decl;
+		scoped_ptr< Index[3], generic_free > rep_idx(
+			reinterpret_cast< Index(*)[3] >(malloc(sizeof(Index[3]) * num_tris * copies)));
 
-			arr()[ai].txc[0] = g_tile * j / (cols - 1);
-			arr()[ai].txc[1] = g_tile * (rows - 1 - i) / (2 * rows - 2);
-			++ai;
-		}
+		rend::replicateMesh(arr(), num_verts, idx()[0], num_tris * 3, copies, rep_arr(), rep_idx()[0]);
 
-	// south pole
-	for (int j = 0; j < cols - 1; ++j) {
-		assert(ai < num_verts);
+		arr.set(rep_arr());
+		rep_arr.reset();
 
-		arr()[ai].pos[0] = 0.f;
-		arr()[ai].pos[1] = 0.f;
-		arr()[ai].pos[2] = -r;
+		idx.set(rep_idx());
+		rep_idx.reset();
+	}
 
-		arr()[ai].nrm[0] = 0.f;
-		arr()[ai].nrm[1] = 0.f;
-		arr()[ai].nrm[2] = -1.f;
+	if (0 != g_batch_size) {
+		const size_t num_obj = 1 != copies ? num_verts * copies : g_batch_size;
+		std::vector< ObjectIndex > obj(num_obj);
 
-		arr()[ai].txc[0] = g_tile * (j + .5f) / (cols - 1);
-		arr()[ai].txc[1] = 0.f;
-		++ai;
-	}
+		for (size_t i = 0; i < num_obj; ++i)
+			obj[i].idx = GLfloat(1 != copies ? i / num_verts : i);
 
-	assert(ai == num_verts);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_obj);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(obj[0]) * num_obj, &obj[0], GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-	scoped_ptr< Index[3], generic_free > idx(
-		reinterpret_cast< Index(*)[3] >(malloc(sizeof(Index[3]) * num_tris)));
-	unsigned ii = 0;
-
-	// north pole
-	for (unsigned j = 0; j < cols - 1; ++j) {
-		assert(ii < num_tris);
-		idx()[ii][0] = Index(j);
-		idx()[ii][1] = Index(j + cols - 1);
-		idx()[ii][2] = Index(j + cols);
-		++ii;
-	}
-
-	// interior
-	for (int i = 1; i < rows - 2; ++i)
-		for (int j = 0; j < cols - 1; ++j) {
-			assert(ii < num_tris);
-			idx()[ii][0] = Index(j + i * cols);
-			idx()[ii][1] = Index(j + i * cols - 1);
-			idx()[ii][2] = Index(j + (i + 1) * cols);
-			++ii;
-
-			assert(ii < num_tris);
-			idx()[ii][0] = Index(j + (i + 1) * cols - 1);
-			idx()[ii][1] = Index(j + (i + 1) * cols);
-			idx()[ii][2] = Index(j + i * cols - 1);
-			++ii;
+		if (util::reportGLError()) {
+			std::cerr << __FUNCTION__ <<
+				" failed at glBindBuffer/glBufferData for ARRAY_BUFFER" << std::endl;
+			return false;
 		}
-
-	// south pole
-	for (unsigned j = 0; j < cols - 1; ++j) {
-		assert(ii < num_tris);
-		idx()[ii][0] = Index(j + (rows - 2) * cols);
-		idx()[ii][1] = Index(j + (rows - 2) * cols - 1);
-		idx()[ii][2] = Index(j + (rows - 2) * cols + cols - 1);
-		++ii;
 	}
 
-	assert(ii == num_tris);
-	std::cout << "number of vertices: " << num_verts << "\nnumber of faces: " << num_tris << std::endl;
-
 	glBindBuffer(GL_ARRAY_BUFFER, vbo_arr);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(*arr()) * num_verts, arr(), GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(*arr()) * num_verts * copies, arr(), GL_STATIC_DRAW);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 
 	if (util::reportGLError()) {
@@ -385,7 +824,7 @@ static bool createIndexedPolarSphere(
 	}
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_idx);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(*idx()) * num_tris, idx(), GL_STATIC_DRAW);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(*idx()) * num_tris * copies, idx(), GL_STATIC_DRAW);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 
 	if (util::reportGLError()) {
@@ -422,6 +861,74 @@ bool deinit_resources()
 	if (!check_context(__FUNCTION__))
 		return false;
 
+	// state changes per frame, for the runner
+	if (0 != g_num_frames) {
+		const rend::FrameGraphStats& graph_stats = g_frame_graph.getStats();
+
+		util::BenchRecord()
+			.param("grid", g_grid)
+			.param("sort", g_sort ? 1 : 0)
+			.param("vao", g_vertex_arrays.isNative() ? "native" : "emulated")
+			.param("batch", g_batch_size)
+			.param("instancing", 0 == g_batch_size ? "none" : g_instanced.isAvailable() ? "arrays" : "pseudo")
+			.param("discard", g_discard ? g_frame_pass.canDiscard() ? "ext" : "clear_only" : "none")
+			.param("post", g_post)
+			.param("depth", depth_name[g_depth])
+			.param("overlap", g_overlap)
+			.metric("packets", double(g_draw_stats.packets) / g_num_frames)
+			.metric("program_changes", double(g_draw_stats.program_changes) / g_num_frames)
+			.metric("texture_changes", double(g_draw_stats.texture_changes) / g_num_frames)
+			.metric("source_changes", double(g_draw_stats.source_changes) / g_num_frames)
+			.metric("uniform_updates", double(g_draw_stats.uniform_updates) / g_num_frames)
+			.metric("attr_pointer_updates", double(g_vertex_arrays.getPointerUpdates()) / g_num_frames)
+			.metric("pass_bytes_loaded", double(g_pass_stats.bytes_loaded) / g_num_frames)
+			.metric("pass_bytes_stored", double(g_pass_stats.bytes_stored) / g_num_frames)
+			.metric("pass_bytes_saved", double(g_pass_stats.bytes_saved) / g_num_frames)
+			.metric("passes_culled", graph_stats.passes_culled)
+			.metric("targets", graph_stats.targets)
+			.metric("targets_physical", graph_stats.targets_physical)
+			.metric("transient_bytes_requested", double(graph_stats.bytes_requested))
+			.metric("transient_bytes_peak", double(graph_stats.bytes_peak))
+			.emit("sphere_draw_list");
+	}
+
+	// shaded fragments per pixel, and what the visibility setup saved of the rasterized ones
+	if (0 != g_overdraw_stats.frames) {
+		const rend::OverdrawStats& stats = g_overdraw_stats;
+		const double frames = stats.frames;
+
+		std::cout << "overdraw: pixels by times shaded, per frame:";
+
+		for (unsigned i = 0; i < rend::OVERDRAW_HISTOGRAM_SIZE; ++i)
+			std::cout << " " << i << (i + 1 == rend::OVERDRAW_HISTOGRAM_SIZE ? "+" : "") << ": " << stats.histogram[i] / frames;
+
+		std::cout << std::endl;
+
+		util::BenchRecord()
+			.param("grid", g_grid)
+			.param("sort", g_sort ? 1 : 0)
+			.param("batch", g_batch_size)
+			.param("depth", depth_name[g_depth])
+			.param("overlap", g_overlap)
+			.metric("pixels", stats.pixels / frames)
+			.metric("fragments_shaded", stats.fragments_shaded / frames)
+			.metric("fragments_rasterized", stats.fragments_rasterized / frames)
+			.metric("overdraw", 0 != stats.pixels ? double(stats.fragments_shaded) / stats.pixels : 0.0)
+			.metric("fragments_saved", 0 != stats.fragments_rasterized ?
+				1.0 - double(stats.fragments_shaded) / stats.fragments_rasterized : 0.0)
+			.metric("max_count", stats.max_count)
+			.emit("sphere_overdraw");
+	}
+
+	g_draw_list.clear();
+	g_prepass_list.clear();
+	g_overdraw_list.clear();
+	g_overdraw_counter.clear();
+
+	g_frame_graph.clear();
+	g_graph_width = 0;
+	g_graph_height = 0;
+
 	for (unsigned i = 0; i < sizeof(g_shader_prog) / sizeof(g_shader_prog[0]); ++i)
 	{
 		glDeleteProgram(g_shader_prog[i]);
@@ -443,11 +950,11 @@ bool deinit_resources()
 	glDeleteTextures(sizeof(g_tex) / sizeof(g_tex[0]), g_tex);
 	memset(g_tex, 0, sizeof(g_tex));
 
-#if PLATFORM_GL_OES_vertex_array_object
-	glDeleteVertexArraysOES(sizeof(g_vao) / sizeof(g_vao[0]), g_vao);
+	g_vertex_arrays.clear();
 	memset(g_vao, 0, sizeof(g_vao));
 
-#endif
+	g_uniform_blocks.clear();
+
 	glDeleteBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
 	memset(g_vbo, 0, sizeof(g_vbo));
 
@@ -459,62 +966,898 @@ bool deinit_resources()
 	return true;
 }
 
-#if DEBUG && PLATFORM_GL_KHR_debug
-static void debugProc(
-	GLenum source,
-	GLenum type,
-	GLuint id,
-	GLenum severity,
-	GLsizei length,
-	const GLchar* message,
-	const void* userParam)
+// non-local light and viewer, head-on in world space
+static void updateFrameBlock(
+	const matx3& p1)
 {
-	fprintf(stderr, "log: %s\n", message);
+	for (unsigned i = 0; i < 3; ++i) {
+		g_frame_block.lp_obj[i] = p1[i][2];
+		g_frame_block.vp_obj[i] = p1[i][2];
+	}
+
+	g_frame_block.lp_obj[3] = g_light_w;
+	g_frame_block.vp_obj[3] = g_viewer_w;
+
+	g_uniform_blocks.setDirty(rend::UNIFORM_FREQ_FRAME);
 }
 
-#endif
-bool init_resources(
-	const unsigned argc,
-	const char* const * argv)
+static bool drawSphere(
+	const unsigned prog,
+	const matx3& p1,
+	const float aspect)
 {
-	if (!parse_cli(argc, argv))
-		return false;
+	updateFrameBlock(p1);
 
-#if PLATFORM_GLES
-#if PLATFORM_GL_OES_vertex_array_object
-	glBindVertexArrayOES    = (PFNGLBINDVERTEXARRAYOESPROC)    eglGetProcAddress("glBindVertexArrayOES");
-	glDeleteVertexArraysOES = (PFNGLDELETEVERTEXARRAYSOESPROC) eglGetProcAddress("glDeleteVertexArraysOES");
-	glGenVertexArraysOES    = (PFNGLGENVERTEXARRAYSOESPROC)    eglGetProcAddress("glGenVertexArraysOES");
-	glIsVertexArrayOES      = (PFNGLISVERTEXARRAYOESPROC)      eglGetProcAddress("glIsVertexArrayOES");
+	// expand to 4x4, sign-inverting z in all original columns (for GL screen space)
+	const GLfloat mvp[4][4] =
+	{
+		{  p1[0][0] * aspect,  p1[0][1], -p1[0][2],  0.f },
+		{  p1[1][0] * aspect,  p1[1][1], -p1[1][2],  0.f },
+		{  p1[2][0] * aspect,  p1[2][1], -p1[2][2],  0.f },
+		{  0.f,                0.f,       0.f,       1.f }
+	};
 
-#endif
-#if PLATFORM_GL_KHR_debug
-	glDebugMessageControlKHR  = (PFNGLDEBUGMESSAGECONTROLKHRPROC)  eglGetProcAddress("glDebugMessageControlKHR");
-	glDebugMessageInsertKHR   = (PFNGLDEBUGMESSAGEINSERTKHRPROC)   eglGetProcAddress("glDebugMessageInsertKHR");
-	glDebugMessageCallbackKHR = (PFNGLDEBUGMESSAGECALLBACKKHRPROC) eglGetProcAddress("glDebugMessageCallbackKHR");
-	glGetDebugMessageLogKHR   = (PFNGLGETDEBUGMESSAGELOGKHRPROC)   eglGetProcAddress("glGetDebugMessageLogKHR");
-	glPushDebugGroupKHR       = (PFNGLPUSHDEBUGGROUPKHRPROC)       eglGetProcAddress("glPushDebugGroupKHR");
-	glPopDebugGroupKHR        = (PFNGLPOPDEBUGGROUPKHRPROC)        eglGetProcAddress("glPopDebugGroupKHR");
-	glObjectLabelKHR          = (PFNGLOBJECTLABELKHRPROC)          eglGetProcAddress("glObjectLabelKHR");
-	glGetObjectLabelKHR       = (PFNGLGETOBJECTLABELKHRPROC)       eglGetProcAddress("glGetObjectLabelKHR");
-	glObjectPtrLabelKHR       = (PFNGLOBJECTPTRLABELKHRPROC)       eglGetProcAddress("glObjectPtrLabelKHR");
-	glGetObjectPtrLabelKHR    = (PFNGLGETOBJECTPTRLABELKHRPROC)    eglGetProcAddress("glGetObjectPtrLabelKHR");
-	glGetPointervKHR          = (PFNGLGETPOINTERVKHRPROC)          eglGetProcAddress("glGetPointervKHR");
+	memcpy(g_sphere_object.mvp, mvp, sizeof(mvp));
+
+	glUseProgram(g_shader_prog[prog]);
 
-#endif
-#endif
-#if DEBUG && PLATFORM_GL_KHR_debug
-	glDebugMessageCallbackKHR(debugProc, NULL);
-	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
-	glEnable(GL_DEBUG_OUTPUT_KHR);
 	DEBUG_GL_ERR()
 
-	glDebugMessageInsertKHR(
-		GL_DEBUG_SOURCE_APPLICATION_KHR,
-		GL_DEBUG_TYPE_OTHER_KHR,
-		GLuint(42),
-		GL_DEBUG_SEVERITY_HIGH_KHR,
-		GLint(-1), 
+	g_uniform_blocks.setBlock(rend::UNIFORM_FREQ_OBJECT, rend::getBlockSource(g_sphere_object));
+	g_uniform_blocks.setDirty(rend::UNIFORM_FREQ_OBJECT);
+	g_uniform_blocks.apply(g_shader_prog[prog]);
+
+	DEBUG_GL_ERR()
+
+	if (g_tex[TEX_NORMAL] && -1 != g_uni[prog][UNI_SAMPLER_NORMAL])
+	{
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, g_tex[TEX_NORMAL]);
+	}
+
+	DEBUG_GL_ERR()
+
+	if (g_tex[TEX_ALBEDO] && -1 != g_uni[prog][UNI_SAMPLER_ALBEDO])
+	{
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, g_tex[TEX_ALBEDO]);
+	}
+
+	DEBUG_GL_ERR()
+
+	// arrays are enabled in the vertex array
+	g_vertex_arrays.bind(g_vao[MESH_SPHERE]);
+
+	DEBUG_GL_ERR()
+
+	// when batching, as the first object of a batch - the sphere's object block fills the head of the
+	// palette
+	if (0 != g_batch_size && g_instanced.isAvailable())
+		g_instanced.drawElements(GL_TRIANGLES, g_num_faces[MESH_SPHERE] * 3, GL_UNSIGNED_SHORT, 0, 1);
+	else
+		glDrawElements(GL_TRIANGLES, g_num_faces[MESH_SPHERE] * 3, GL_UNSIGNED_SHORT, (void*) 0);
+
+	DEBUG_GL_ERR()
+
+	g_vertex_arrays.bind(0);
+
+	return true;
+}
+
+// check the attributes of a sphere program against the vertex layouts of the mesh - with the object
+// indices of a batch when batching
+static bool validateSphereLayout(
+	const GLuint prog)
+{
+	typedef rend::VertexLayout< Vertex > Layout;
+	typedef rend::VertexLayout< ObjectIndex > ObjectLayout;
+
+	if (0 == g_batch_size)
+		return rend::validateVertexLayout< Vertex >(prog, g_active_attr_semantics[MESH_SPHERE]);
+
+	std::vector< rend::VertAttrFormat > attr(Layout::attr, Layout::attr + Layout::count);
+	attr.insert(attr.end(), ObjectLayout::attr, ObjectLayout::attr + ObjectLayout::count);
+
+	return rend::validateVertexLayout(prog, g_active_attr_semantics[MESH_SPHERE], &attr[0], unsigned(attr.size()));
+}
+
+// set up the attribute pointers of a batch: vertices from the bound array buffer, object indices from
+// their own - advancing per instance with instanced arrays, per vertex otherwise
+static bool setupBatchAttrPointers(
+	const rend::ActiveAttrSemantics& active_attr_semantics,
+	const uintptr_t va)
+{
+	if (!rend::setupVertexAttrPointers< Vertex >(active_attr_semantics, va))
+		return false;
+
+	glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_SPHERE_OBJ]);
+
+	if (!rend::setupVertexAttrPointers< ObjectIndex >(active_attr_semantics))
+		return false;
+
+	if (g_instanced.isAvailable())
+		g_instanced.setDivisor(active_attr_semantics.getIndexAttr(), 1);
+
+	return true;
+}
+
+// look up the uniforms of a freshly linked sphere program, and check its attributes against the mesh;
+// the program's blocks get reflected into g_uniform_blocks, even on failure
+static bool setupVariantBindings(
+	const GLuint prog,
+	GLint (& uni)[UNI_COUNT])
+{
+	if (!g_uniform_blocks.addProgram(prog)) {
+		std::cerr << __FUNCTION__ << " failed at rend::UniformBlocks::addProgram" << std::endl;
+		return false;
+	}
+
+	uni[UNI_SAMPLER_NORMAL] = glGetUniformLocation(prog, "normal_map");
+	uni[UNI_SAMPLER_ALBEDO] = glGetUniformLocation(prog, "albedo_map");
+
+	if (!validateSphereLayout(prog)) {
+		std::cerr << __FUNCTION__ << " failed at validateSphereLayout" << std::endl;
+		return false;
+	}
+
+	// texture units are fixed per sampler
+	glUseProgram(prog);
+
+	if (-1 != uni[UNI_SAMPLER_NORMAL])
+		glUniform1i(uni[UNI_SAMPLER_NORMAL], 0);
+
+	if (-1 != uni[UNI_SAMPLER_ALBEDO])
+		glUniform1i(uni[UNI_SAMPLER_ALBEDO], 1);
+
+	return true;
+}
+
+// create a program and its shaders, and queue them for a build
+static bool queueProgram(
+	util::ProgramBatch& batch,
+	const unsigned prog,
+	const char* const filename_vert,
+	const char* const filename_frag,
+	const std::string& defines,
+	GLuint (& shader_vert)[PROG_COUNT],
+	GLuint (& shader_frag)[PROG_COUNT],
+	GLuint (& shader_prog)[PROG_COUNT])
+{
+	shader_vert[prog] = glCreateShader(GL_VERTEX_SHADER);
+	assert(shader_vert[prog]);
+
+	shader_frag[prog] = glCreateShader(GL_FRAGMENT_SHADER);
+	assert(shader_frag[prog]);
+
+	shader_prog[prog] = glCreateProgram();
+	assert(shader_prog[prog]);
+
+	if (!batch.add(
+			shader_prog[prog],
+			shader_vert[prog],
+			shader_frag[prog],
+			filename_vert,
+			filename_frag,
+			defines))
+	{
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch::add" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+// queue every program the frame uses: the built sphere variants, and the programs of the depth,
+// post-processing and overdraw modes in effect
+static bool queuePrograms(
+	util::ProgramBatch& batch,
+	GLuint (& shader_vert)[PROG_COUNT],
+	GLuint (& shader_frag)[PROG_COUNT],
+	GLuint (& shader_prog)[PROG_COUNT])
+{
+	for (unsigned mask = 0; mask < g_permutations.getVariantCount(); ++mask)
+		if (g_permutations.isBuilt(mask) && !queueProgram(batch, PROG_SPHERE + mask,
+				shaderFilename(mask, ".glslv").c_str(),
+				shaderFilename(mask, ".glslf").c_str(),
+				g_permutations.getDefines(mask) + g_spec_defines,
+				shader_vert, shader_frag, shader_prog))
+		{
+			return false;
+		}
+
+	// takes the batch size along with the rest of the specialization constants
+	if (DEPTH_PREPASS == g_depth && !queueProgram(batch, PROG_PREPASS,
+			"depth_prepass.glslv", "depth_prepass.glslf", g_spec_defines,
+			shader_vert, shader_frag, shader_prog))
+	{
+		return false;
+	}
+
+	if (0 != g_post && !queueProgram(batch, PROG_POST,
+			"post.glslv", "post.glslf", std::string(),
+			shader_vert, shader_frag, shader_prog))
+	{
+		return false;
+	}
+
+	// positions as the prepass has them, so the counted fragments are those the frame draws
+	if (OVERDRAW_OFF != g_overdraw && !queueProgram(batch, PROG_OVERDRAW,
+			"depth_prepass.glslv", "overdraw.glslf", g_spec_defines,
+			shader_vert, shader_frag, shader_prog))
+	{
+		return false;
+	}
+
+	if (OVERDRAW_HEATMAP == g_overdraw && !queueProgram(batch, PROG_HEATMAP,
+			"post.glslv", "overdraw_heat.glslf", std::string(),
+			shader_vert, shader_frag, shader_prog))
+	{
+		return false;
+	}
+
+	return true;
+}
+
+// look up the uniforms of a freshly linked program of the frame, by its slot, and check it against
+// the data it gets drawn with; the program's blocks get reflected into g_uniform_blocks, even on
+// failure
+static bool setupProgramBindings(
+	const unsigned slot,
+	const GLuint prog,
+	GLint (& uni)[UNI_COUNT])
+{
+	switch (slot) {
+	case PROG_PREPASS:
+	case PROG_OVERDRAW:
+		if (!g_uniform_blocks.addProgram(prog)) {
+			std::cerr << __FUNCTION__ << " failed at rend::UniformBlocks::addProgram" << std::endl;
+			return false;
+		}
+
+		return true;
+
+	case PROG_POST:
+	case PROG_HEATMAP:
+		uni[UNI_SAMPLER_SOURCE] = glGetUniformLocation(prog, "source_map");
+		uni[UNI_BLUR_STEP] = glGetUniformLocation(prog, "blur_step");
+
+		glUseProgram(prog);
+		glUniform1i(uni[UNI_SAMPLER_SOURCE], 0);
+
+		return true;
+	}
+
+	return setupVariantBindings(prog, uni);
+}
+
+// bake a position-only draw of a batch of spheres, e.g. of the depth prepass
+static void bakePositionPacket(
+	rend::DrawList& list,
+	const unsigned prog,
+	const unsigned source,
+	const unsigned count,
+	const rend::UniformBlockSource& palette,
+	const uint16_t order)
+{
+	const bool instanced = 0 != g_batch_size && g_instanced.isAvailable();
+
+	const unsigned p = list.addPacket(g_shader_prog[prog], source,
+		GL_TRIANGLES, g_num_faces[MESH_SPHERE] * 3 * (instanced ? 1 : count), GL_UNSIGNED_SHORT);
+
+	if (instanced)
+		list.setInstances(p, count);
+
+	list.setBlock(p, rend::UNIFORM_FREQ_OBJECT, palette);
+	list.setOrder(p, order);
+}
+
+// bake the grid of spheres into the draw list, with the variant in use; materials alternate in a
+// checkerboard, so that grid order switches albedo maps with every draw. Batches take spheres of a
+// single material, in grid order - front to back, with depth - and the last batch of a material gets
+// padded to the batch size. With depth, packets get ordered front to back by their front-most sphere,
+// and the prepass and overdraw lists get the same draws with their position-only programs
+static bool bakeDrawList()
+{
+	const unsigned prog = PROG_SPHERE + g_variant;
+	const unsigned num_cells = g_grid * g_grid;
+	const unsigned batch_size = 0 != g_batch_size ? g_batch_size : 1;
+
+	g_draw_list.clear();
+	g_prepass_list.clear();
+	g_overdraw_list.clear();
+	g_object_cell.clear();
+
+	if (0 == g_batch_size) {
+		for (unsigned i = 0; i < num_cells; ++i)
+			g_object_cell.push_back(i);
+	}
+	else {
+		for (unsigned checker = 0; checker < 2; ++checker) {
+			for (unsigned j = 0; j < num_cells; ++j) {
+				const unsigned i = DEPTH_NONE != g_depth ? num_cells - 1 - j : j;
+
+				if (checker == ((i % g_grid + i / g_grid) & 1))
+					g_object_cell.push_back(i);
+			}
+
+			while (0 != g_object_cell.size() % batch_size)
+				g_object_cell.push_back(-1U);
+		}
+	}
+
+	g_object.resize(g_object_cell.size());
+
+	rend::VertexSource src;
+	src.vao = g_vao[MESH_SPHERE];
+	src.vbo_arr = g_vbo[VBO_SPHERE_VTX];
+	src.vbo_idx = g_vbo[VBO_SPHERE_IDX];
+	src.attr = &g_active_attr_semantics[MESH_SPHERE];
+	src.setup = 0 != g_batch_size ? setupBatchAttrPointers : rend::setupVertexAttrPointers< Vertex >;
+
+	const unsigned source = g_draw_list.addVertexSource(src);
+	const unsigned prepass_source = g_prepass_list.addVertexSource(src);
+	const unsigned overdraw_source = g_overdraw_list.addVertexSource(src);
+	const bool instanced = 0 != g_batch_size && g_instanced.isAvailable();
+
+	for (unsigned i = 0; i < g_object.size(); i += batch_size) {
+		unsigned count = 0;
+
+		while (count < batch_size && -1U != g_object_cell[i + count])
+			++count;
+
+		// pseudo-instancing draws the first copies of the mesh
+		const unsigned p = g_draw_list.addPacket(g_shader_prog[prog], source,
+			GL_TRIANGLES, g_num_faces[MESH_SPHERE] * 3 * (instanced ? 1 : count), GL_UNSIGNED_SHORT);
+
+		if (instanced)
+			g_draw_list.setInstances(p, count);
+
+		const unsigned cell = g_object_cell[i];
+		const bool checker = (cell % g_grid + cell / g_grid) & 1;
+
+		g_draw_list.setTexture(p, 0, g_tex[TEX_NORMAL]);
+		g_draw_list.setTexture(p, 1, g_tex[checker ? TEX_CHECKER : TEX_ALBEDO]);
+
+		rend::UniformBlockSource palette = rend::getBlockSource(g_object[i]);
+		palette.num_vec4 *= batch_size;
+
+		g_draw_list.setBlock(p, rend::UNIFORM_FREQ_OBJECT, palette);
+
+		// the last cell is the front-most
+		const uint16_t order = uint16_t(num_cells - 1 - cell);
+
+		if (DEPTH_NONE != g_depth)
+			g_draw_list.setOrder(p, order);
+
+		if (DEPTH_PREPASS == g_depth)
+			bakePositionPacket(g_prepass_list, PROG_PREPASS, prepass_source, count, palette, order);
+
+		if (OVERDRAW_OFF != g_overdraw)
+			bakePositionPacket(g_overdraw_list, PROG_OVERDRAW, overdraw_source, count, palette, order);
+	}
+
+	return true;
+}
+
+// rebuild all programs of the frame from the current shader files, as one set: swap the new programs
+// in only if all of them build and pass the checks of their bindings, otherwise delete them and keep
+// the ones in use
+static bool reloadPrograms()
+{
+	GLuint shader_vert[PROG_COUNT] = { 0 };
+	GLuint shader_frag[PROG_COUNT] = { 0 };
+	GLuint shader_prog[PROG_COUNT] = { 0 };
+	GLint uni[PROG_COUNT][UNI_COUNT];
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		for (unsigned j = 0; j < UNI_COUNT; ++j)
+			uni[i][j] = -1;
+
+	// every shader file gets loaded afresh, and so tracked again
+	util::clearShaderCache();
+	util::ProgramBatch batch;
+
+	bool success = queuePrograms(batch, shader_vert, shader_frag, shader_prog) && batch.submit() && batch.finish();
+
+	// the programs in use stay untouched while the new ones get checked
+	for (unsigned i = 0; i < PROG_COUNT && success; ++i)
+		if (0 != shader_prog[i])
+			success = setupProgramBindings(i, shader_prog[i], uni[i]);
+
+	if (!success) {
+		for (unsigned i = 0; i < PROG_COUNT; ++i) {
+			g_uniform_blocks.removeProgram(shader_prog[i]);
+
+			glDeleteProgram(shader_prog[i]);
+			glDeleteShader(shader_vert[i]);
+			glDeleteShader(shader_frag[i]);
+		}
+
+		return false;
+	}
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i) {
+		if (0 == shader_prog[i])
+			continue;
+
+		g_uniform_blocks.removeProgram(g_shader_prog[i]);
+
+		glDeleteProgram(g_shader_prog[i]);
+		glDeleteShader(g_shader_vert[i]);
+		glDeleteShader(g_shader_frag[i]);
+
+		g_shader_prog[i] = shader_prog[i];
+		g_shader_vert[i] = shader_vert[i];
+		g_shader_frag[i] = shader_frag[i];
+
+		memcpy(g_uni[i], uni[i], sizeof(g_uni[i]));
+	}
+
+	return true;
+}
+
+// upload a texture file afresh into a new texture; swap it in on success, otherwise keep the texture
+// in use
+static bool reloadTexture(
+	const unsigned tex,
+	TexDesc& desc)
+{
+	GLuint name = 0;
+	glGenTextures(1, &name);
+	assert(name);
+
+	unsigned w = desc.w;
+	unsigned h = desc.h;
+
+	if (!util::loadTexture2D(name, desc.filename, w, h)) {
+		glDeleteTextures(1, &name);
+		return false;
+	}
+
+	glDeleteTextures(1, &g_tex[tex]);
+	g_tex[tex] = name;
+	desc.w = w;
+	desc.h = h;
+
+	return true;
+}
+
+// time draws of a sphere variant into the back buffer, ahead of the first frame; record the median
+// time per draw as the variant's cost and report all stats
+static bool measureVariant(
+	const unsigned mask)
+{
+	const unsigned num_samples = 9;
+	const unsigned draws_per_sample = 4;
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+	const float aspect = float(vp[3]) / vp[2];
+
+	// a fixed pose, with the light and the viewer head-on
+	const matx3 p1 = matx3_rotate(-M_PI_2, 1.f, 0.f, 0.f);
+	const unsigned prog = PROG_SPHERE + mask;
+
+	// warm up: first draws with a program can carry its deferred compilation
+	if (!drawSphere(prog, p1, aspect))
+		return false;
+
+	glFinish();
+
+	std::vector< double > sample(num_samples);
+
+	for (unsigned i = 0; i < num_samples; ++i) {
+		const uint64_t t0 = util::time_ns();
+
+		for (unsigned j = 0; j < draws_per_sample; ++j)
+			if (!drawSphere(prog, p1, aspect))
+				return false;
+
+		glFinish();
+		sample[i] = (util::time_ns() - t0) * 1e-6 / draws_per_sample;
+	}
+
+	util::BenchStats stats;
+	util::reduceSamples(sample, stats);
+	g_permutations.setCost(mask, stats.median);
+
+	util::BenchRecord()
+		.param("variant", g_permutations.getName(mask).c_str())
+		.param("spec", g_spec ? 1 : 0)
+		.param("optimized", g_optimized ? 1 : 0)
+		.param("width", vp[2])
+		.param("height", vp[3])
+		.metric("draw_ms", stats)
+		.emit("sphere_variant");
+
+	return true;
+}
+
+// with a budget, time all built variants; pick the variant for the material
+static bool selectVariant()
+{
+	if (0.f <= g_budget)
+		for (unsigned mask = 0; mask < g_permutations.getVariantCount(); ++mask)
+			if (g_permutations.isBuilt(mask) && !measureVariant(mask))
+				return false;
+
+	g_variant = g_permutations.select(g_material.required, g_material.desired, g_budget);
+	assert(-1U != g_variant);
+
+	std::cout << "material " << g_material.name << ": variant " << g_permutations.getName(g_variant);
+
+	if (0.f <= g_budget)
+		std::cout << ", " << g_permutations.getCost(g_variant) << " ms per draw, budget " << g_budget << " ms";
+
+	std::cout << std::endl;
+	return true;
+}
+
+// draw the grid into the bound framebuffer; with a prepass, depth gets laid down with color writes
+// off, and shading then passes the depth test only at the front-most surface, without writing depth.
+// Counting draws the same with the counting program, into the shaded channel of the count target
+static bool submitGrid(
+	const bool counting)
+{
+	rend::DrawList& list = counting ? g_overdraw_list : g_draw_list;
+	rend::DrawStats count_stats;
+	rend::DrawStats& stats = counting ? count_stats : g_frame_draw_stats;
+
+	if (DEPTH_NONE == g_depth)
+		return list.submit(stats, g_sort);
+
+	glEnable(GL_DEPTH_TEST);
+	glDepthFunc(GL_LESS);
+
+	if (DEPTH_PREPASS == g_depth) {
+		rend::DrawStats prepass_stats;
+
+		glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+
+		if (!g_prepass_list.submit(prepass_stats, g_sort))
+			return false;
+
+		if (counting)
+			g_overdraw_counter.setChannel(rend::OVERDRAW_CHANNEL_SHADED);
+		else
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+
+		glDepthMask(GL_FALSE);
+		glDepthFunc(GL_LEQUAL);
+
+		if (!counting) {
+			g_draw_stats.packets         += prepass_stats.packets;
+			g_draw_stats.program_changes += prepass_stats.program_changes;
+			g_draw_stats.texture_changes += prepass_stats.texture_changes;
+			g_draw_stats.source_changes  += prepass_stats.source_changes;
+			g_draw_stats.uniform_updates += prepass_stats.uniform_updates;
+		}
+	}
+
+	if (!list.submit(stats, g_sort))
+		return false;
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_DEPTH_TEST);
+
+	return true;
+}
+
+// draw a full-screen triangle with the post-processing program in use, sampling a texture
+static bool drawFullscreenTriangle(
+	const GLuint texture)
+{
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	g_vertex_arrays.bind(g_vao[MESH_POST]);
+	glDrawArrays(GL_TRIANGLES, 0, 3);
+	g_vertex_arrays.bind(0);
+
+	DEBUG_GL_ERR()
+
+	return true;
+}
+
+// the grid, or in its place the heatmap of the frame's shaded counts
+static bool drawScene()
+{
+	if (OVERDRAW_HEATMAP != g_overdraw)
+		return submitGrid(false);
+
+	glUseProgram(g_shader_prog[PROG_HEATMAP]);
+	return drawFullscreenTriangle(g_overdraw_counter.getTexture());
+}
+
+// re-render the frame into the count target: once without a depth test for the rasterized counts,
+// then as the frame draws it for the shaded counts; leaves the given viewport set
+static bool measureOverdraw(
+	const GLint (& vp)[4])
+{
+	if (!g_overdraw_counter.init(vp[2], vp[3], DEPTH_NONE != g_depth))
+		return false;
+
+	if (!g_overdraw_counter.begin())
+		return false;
+
+	rend::DrawStats stats;
+	g_overdraw_counter.setChannel(rend::OVERDRAW_CHANNEL_RASTERIZED);
+
+	if (!g_overdraw_list.submit(stats, g_sort))
+		return false;
+
+	g_overdraw_counter.setChannel(rend::OVERDRAW_CHANNEL_SHADED);
+
+	if (!submitGrid(true))
+		return false;
+
+	if (!g_overdraw_counter.end(g_overdraw_stats))
+		return false;
+
+	glViewport(vp[0], vp[1], vp[2], vp[3]);
+	return true;
+}
+
+// frame-graph pass drawing the scene into the scene target
+static bool executeScene(
+	const rend::FrameGraph&,
+	void* const)
+{
+	return drawScene();
+}
+
+// frame-graph pass drawing a full-screen triangle that samples the target of the previous pass
+static bool executePost(
+	const rend::FrameGraph& graph,
+	void* const context)
+{
+	const PostPass& post = *reinterpret_cast< const PostPass* >(context);
+
+	glUseProgram(g_shader_prog[PROG_POST]);
+	glUniform2fv(g_uni[PROG_POST][UNI_BLUR_STEP], 1, post.blur_step);
+
+	return drawFullscreenTriangle(graph.getTexture(post.source));
+}
+
+// declare and compile the passes of a frame of the given extent: the scene into a transient target,
+// blurs along alternating axes from target to target, and a copy into the back buffer
+static bool buildFrameGraph(
+	const GLsizei width,
+	const GLsizei height)
+{
+	g_frame_graph.reset();
+	g_frame_graph.setAllowDiscard(g_discard);
+
+	// passes refer to their records by address
+	g_post_pass.resize(g_post + 1);
+
+	const rend::TargetDesc desc = { width, height, GL_RGBA };
+	const unsigned backbuffer = g_frame_graph.importBackbuffer("backbuffer", width, height);
+	unsigned source = g_frame_graph.createTarget("scene", desc);
+
+	const unsigned scene = g_frame_graph.addPass("scene", executeScene, 0);
+	g_frame_graph.write(scene, source, true);
+
+	if (DEPTH_NONE != g_depth) {
+		const rend::TargetDesc depth_desc = { width, height, GL_DEPTH_COMPONENT16 };
+		g_frame_graph.write(scene, g_frame_graph.createTarget("scene_depth", depth_desc), true);
+	}
+
+	for (unsigned i = 0; i < g_post; ++i) {
+		PostPass& post = g_post_pass[i];
+		post.source = source;
+		post.blur_step[0] = i % 2 ? 0.f : 1.f / width;
+		post.blur_step[1] = i % 2 ? 1.f / height : 0.f;
+
+		const unsigned target = g_frame_graph.createTarget("blur", desc);
+		const unsigned pass = g_frame_graph.addPass("blur", executePost, &post);
+
+		g_frame_graph.read(pass, source);
+		g_frame_graph.write(pass, target);
+		source = target;
+	}
+
+	PostPass& present = g_post_pass[g_post];
+	present.source = source;
+	present.blur_step[0] = 0.f;
+	present.blur_step[1] = 0.f;
+
+	const unsigned pass = g_frame_graph.addPass("present", executePost, &present);
+
+	g_frame_graph.read(pass, source);
+	g_frame_graph.write(pass, backbuffer);
+
+	if (!g_frame_graph.compile())
+		return false;
+
+	g_graph_width = width;
+	g_graph_height = height;
+
+	const rend::FrameGraphStats& stats = g_frame_graph.getStats();
+
+	std::cout << "frame graph: " << stats.passes << " passes, " << stats.passes_culled << " culled; " <<
+		stats.targets << " transient targets on " << stats.targets_physical << " physical, " <<
+		stats.bytes_peak / 1024 << " KiB of " << stats.bytes_requested / 1024 << " KiB requested" << std::endl;
+
+	return true;
+}
+
+// per-frame uniforms of the grid: the spheres share a pose and sit in cells of the viewport, each in
+// a depth slice of its own, from the back for the first cell to the front for the last
+static void updateUniforms(
+	const matx3& p1,
+	const float aspect)
+{
+	updateFrameBlock(p1);
+
+	const float scale = 1.f / g_grid;
+	const float size = scale * g_overlap;
+	const float depth_scale = 1.f / (g_grid * g_grid);
+
+	for (unsigned i = 0; i < g_object.size(); ++i) {
+		const unsigned cell = g_object_cell[i];
+
+		if (-1U == cell)
+			continue;
+
+		GLfloat (& mvp)[4][4] = g_object[i].mvp;
+
+		// expand to 4x4, sign-inverting z in all original columns (for GL screen space), then place in
+		// the sphere's cell and depth slice
+		for (unsigned j = 0; j < 3; ++j) {
+			mvp[j][0] = p1[j][0] * aspect * size;
+			mvp[j][1] = p1[j][1] * size;
+			mvp[j][2] = -p1[j][2] * depth_scale;
+			mvp[j][3] = 0.f;
+		}
+
+		mvp[3][0] = (2.f * (cell % g_grid) + 1.f) * scale - 1.f;
+		mvp[3][1] = (2.f * (cell / g_grid) + 1.f) * scale - 1.f;
+		mvp[3][2] = 1.f - (2.f * cell + 1.f) * depth_scale;
+		mvp[3][3] = 1.f;
+	}
+
+	// a grid of one keeps pointing at the same object block
+	g_uniform_blocks.setDirty(rend::UNIFORM_FREQ_OBJECT);
+}
+
+// draw the posed grid into the back buffer, through the frame graph with post-processing
+static bool drawFrame(
+	const GLint (& vp)[4])
+{
+	if (0 == g_post) {
+		if (!g_frame_pass.begin(vp[2], vp[3], g_pass_stats))
+			return false;
+
+		if (!drawScene())
+			return false;
+
+		if (!g_frame_pass.end(g_pass_stats))
+			return false;
+	}
+	else {
+		// transient targets follow the extent of the viewport
+		if ((vp[2] != g_graph_width || vp[3] != g_graph_height) && !buildFrameGraph(vp[2], vp[3]))
+			return false;
+
+		if (!g_frame_graph.execute(g_pass_stats))
+			return false;
+	}
+
+	g_draw_stats.packets         += g_frame_draw_stats.packets;
+	g_draw_stats.program_changes += g_frame_draw_stats.program_changes;
+	g_draw_stats.texture_changes += g_frame_draw_stats.texture_changes;
+	g_draw_stats.source_changes  += g_frame_draw_stats.source_changes;
+	g_draw_stats.uniform_updates += g_frame_draw_stats.uniform_updates;
+
+	return true;
+}
+
+// many drivers finish compiling a program - or recompile it for the state it meets: blending, masks,
+// target format - at its first draw; get that done ahead of the first frame, and after every reload.
+// Built variants get drawn into the back buffer in the depth state of the shading pass, and then a
+// whole frame gets drawn - overdraw counting, depth prepass, instancing, post-processing - in its own
+// targets and state. The scissor confines the draws to a single pixel, which the next frame clears;
+// the counters of the run are left as they were
+static bool prewarmPrograms()
+{
+	const uint64_t t0 = util::time_ns();
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+	const float aspect = float(vp[3]) / vp[2];
+
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(vp[0], vp[1], 1, 1);
+
+	if (requires_depth()) {
+		glEnable(GL_DEPTH_TEST);
+		glDepthFunc(DEPTH_PREPASS == g_depth ? GL_LEQUAL : GL_LESS);
+		glDepthMask(DEPTH_PREPASS == g_depth ? GL_FALSE : GL_TRUE);
+	}
+
+	const matx3 p1 = matx3_rotate(-M_PI_2, 1.f, 0.f, 0.f);
+
+	for (unsigned mask = 0; mask < g_permutations.getVariantCount(); ++mask)
+		if (g_permutations.isBuilt(mask) && !drawSphere(PROG_SPHERE + mask, p1, 1.f))
+			return false;
+
+	glDepthMask(GL_TRUE);
+	glDisable(GL_DEPTH_TEST);
+
+	const rend::DrawStats draw_stats = g_draw_stats;
+	const rend::RenderPassStats pass_stats = g_pass_stats;
+	const rend::OverdrawStats overdraw_stats = g_overdraw_stats;
+
+	updateUniforms(p1, aspect);
+
+	if (OVERDRAW_OFF != g_overdraw && !measureOverdraw(vp))
+		return false;
+
+	if (!drawFrame(vp))
+		return false;
+
+	g_draw_stats = draw_stats;
+	g_pass_stats = pass_stats;
+	g_overdraw_stats = overdraw_stats;
+
+	glDisable(GL_SCISSOR_TEST);
+	glFinish();
+
+	unsigned count = 0;
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		if (0 != g_shader_prog[i])
+			++count;
+
+	std::cout << "prewarm: " << count << " programs in " << (util::time_ns() - t0) * 1e-6 << " ms" << std::endl;
+	return true;
+}
+
+#if DEBUG && PLATFORM_GL_KHR_debug
+static void debugProc(
+	GLenum source,
+	GLenum type,
+	GLuint id,
+	GLenum severity,
+	GLsizei length,
+	const GLchar* message,
+	const void* userParam)
+{
+	fprintf(stderr, "log: %s\n", message);
+}
+
+#endif
+bool init_resources()
+{
+#if PLATFORM_GLES
+#if PLATFORM_GL_KHR_debug
+	glDebugMessageControlKHR  = (PFNGLDEBUGMESSAGECONTROLKHRPROC)  eglGetProcAddress("glDebugMessageControlKHR");
+	glDebugMessageInsertKHR   = (PFNGLDEBUGMESSAGEINSERTKHRPROC)   eglGetProcAddress("glDebugMessageInsertKHR");
+	glDebugMessageCallbackKHR = (PFNGLDEBUGMESSAGECALLBACKKHRPROC) eglGetProcAddress("glDebugMessageCallbackKHR");
+	glGetDebugMessageLogKHR   = (PFNGLGETDEBUGMESSAGELOGKHRPROC)   eglGetProcAddress("glGetDebugMessageLogKHR");
+	glPushDebugGroupKHR       = (PFNGLPUSHDEBUGGROUPKHRPROC)       eglGetProcAddress("glPushDebugGroupKHR");
+	glPopDebugGroupKHR        = (PFNGLPOPDEBUGGROUPKHRPROC)        eglGetProcAddress("glPopDebugGroupKHR");
+	glObjectLabelKHR          = (PFNGLOBJECTLABELKHRPROC)          eglGetProcAddress("glObjectLabelKHR");
+	glGetObjectLabelKHR       = (PFNGLGETOBJECTLABELKHRPROC)       eglGetProcAddress("glGetObjectLabelKHR");
+	glObjectPtrLabelKHR       = (PFNGLOBJECTPTRLABELKHRPROC)       eglGetProcAddress("glObjectPtrLabelKHR");
+	glGetObjectPtrLabelKHR    = (PFNGLGETOBJECTPTRLABELKHRPROC)    eglGetProcAddress("glGetObjectPtrLabelKHR");
+	glGetPointervKHR          = (PFNGLGETPOINTERVKHRPROC)          eglGetProcAddress("glGetPointervKHR");
+
+#endif
+#endif
+#if DEBUG && PLATFORM_GL_KHR_debug
+	glDebugMessageCallbackKHR(debugProc, NULL);
+	glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS_KHR);
+	glEnable(GL_DEBUG_OUTPUT_KHR);
+	DEBUG_GL_ERR()
+
+	glDebugMessageInsertKHR(
+		GL_DEBUG_SOURCE_APPLICATION_KHR,
+		GL_DEBUG_TYPE_OTHER_KHR,
+		GLuint(42),
+		GL_DEBUG_SEVERITY_HIGH_KHR,
+		GLint(-1), 
 		"testing 1, 2, 3");
 	DEBUG_GL_ERR()
 
@@ -539,19 +1882,115 @@ bool init_resources(
 
 	/////////////////////////////////////////////////////////////////
 
+	if (requires_depth()) {
+		GLint depth_bits = 0;
+		glGetIntegerv(GL_DEPTH_BITS, &depth_bits);
+
+		if (0 == depth_bits) {
+			std::cerr << __FUNCTION__ << " depth test requested but surface has no depth buffer" << std::endl;
+			return false;
+		}
+	}
+
 	glEnable(GL_CULL_FACE);
 	glDisable(GL_DEPTH_TEST);
 
-	const GLclampf red = 0.f;
-	const GLclampf green = 0.f;
-	const GLclampf blue = 0.f;
-	const GLclampf alpha = 1.f;
+	// the color buffer gets cleared and presented; depth and stencil, unless left to the driver, get
+	// cleared rather than loaded, and discarded rather than stored - depth in use gets cleared regardless
+	rend::RenderPassDesc pass;
+	pass.fbo = 0;
+	pass.load[rend::ATTACHMENT_COLOR] = rend::LOAD_ACTION_CLEAR;
+	pass.store[rend::ATTACHMENT_COLOR] = rend::STORE_ACTION_STORE;
+
+	for (unsigned i = rend::ATTACHMENT_DEPTH; i <= rend::ATTACHMENT_STENCIL; ++i) {
+		pass.load[i] = g_discard ? rend::LOAD_ACTION_DONT_CARE : rend::LOAD_ACTION_LOAD;
+		pass.store[i] = g_discard ? rend::STORE_ACTION_DISCARD : rend::STORE_ACTION_STORE;
+	}
+
+	if (requires_depth())
+		pass.load[rend::ATTACHMENT_DEPTH] = rend::LOAD_ACTION_CLEAR;
+
+	pass.clear_color[0] = 0.f;
+	pass.clear_color[1] = 0.f;
+	pass.clear_color[2] = 0.f;
+	pass.clear_color[3] = 1.f;
+	pass.clear_depth = 1.f;
+	pass.clear_stencil = 0;
+
+	g_frame_pass.init(pass, g_discard);
+
+	/////////////////////////////////////////////////////////////////
+
+	// kick off all programs first, and collect them once textures and meshes are loaded
+	util::ProgramBatch batch;
+
+	// with a budget, build every variant selection can pick from, to be timed; otherwise just the
+	// desired one
+	g_material.desired |= g_material.required;
+
+	util::SpecConstants spec;
+
+	// optimized sources come from the uniform path - specialization would go unnoticed, and so would
+	// batching
+	if (g_optimized) {
+		g_spec = false;
+		g_batch = false;
+	}
+
+	if (g_spec) {
+		spec.set("LIGHT_W", g_light_w);
+		spec.set("VIEWER_W", g_viewer_w);
+		spec.set("SHININESS", g_shininess);
+	}
+
+	if (g_batch) {
+		g_instanced.init(g_instanced_arrays);
+
+		// the palette shares the vertex uniform vectors with the frame block; the replicas of
+		// pseudo-instancing share the index range
+		const GLint frame_vec4 = sizeof(FrameBlock) / (4 * sizeof(GLfloat));
+		const GLint object_vec4 = sizeof(ObjectBlock) / (4 * sizeof(GLfloat));
+		GLint max_vec4 = 0;
+
+		glGetIntegerv(GL_MAX_VERTEX_UNIFORM_VECTORS, &max_vec4);
+
+		g_batch_size = std::min(max_batch_size, unsigned(std::max(max_vec4 - frame_vec4, GLint(0)) / object_vec4));
+
+		if (!g_instanced.isAvailable())
+			g_batch_size = std::min(g_batch_size, unsigned(65536 / util::polarSphereNumVerts(sphere_rows, sphere_cols)));
+
+		if (0 == g_batch_size) {
+			std::cerr << __FUNCTION__ << " found no room for a batch palette" << std::endl;
+			return false;
+		}
+
+		spec.set("BATCH_SIZE", int(g_batch_size));
+
+		std::cout << "batches: " << g_batch_size << " spheres, through " <<
+			(g_instanced.isAvailable() ? "instanced arrays" : "pseudo-instancing") << std::endl;
+	}
+
+	g_spec_defines = spec.getDefines();
+
+	for (unsigned mask = 0; mask < g_permutations.getVariantCount(); ++mask) {
+		if (!util::ShaderPermutations::within(mask, g_material.required, g_material.desired))
+			continue;
+
+		if (0.f > g_budget && mask != g_material.desired)
+			continue;
 
-	glClearColor(
-		red, 
-		green, 
-		blue, 
-		alpha);
+		g_permutations.setBuilt(mask);
+	}
+
+	if (!queuePrograms(batch, g_shader_vert, g_shader_frag, g_shader_prog)) {
+		std::cerr << __FUNCTION__ << " failed at queuePrograms" << std::endl;
+		return false;
+	}
+
+	if (!batch.submit()) {
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch::submit" << std::endl;
+		return false;
+	}
 
 	/////////////////////////////////////////////////////////////////
 
@@ -572,6 +2011,16 @@ bool init_resources(
 		return false;
 	}
 
+	const unsigned checker_dim = 64;
+	std::vector< util::pix > checker(checker_dim * checker_dim);
+	util::fill_with_checker(&checker[0], checker_dim * sizeof(util::pix), checker_dim, checker_dim);
+
+	if (!util::setupTexture2D(g_tex[TEX_CHECKER], &checker[0], checker_dim, checker_dim))
+	{
+		std::cerr << __FUNCTION__ << " failed at setupTexture2D" << std::endl;
+		return false;
+	}
+
 	/////////////////////////////////////////////////////////////////
 
 	for (unsigned i = 0; i < PROG_COUNT; ++i)
@@ -580,94 +2029,123 @@ bool init_resources(
 
 	/////////////////////////////////////////////////////////////////
 
-	const std::string patch[] = {
-#if PLATFORM_GLES
-		std::string("///essl "),
-#elif PLATFORM_GL
-		std::string("///glsl "),
-#else
-#error unknown platform
-#endif
-		std::string("")
-	};
+	g_vertex_arrays.init(g_vao_native, &g_instanced);
+
+	std::cout << "vertex arrays: " << (g_vertex_arrays.isNative() ? "native" : "emulated") << std::endl;
+
+	glGenBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
 
-	g_shader_vert[PROG_SPHERE] = glCreateShader(GL_VERTEX_SHADER);
-	assert(g_shader_vert[PROG_SPHERE]);
+	for (unsigned i = 0; i < sizeof(g_vbo) / sizeof(g_vbo[0]); ++i)
+		assert(g_vbo[i]);
 
-	if (!util::setupShaderWithPatch(g_shader_vert[PROG_SPHERE], "phong_bump_tang.glslv",
-			sizeof(patch) / sizeof(patch[0]) / 2, patch)) {
-		std::cerr << __FUNCTION__ << " failed at setupShader" << std::endl;
+	if (!createIndexedPolarSphere(
+			g_vbo[VBO_SPHERE_VTX],
+			g_vbo[VBO_SPHERE_IDX],
+			g_vbo[VBO_SPHERE_OBJ],
+			g_num_faces[MESH_SPHERE]))
+	{
+		std::cerr << __FUNCTION__ << " failed at createIndexedPolarSphere" << std::endl;
 		return false;
 	}
 
-	g_shader_frag[PROG_SPHERE] = glCreateShader(GL_FRAGMENT_SHADER);
-	assert(g_shader_frag[PROG_SPHERE]);
+	g_active_attr_semantics[MESH_SPHERE] = rend::getFixedAttrSemantics< Vertex >();
 
-	if (!util::setupShaderWithPatch(g_shader_frag[PROG_SPHERE], "phong_bump_tang.glslf",
-			sizeof(patch) / sizeof(patch[0]) / 2, patch)) {
-		std::cerr << __FUNCTION__ << " failed at setupShader" << std::endl;
+	if (0 != g_batch_size)
+		g_active_attr_semantics[MESH_SPHERE].registerIndexAttr(util::ATTR_LOC_INDEX);
+
+	g_vao[MESH_SPHERE] = g_vertex_arrays.create(
+		g_vbo[VBO_SPHERE_VTX],
+		g_vbo[VBO_SPHERE_IDX],
+		g_active_attr_semantics[MESH_SPHERE],
+		0 != g_batch_size ? setupBatchAttrPointers : rend::setupVertexAttrPointers< Vertex >);
+
+	if (0 == g_vao[MESH_SPHERE]) {
+		std::cerr << __FUNCTION__ << " failed at rend::VertexArrays::create" << std::endl;
 		return false;
 	}
 
-	g_shader_prog[PROG_SPHERE] = glCreateProgram();
-	assert(g_shader_prog[PROG_SPHERE]);
+	if (0 != g_post || OVERDRAW_HEATMAP == g_overdraw) {
+		// one triangle over the whole viewport, counter-clockwise
+		static const PostVertex post_vertex[] = {
+			{ { -1.f, -1.f } },
+			{ {  3.f, -1.f } },
+			{ { -1.f,  3.f } }
+		};
 
-	if (!util::setupProgram(
-			g_shader_prog[PROG_SPHERE],
-			g_shader_vert[PROG_SPHERE],
-			g_shader_frag[PROG_SPHERE]))
-	{
-		std::cerr << __FUNCTION__ << " failed at setupProgram" << std::endl;
-		return false;
+		glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_POST_VTX]);
+		glBufferData(GL_ARRAY_BUFFER, sizeof(post_vertex), post_vertex, GL_STATIC_DRAW);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		g_active_attr_semantics[MESH_POST] = rend::getFixedAttrSemantics< PostVertex >();
+
+		g_vao[MESH_POST] = g_vertex_arrays.create(
+			g_vbo[VBO_POST_VTX],
+			0,
+			g_active_attr_semantics[MESH_POST],
+			rend::setupVertexAttrPointers< PostVertex >);
+
+		if (0 == g_vao[MESH_POST]) {
+			std::cerr << __FUNCTION__ << " failed at rend::VertexArrays::create" << std::endl;
+			return false;
+		}
 	}
 
-	g_uni[PROG_SPHERE][UNI_MVP]    = glGetUniformLocation(g_shader_prog[PROG_SPHERE], "mvp");
-	g_uni[PROG_SPHERE][UNI_LP_OBJ] = glGetUniformLocation(g_shader_prog[PROG_SPHERE], "lp_obj");
-	g_uni[PROG_SPHERE][UNI_VP_OBJ] = glGetUniformLocation(g_shader_prog[PROG_SPHERE], "vp_obj");
+	/////////////////////////////////////////////////////////////////
 
-	g_uni[PROG_SPHERE][UNI_SAMPLER_NORMAL] = glGetUniformLocation(g_shader_prog[PROG_SPHERE], "normal_map");
-	g_uni[PROG_SPHERE][UNI_SAMPLER_ALBEDO] = glGetUniformLocation(g_shader_prog[PROG_SPHERE], "albedo_map");
+	if (!batch.finish()) {
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch::finish" << std::endl;
+		return false;
+	}
 
-	g_active_attr_semantics[PROG_SPHERE].registerVertexAttr(
-		glGetAttribLocation(g_shader_prog[PROG_SPHERE], "at_Vertex"));
-	g_active_attr_semantics[PROG_SPHERE].registerNormalAttr(
-		glGetAttribLocation(g_shader_prog[PROG_SPHERE], "at_Normal"));
-	g_active_attr_semantics[PROG_SPHERE].registerTCoordAttr(
-		glGetAttribLocation(g_shader_prog[PROG_SPHERE], "at_MultiTexCoord0"));
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		if (0 != g_shader_prog[i] && !setupProgramBindings(i, g_shader_prog[i], g_uni[i])) {
+			std::cerr << __FUNCTION__ << " failed at setupProgramBindings" << std::endl;
+			return false;
+		}
 
 	/////////////////////////////////////////////////////////////////
 
-#if PLATFORM_GL_OES_vertex_array_object
-	glGenVertexArraysOES(sizeof(g_vao) / sizeof(g_vao[0]), g_vao);
+	if (!selectVariant()) {
+		std::cerr << __FUNCTION__ << " failed at selectVariant" << std::endl;
+		return false;
+	}
 
-	for (unsigned i = 0; i < sizeof(g_vao) / sizeof(g_vao[0]); ++i)
-		assert(g_vao[i]);
+	// absent from the shaders when specialized
+	g_material_block.shininess[0] = g_shininess;
+	g_material_block.shininess[1] = 0.f;
+	g_material_block.shininess[2] = 0.f;
+	g_material_block.shininess[3] = 0.f;
 
-#endif
-	glGenBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+	g_uniform_blocks.setBlock(rend::UNIFORM_FREQ_FRAME, rend::getBlockSource(g_frame_block));
+	g_uniform_blocks.setBlock(rend::UNIFORM_FREQ_MATERIAL, rend::getBlockSource(g_material_block));
 
-	for (unsigned i = 0; i < sizeof(g_vbo) / sizeof(g_vbo[0]); ++i)
-		assert(g_vbo[i]);
+	g_draw_list.setVertexArrays(&g_vertex_arrays);
+	g_draw_list.setUniformBlocks(&g_uniform_blocks);
+	g_draw_list.setInstancedArrays(&g_instanced);
+	g_draw_list.setOrderFirst(DEPTH_NONE != g_depth);
 
-	if (!createIndexedPolarSphere(
-			g_vbo[VBO_SPHERE_VTX],
-			g_vbo[VBO_SPHERE_IDX],
-			g_num_faces[MESH_SPHERE]))
-	{
-		std::cerr << __FUNCTION__ << " failed at createIndexedPolarSphere" << std::endl;
+	g_prepass_list.setVertexArrays(&g_vertex_arrays);
+	g_prepass_list.setUniformBlocks(&g_uniform_blocks);
+	g_prepass_list.setInstancedArrays(&g_instanced);
+	g_prepass_list.setOrderFirst(true);
+
+	g_overdraw_list.setVertexArrays(&g_vertex_arrays);
+	g_overdraw_list.setUniformBlocks(&g_uniform_blocks);
+	g_overdraw_list.setInstancedArrays(&g_instanced);
+	g_overdraw_list.setOrderFirst(true);
+
+	if (!bakeDrawList()) {
+		std::cerr << __FUNCTION__ << " failed at bakeDrawList" << std::endl;
 		return false;
 	}
 
-#if PLATFORM_GL_OES_vertex_array_object
-	glBindVertexArrayOES(g_vao[PROG_SPHERE]);
-
-#endif
-	glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_SPHERE_VTX]);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, g_vbo[VBO_SPHERE_IDX]);
+	if (g_prewarm && !prewarmPrograms()) {
+		std::cerr << __FUNCTION__ << " failed at prewarmPrograms" << std::endl;
+		return false;
+	}
 
-	if (!setupVertexAttrPointers< Vertex >(g_active_attr_semantics[PROG_SPHERE])) {
-		std::cerr << __FUNCTION__ <<
-			" failed at setupVertexAttrPointers" << std::endl;
+	if (g_watch && !g_watcher.addDirectory(".")) {
+		std::cerr << __FUNCTION__ << " failed at FileWatcher::addDirectory" << std::endl;
 		return false;
 	}
 
@@ -675,85 +2153,65 @@ bool init_resources(
 	return true;
 }
 
-class matx3;
-static matx3 matx3_mul(const matx3&, const matx3&);
+// between frames, pick up changed shader and texture files; failed reloads leave the resources in use
+// intact, so a broken edit shows in the log rather than on screen
+static bool reloadChanged()
+{
+	std::vector< std::string > changed;
 
-class matx3 {
-	friend matx3 matx3_mul(const matx3&, const matx3&);
-	float m[3][3];
+	if (!g_watcher.poll(changed))
+		return true;
 
-public:
-	matx3() {}
+	bool shaders_changed = false;
 
-	matx3(
-		const float c0_0, const float c0_1, const float c0_2,
-		const float c1_0, const float c1_1, const float c1_2,
-		const float c2_0, const float c2_1, const float c2_2)
-	{
-		m[0][0] = c0_0;
-		m[0][1] = c0_1;
-		m[0][2] = c0_2;
-		m[1][0] = c1_0;
-		m[1][1] = c1_1;
-		m[1][2] = c1_2;
-		m[2][0] = c2_0;
-		m[2][1] = c2_1;
-		m[2][2] = c2_2;
-	}
-
-	const float (& operator[](const size_t i) const)[3] { return m[i]; }
-
-	template < size_t NUM_VECT, size_t NUM_ELEM >
-	void transform(
-		const float (& a)[NUM_VECT][NUM_ELEM],
-		float (& out)[NUM_VECT][NUM_ELEM]) const {
-
-		const size_t num_vect = NUM_VECT;
-		const size_t num_elem = 3;
-		const util::compile_assert< num_elem <= NUM_ELEM > assert_num_elem;
-
-		for (size_t j = 0; j < num_vect; ++j) {
-			float out_j[num_elem];
-			const float a_j0 = a[j][0];
-			for (size_t i = 0; i < num_elem; ++i) {
-				out_j[i] = a_j0 * m[0][i];
-			}
-			for (size_t k = 1; k < num_elem; ++k) {
-				const float a_jk = a[j][k];
-				for (size_t i = 0; i < num_elem; ++i) {
-					out_j[i] += a_jk * m[k][i];
-				}
-			}
-			for (size_t i = 0; i < num_elem; ++i)
-				out[j][i] = out_j[i];
-			for (size_t i = num_elem; i < NUM_ELEM; ++i)
-				out[j][i] = a[j][i];
+	for (size_t i = 0; i < changed.size(); ++i)
+		shaders_changed = shaders_changed || util::isShaderFileLoaded(changed[i].c_str());
+
+	if (shaders_changed) {
+		const uint64_t t0 = util::time_ns();
+
+		if (!reloadPrograms()) {
+			std::cerr << "reload: shaders failed to build, keeping previous programs" << std::endl;
+		}
+		else {
+			std::cout << "reload: programs rebuilt in " << (util::time_ns() - t0) * 1e-6 << " ms" << std::endl;
+
+			// costs of the new programs are unknown until timed
+			if (!selectVariant())
+				return false;
+
+			if (!bakeDrawList())
+				return false;
+
+			if (g_prewarm && !prewarmPrograms())
+				return false;
+
+			g_live.reset();
 		}
 	}
-};
 
-static matx3 matx3_mul(
-	const matx3& ma,
-	const matx3& mb)
-{
-	matx3 mc;
-	mb.transform(ma.m, mc.m);
-	return mc;
-}
+	TexDesc* const desc[] = { &g_normal, &g_albedo };
+	bool textures_changed = false;
 
-static matx3 matx3_rotate(
-	const float a,
-	const float x,
-	const float y,
-	const float z)
-{
-	const float sin_a = sinf(a);
-	const float cos_a = cosf(a);
+	for (unsigned i = 0; i < sizeof(desc) / sizeof(desc[0]); ++i) {
+		if (changed.end() == std::find(changed.begin(), changed.end(), desc[i]->filename))
+			continue;
+
+		const uint64_t t0 = util::time_ns();
 
-	return matx3(
-		x * x + cos_a * (1 - x * x),         x * y - cos_a * (x * y) + sin_a * z, x * z - cos_a * (x * z) - sin_a * y,
-		y * x - cos_a * (y * x) - sin_a * z, y * y + cos_a * (1 - y * y),         y * z - cos_a * (y * z) + sin_a * x,
-		z * x - cos_a * (z * x) + sin_a * y, z * y - cos_a * (z * y) - sin_a * x, z * z + cos_a * (1 - z * z));
+		if (!reloadTexture(i, *desc[i])) {
+			std::cerr << "reload: texture '" << desc[i]->filename << "' failed to load, keeping previous" << std::endl;
+			continue;
+		}
+
+		std::cout << "reload: texture '" << desc[i]->filename << "' uploaded in " <<
+			(util::time_ns() - t0) * 1e-6 << " ms" << std::endl;
+
+		textures_changed = true;
+	}
+
+	// packets refer to textures by name
+	return !textures_changed || bakeDrawList();
 }
 
 bool render_frame()
@@ -761,7 +2219,12 @@ bool render_frame()
 	if (!check_context(__FUNCTION__))
 		return false;
 
-	glClear(GL_COLOR_BUFFER_BIT);
+	if (g_watch && !reloadChanged())
+		return false;
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+	const float aspect = float(vp[3]) / vp[2];
 
 	/////////////////////////////////////////////////////////////////
 
@@ -772,99 +2235,38 @@ bool render_frame()
 	const matx3 p0 = matx3_mul(r0, r1);
 	const matx3 p1 = matx3_mul(p0, r2);
 
-	GLint vp[4];
-	glGetIntegerv(GL_VIEWPORT, vp);
-	const float aspect = float(vp[3]) / vp[2];
-
-	// expand to 4x4, sign-inverting z in all original columns (for GL screen space)
-	const GLfloat mvp[4][4] =
-	{
-		{  p1[0][0] * aspect,  p1[0][1], -p1[0][2],  0.f },
-		{  p1[1][0] * aspect,  p1[1][1], -p1[1][2],  0.f },
-		{  p1[2][0] * aspect,  p1[2][1], -p1[2][2],  0.f },
-		{  0.f,                0.f,       0.f,       1.f }
-	};
-
 	g_angle = fmodf(g_angle + g_angle_step, 2.f * M_PI);
 
 	/////////////////////////////////////////////////////////////////
 
-	glUseProgram(g_shader_prog[PROG_SPHERE]);
-
-	DEBUG_GL_ERR()
-
-	if (-1 != g_uni[PROG_SPHERE][UNI_MVP])
-	{
-		glUniformMatrix4fv(g_uni[PROG_SPHERE][UNI_MVP],
-			1, GL_FALSE, reinterpret_cast< const GLfloat* >(mvp));
-	}
-
-	DEBUG_GL_ERR()
-
-	if (-1 != g_uni[PROG_SPHERE][UNI_LP_OBJ])
-	{
-		const GLfloat nonlocal_light[4] =
-		{
-			p1[0][2],
-			p1[1][2],
-			p1[2][2],
-			0.f
-		};
-
-		glUniform4fv(g_uni[PROG_SPHERE][UNI_LP_OBJ], 1, nonlocal_light);
-	}
+	updateUniforms(p1, aspect);
 
-	DEBUG_GL_ERR()
+	if (OVERDRAW_OFF != g_overdraw && !measureOverdraw(vp))
+		return false;
 
-	if (-1 != g_uni[PROG_SPHERE][UNI_VP_OBJ])
-	{
-		const GLfloat nonlocal_viewer[4] =
-		{
-			p1[0][2],
-			p1[1][2],
-			p1[2][2],
-			0.f
-		};
+	const uint64_t t0 = util::time_ns();
 
-		glUniform4fv(g_uni[PROG_SPHERE][UNI_VP_OBJ], 1, nonlocal_viewer);
-	}
+	if (!drawFrame(vp))
+		return false;
 
-	DEBUG_GL_ERR()
+	++g_num_frames;
 
-	if (g_tex[TEX_NORMAL] && -1 != g_uni[PROG_SPHERE][UNI_SAMPLER_NORMAL])
-	{
-		glActiveTexture(GL_TEXTURE0);
-		glBindTexture(GL_TEXTURE_2D, g_tex[TEX_NORMAL]);
+	if (!g_watch)
+		return true;
 
-		glUniform1i(g_uni[PROG_SPHERE][UNI_SAMPLER_NORMAL], 0);
-	}
+	// live timing drains the pipeline each frame - for development, not for benchmarking
+	glFinish();
 
-	DEBUG_GL_ERR()
+	if (g_live.addFrame(util::time_ns() - t0)) {
+		util::BenchStats stats;
+		g_live.getStats(stats);
 
-	if (g_tex[TEX_ALBEDO] && -1 != g_uni[PROG_SPHERE][UNI_SAMPLER_ALBEDO])
-	{
-		glActiveTexture(GL_TEXTURE1);
-		glBindTexture(GL_TEXTURE_2D, g_tex[TEX_ALBEDO]);
+		std::cout << "live: variant " << g_permutations.getName(g_variant) << ", draw ms median " <<
+			stats.median << ", p95 " << stats.p95 << std::endl;
 
-		glUniform1i(g_uni[PROG_SPHERE][UNI_SAMPLER_ALBEDO], 1);
+		g_live.reset();
 	}
 
-	DEBUG_GL_ERR()
-
-	for (unsigned i = 0; i < g_active_attr_semantics[PROG_SPHERE].num_active_attr; ++i)
-		glEnableVertexAttribArray(g_active_attr_semantics[PROG_SPHERE].active_attr[i]);
-
-	DEBUG_GL_ERR()
-
-	glDrawElements(GL_TRIANGLES, g_num_faces[MESH_SPHERE] * 3, GL_UNSIGNED_SHORT, (void*) 0);
-
-	DEBUG_GL_ERR()
-
-	for (unsigned i = 0; i < g_active_attr_semantics[PROG_SPHERE].num_active_attr; ++i)
-		glDisableVertexAttribArray(g_active_attr_semantics[PROG_SPHERE].active_attr[i]);
-
-	DEBUG_GL_ERR()
-
 	return true;
 }
 
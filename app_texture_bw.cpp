@@ -0,0 +1,893 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+#include "scoped.hpp"
+#include "util_misc.hpp"
+#include "util_bench.hpp"
+#include "util_progcache.hpp"
+#include "pure_macro.hpp"
+
+#include "rendVertAttr.hpp"
+#include "rendVertLayout.hpp"
+
+using util::scoped_ptr;
+using util::scoped_functor;
+using util::deinit_resources_t;
+
+namespace {
+
+struct Vertex {
+	GLfloat pos[2];
+};
+
+} // namespace
+
+template <>
+const rend::VertAttrFormat rend::VertexLayout< Vertex >::attr[] = {
+	REND_VERT_ATTR(Vertex, pos, vertex, GL_FALSE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< Vertex >::count = REND_VERT_LAYOUT_COUNT(Vertex);
+
+namespace hook {
+
+static const char* arg_prefix      = "-";
+static const char* arg_app         = "app";
+
+static const char* arg_size        = "size";
+static const char* arg_format      = "format";
+static const char* arg_filter      = "filter";
+static const char* arg_pattern     = "pattern";
+static const char* arg_units       = "units";
+static const char* arg_layers      = "layers";
+static const char* arg_texel_ratio = "texel_ratio";
+static const char* arg_warmup      = "warmup";
+static const char* arg_frames      = "frames";
+
+static const char scene_name[] = "texture_bw";
+
+enum {
+	FORMAT_RGBA8888,
+	FORMAT_RGB888,
+	FORMAT_RGB565,
+	FORMAT_RGBA4444,
+	FORMAT_L8,
+
+	FORMAT_COUNT,
+	FORMAT_FORCE_UINT = -1U
+};
+
+static const char* const format_name[FORMAT_COUNT] = {
+	"rgba8888",
+	"rgb888",
+	"rgb565",
+	"rgba4444",
+	"l8"
+};
+
+static const struct {
+	GLenum format;
+	GLenum type;
+	unsigned bytes;
+} format_desc[FORMAT_COUNT] = {
+	{ GL_RGBA,      GL_UNSIGNED_BYTE,          4 },
+	{ GL_RGB,       GL_UNSIGNED_BYTE,          3 },
+	{ GL_RGB,       GL_UNSIGNED_SHORT_5_6_5,   2 },
+	{ GL_RGBA,      GL_UNSIGNED_SHORT_4_4_4_4, 2 },
+	{ GL_LUMINANCE, GL_UNSIGNED_BYTE,          1 }
+};
+
+enum {
+	FILTER_NEAREST,
+	FILTER_LINEAR,
+	FILTER_MIPMAP,
+
+	FILTER_COUNT,
+	FILTER_FORCE_UINT = -1U
+};
+
+static const char* const filter_name[FILTER_COUNT] = {
+	"nearest",
+	"linear",
+	"mipmap"
+};
+
+// texels touched per sample by each filter mode
+static const unsigned filter_footprint[FILTER_COUNT] = {
+	1,
+	4,
+	8
+};
+
+enum {
+	PATTERN_COHERENT,
+	PATTERN_ROTATED,
+	PATTERN_DEPENDENT,
+
+	PATTERN_COUNT,
+	PATTERN_FORCE_UINT = -1U
+};
+
+static const char* const pattern_name[PATTERN_COUNT] = {
+	"coherent",
+	"rotated",
+	"dependent"
+};
+
+static const unsigned max_list_len = 16;
+static const unsigned max_units = 8;
+
+struct ParamList {
+	unsigned value[max_list_len];
+	unsigned count;
+};
+
+static ParamList g_size    = { { 64, 256, 1024, 2048 }, 4 };
+static ParamList g_format  = { { FORMAT_RGBA8888, FORMAT_RGB888, FORMAT_RGB565, FORMAT_RGBA4444, FORMAT_L8 }, 5 };
+static ParamList g_filter  = { { FILTER_NEAREST, FILTER_LINEAR, FILTER_MIPMAP }, 3 };
+static ParamList g_pattern = { { PATTERN_COHERENT, PATTERN_ROTATED, PATTERN_DEPENDENT }, 3 };
+static ParamList g_units   = { { 1, 2, 4 }, 3 };
+
+static unsigned g_layers = 4;
+static float g_texel_ratio = 1.f;
+static unsigned g_warmup = 16;
+static unsigned g_frames = 64;
+
+#if PLATFORM_GLX == 0
+static EGLDisplay g_display = EGL_NO_DISPLAY;
+static EGLContext g_context = EGL_NO_CONTEXT;
+
+#endif
+#if PLATFORM_GLES
+#if PLATFORM_GL_OES_vertex_array_object
+static PFNGLBINDVERTEXARRAYOESPROC    glBindVertexArrayOES;
+static PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOES;
+static PFNGLGENVERTEXARRAYSOESPROC    glGenVertexArraysOES;
+static PFNGLISVERTEXARRAYOESPROC      glIsVertexArrayOES;
+
+#endif
+#endif
+// one program per number of units and per dependent/non-dependent access
+enum {
+	PROG_COUNT = max_units * 2,
+	PROG_FORCE_UINT = -1U
+};
+
+enum {
+	UNI_SAMPLER_0,
+	UNI_SAMPLER_1,
+	UNI_SAMPLER_2,
+	UNI_SAMPLER_3,
+	UNI_SAMPLER_4,
+	UNI_SAMPLER_5,
+	UNI_SAMPLER_6,
+	UNI_SAMPLER_7,
+
+	UNI_TC_XFORM,
+	UNI_DEP_SCALE,
+
+	UNI_COUNT,
+	UNI_FORCE_UINT = -1U
+};
+
+enum {
+	VBO_QUAD_VTX,
+
+	VBO_COUNT,
+	VBO_FORCE_UINT = -1U
+};
+
+static GLint g_uni[PROG_COUNT][UNI_COUNT];
+
+#if PLATFORM_GL_OES_vertex_array_object
+static GLuint g_vao[PROG_COUNT];
+
+#endif
+static GLuint g_tex[max_units];
+static GLuint g_vbo[VBO_COUNT];
+static GLuint g_shader_vert[PROG_COUNT];
+static GLuint g_shader_frag[PROG_COUNT];
+static GLuint g_shader_prog[PROG_COUNT];
+
+static rend::ActiveAttrSemantics g_active_attr_semantics[PROG_COUNT];
+
+static GLint g_max_tex_size;
+
+// sweep state
+static unsigned g_config;
+static unsigned g_config_count;
+static bool g_config_ready;
+static double g_baseline_rate;
+
+static util::BenchPhase* g_phase;
+
+struct Config {
+	unsigned size;
+	unsigned format;
+	unsigned filter;
+	unsigned pattern;
+	unsigned units;
+};
+
+static unsigned prog_index(
+	const unsigned units,
+	const unsigned pattern)
+{
+	assert(0 < units && units <= max_units);
+	return (units - 1) * 2 + (PATTERN_DEPENDENT == pattern ? 1 : 0);
+}
+
+// decompose a linear config index; size is the innermost dimension so each group of sizes
+// can be related to its smallest member
+static Config get_config(
+	const unsigned index)
+{
+	unsigned i = index;
+	Config c;
+
+	c.size    = g_size.value[i % g_size.count];       i /= g_size.count;
+	c.format  = g_format.value[i % g_format.count];   i /= g_format.count;
+	c.filter  = g_filter.value[i % g_filter.count];   i /= g_filter.count;
+	c.pattern = g_pattern.value[i % g_pattern.count]; i /= g_pattern.count;
+	c.units   = g_units.value[i % g_units.count];
+
+	return c;
+}
+
+bool set_num_drawcalls(
+	const unsigned)
+{
+	return false;
+}
+
+unsigned get_num_drawcalls()
+{
+	return g_layers;
+}
+
+bool requires_depth()
+{
+	return false;
+}
+
+bool parse_cli(
+    const unsigned argc,
+    const char* const* argv)
+{
+	bool cli_err = false;
+	const unsigned prefix_len = strlen(arg_prefix);
+
+	for (unsigned i = 1; i < argc && !cli_err; ++i) {
+		if (strncmp(argv[i], arg_prefix, prefix_len) ||
+			strcmp(argv[i] + prefix_len, arg_app)) {
+			continue;
+		}
+
+		if (++i < argc) {
+			if (i + 1 < argc && !strcmp(argv[i], arg_size)) {
+				if (0 != (g_size.count = util::parseUintList(argv[i + 1], g_size.value, max_list_len))) {
+					bool pot = true;
+					for (unsigned j = 0; j < g_size.count; ++j)
+						pot = pot && g_size.value[j] && 0 == (g_size.value[j] & (g_size.value[j] - 1));
+
+					if (pot) {
+						std::sort(g_size.value, g_size.value + g_size.count);
+						i += 1;
+						continue;
+					}
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_format)) {
+				if (0 != (g_format.count = util::parseNameList(argv[i + 1],
+						format_name, FORMAT_COUNT, g_format.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_filter)) {
+				if (0 != (g_filter.count = util::parseNameList(argv[i + 1],
+						filter_name, FILTER_COUNT, g_filter.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_pattern)) {
+				if (0 != (g_pattern.count = util::parseNameList(argv[i + 1],
+						pattern_name, PATTERN_COUNT, g_pattern.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_units)) {
+				if (0 != (g_units.count = util::parseUintList(argv[i + 1], g_units.value, max_list_len))) {
+					bool valid = true;
+					for (unsigned j = 0; j < g_units.count; ++j)
+						valid = valid && 0 < g_units.value[j] && g_units.value[j] <= max_units;
+
+					if (valid) {
+						i += 1;
+						continue;
+					}
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_layers)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_layers) && 0 < g_layers) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_texel_ratio)) {
+				if (1 == sscanf(argv[i + 1], "%f", &g_texel_ratio) && 0.f < g_texel_ratio) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_warmup)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_warmup)) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_frames)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_frames) && 0 < g_frames) {
+					i += 1;
+					continue;
+				}
+			}
+		}
+
+		cli_err = true;
+	}
+
+	if (cli_err) {
+		std::cerr << "app options:\n"
+			"\t" << arg_prefix << arg_app << " " << arg_size <<
+			" <n>[,<n>..]\t\t: sweep the specified power-of-two texture sizes\n"
+			"\t" << arg_prefix << arg_app << " " << arg_format <<
+			" <name>[,<name>..]\t: sweep the specified formats: rgba8888, rgb888, rgb565, rgba4444, l8\n"
+			"\t" << arg_prefix << arg_app << " " << arg_filter <<
+			" <name>[,<name>..]\t: sweep the specified filters: nearest, linear, mipmap\n"
+			"\t" << arg_prefix << arg_app << " " << arg_pattern <<
+			" <name>[,<name>..]\t: sweep the specified access patterns: coherent, rotated, dependent\n"
+			"\t" << arg_prefix << arg_app << " " << arg_units <<
+			" <n>[,<n>..]\t\t: sweep the specified numbers of texture units, 1 - " << max_units << "\n"
+			"\t" << arg_prefix << arg_app << " " << arg_layers <<
+			" <n>\t\t\t: draw the specified number of fullscreen quads per frame\n"
+			"\t" << arg_prefix << arg_app << " " << arg_texel_ratio <<
+			" <ratio>\t\t: sample the specified number of texels per pixel along each axis\n"
+			"\t" << arg_prefix << arg_app << " " << arg_warmup <<
+			" <n>\t\t\t: use the specified number of warmup frames per configuration\n"
+			"\t" << arg_prefix << arg_app << " " << arg_frames <<
+			" <n>\t\t\t: use the specified number of measured frames per configuration\n" << std::endl;
+	}
+
+	return !cli_err;
+}
+
+static uint32_t xorshift32(
+	uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+// (re)create the textures of all units used by the given config, filled with noise so that
+// dependent reads scatter and no texture compression or constant-color fast path can kick in
+static bool setupTextures(
+	const Config& c)
+{
+	const size_t bytes = size_t(c.size) * c.size * format_desc[c.format].bytes;
+	scoped_ptr< uint8_t, util::generic_delete_arr > noise(new uint8_t[bytes]);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (unsigned i = 0; i < c.units; ++i) {
+		uint32_t seed = 0x9e3779b9U * (i + 1);
+
+		for (size_t j = 0; j < bytes; ++j)
+			noise()[j] = uint8_t(xorshift32(seed) >> 24);
+
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, g_tex[i]);
+
+		switch (c.filter) {
+		case FILTER_NEAREST:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+			break;
+		case FILTER_LINEAR:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			break;
+		case FILTER_MIPMAP:
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+			break;
+		}
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, format_desc[c.format].format, c.size, c.size, 0,
+			format_desc[c.format].format, format_desc[c.format].type, noise());
+
+		if (FILTER_MIPMAP == c.filter)
+			glGenerateMipmap(GL_TEXTURE_2D);
+	}
+
+	glActiveTexture(GL_TEXTURE0);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	return !util::reportGLError();
+}
+
+static bool setupQuad(
+	const GLuint vbo_arr)
+{
+	assert(vbo_arr);
+
+	static const Vertex arr[] = {
+		{ { -1.f, -1.f } },
+		{ {  1.f, -1.f } },
+		{ { -1.f,  1.f } },
+		{ {  1.f,  1.f } }
+	};
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_arr);
+	glBufferData(GL_ARRAY_BUFFER, sizeof(arr), arr, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+	if (util::reportGLError()) {
+		std::cerr << __FUNCTION__ <<
+			" failed at glBindBuffer/glBufferData for ARRAY_BUFFER" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool check_context(
+	const char* prefix)
+{
+	bool context_correct = true;
+
+#if PLATFORM_GLX == 0
+	if (g_display != eglGetCurrentDisplay()) {
+		std::cerr << prefix << " encountered foreign display" << std::endl;
+		context_correct = false;
+	}
+
+	if (g_context != eglGetCurrentContext()) {
+		std::cerr << prefix << " encountered foreign context" << std::endl;
+		context_correct = false;
+	}
+
+#endif
+	return context_correct;
+}
+
+bool deinit_resources()
+{
+	if (!check_context(__FUNCTION__))
+		return false;
+
+	for (unsigned i = 0; i < sizeof(g_shader_prog) / sizeof(g_shader_prog[0]); ++i)
+	{
+		glDeleteProgram(g_shader_prog[i]);
+		g_shader_prog[i] = 0;
+	}
+
+	for (unsigned i = 0; i < sizeof(g_shader_vert) / sizeof(g_shader_vert[0]); ++i)
+	{
+		glDeleteShader(g_shader_vert[i]);
+		g_shader_vert[i] = 0;
+	}
+
+	for (unsigned i = 0; i < sizeof(g_shader_frag) / sizeof(g_shader_frag[0]); ++i)
+	{
+		glDeleteShader(g_shader_frag[i]);
+		g_shader_frag[i] = 0;
+	}
+
+	glDeleteTextures(sizeof(g_tex) / sizeof(g_tex[0]), g_tex);
+	memset(g_tex, 0, sizeof(g_tex));
+
+#if PLATFORM_GL_OES_vertex_array_object
+	glDeleteVertexArraysOES(sizeof(g_vao) / sizeof(g_vao[0]), g_vao);
+	memset(g_vao, 0, sizeof(g_vao));
+
+#endif
+	glDeleteBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+	memset(g_vbo, 0, sizeof(g_vbo));
+
+	delete g_phase;
+	g_phase = 0;
+
+#if PLATFORM_GLX == 0
+	g_display = EGL_NO_DISPLAY;
+	g_context = EGL_NO_CONTEXT;
+
+#endif
+	return true;
+}
+
+static bool addProgramVariant(
+	util::ProgramBatch& batch,
+	const unsigned prog,
+	const unsigned units,
+	const bool dependent)
+{
+	std::ostringstream defines;
+	defines <<
+		"#define TEX_UNITS " << units << "\n"
+		"#define DEPENDENT " << (dependent ? 1 : 0) << "\n";
+
+	g_shader_vert[prog] = glCreateShader(GL_VERTEX_SHADER);
+	assert(g_shader_vert[prog]);
+
+	g_shader_frag[prog] = glCreateShader(GL_FRAGMENT_SHADER);
+	assert(g_shader_frag[prog]);
+
+	g_shader_prog[prog] = glCreateProgram();
+	assert(g_shader_prog[prog]);
+
+	if (!batch.add(
+			g_shader_prog[prog],
+			g_shader_vert[prog],
+			g_shader_frag[prog],
+			"texture_bw.glslv",
+			"texture_bw.glslf",
+			defines.str()))
+	{
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch::add" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+static bool setupProgramVariantBindings(
+	const unsigned prog)
+{
+	static const char* const sampler_name[max_units] = {
+		"tex0", "tex1", "tex2", "tex3", "tex4", "tex5", "tex6", "tex7"
+	};
+
+	for (unsigned i = 0; i < max_units; ++i)
+		g_uni[prog][UNI_SAMPLER_0 + i] = glGetUniformLocation(g_shader_prog[prog], sampler_name[i]);
+
+	g_uni[prog][UNI_TC_XFORM]  = glGetUniformLocation(g_shader_prog[prog], "tc_xform");
+	g_uni[prog][UNI_DEP_SCALE] = glGetUniformLocation(g_shader_prog[prog], "dep_scale");
+
+	// sampler bindings never change - set them once
+	glUseProgram(g_shader_prog[prog]);
+
+	for (unsigned i = 0; i < max_units; ++i)
+		if (-1 != g_uni[prog][UNI_SAMPLER_0 + i])
+			glUniform1i(g_uni[prog][UNI_SAMPLER_0 + i], i);
+
+	glUseProgram(0);
+
+	g_active_attr_semantics[prog].registerVertexAttr(
+		glGetAttribLocation(g_shader_prog[prog], "at_Vertex"));
+
+	if (!rend::validateVertexLayout< Vertex >(g_shader_prog[prog], g_active_attr_semantics[prog])) {
+		std::cerr << __FUNCTION__ << " failed at rend::validateVertexLayout" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool init_resources()
+{
+#if PLATFORM_GLES
+#if PLATFORM_GL_OES_vertex_array_object
+	glBindVertexArrayOES    = (PFNGLBINDVERTEXARRAYOESPROC)    eglGetProcAddress("glBindVertexArrayOES");
+	glDeleteVertexArraysOES = (PFNGLDELETEVERTEXARRAYSOESPROC) eglGetProcAddress("glDeleteVertexArraysOES");
+	glGenVertexArraysOES    = (PFNGLGENVERTEXARRAYSOESPROC)    eglGetProcAddress("glGenVertexArraysOES");
+	glIsVertexArrayOES      = (PFNGLISVERTEXARRAYOESPROC)      eglGetProcAddress("glIsVertexArrayOES");
+
+#endif
+#endif
+#if PLATFORM_GLX == 0
+	g_display = eglGetCurrentDisplay();
+
+	if (EGL_NO_DISPLAY == g_display) {
+		std::cerr << __FUNCTION__ << " encountered nil display" << std::endl;
+		return false;
+	}
+
+	g_context = eglGetCurrentContext();
+
+	if (EGL_NO_CONTEXT == g_context) {
+		std::cerr << __FUNCTION__ << " encountered nil context" << std::endl;
+		return false;
+	}
+
+#endif
+	scoped_ptr< deinit_resources_t, scoped_functor > on_error(deinit_resources);
+
+	/////////////////////////////////////////////////////////////////
+
+	GLint max_units_available = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &max_units_available);
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &g_max_tex_size);
+
+	for (unsigned i = 0; i < g_units.count; ++i)
+		if (GLint(g_units.value[i]) > max_units_available) {
+			std::cerr << __FUNCTION__ << " requested " << g_units.value[i] <<
+				" texture units; device supports " << max_units_available << std::endl;
+			return false;
+		}
+
+	glDisable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	/////////////////////////////////////////////////////////////////
+
+	glGenTextures(sizeof(g_tex) / sizeof(g_tex[0]), g_tex);
+
+	for (unsigned i = 0; i < sizeof(g_tex) / sizeof(g_tex[0]); ++i)
+		assert(g_tex[i]);
+
+	/////////////////////////////////////////////////////////////////
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		for (unsigned j = 0; j < UNI_COUNT; ++j)
+			g_uni[i][j] = -1;
+
+	// build only the program variants the sweep will use, all in one batch, so the driver can compile
+	// them concurrently
+	util::ProgramBatch batch;
+
+	for (unsigned i = 0; i < g_units.count; ++i)
+		for (unsigned j = 0; j < g_pattern.count; ++j) {
+			const unsigned prog = prog_index(g_units.value[i], g_pattern.value[j]);
+
+			if (0 != g_shader_prog[prog])
+				continue;
+
+			if (!addProgramVariant(batch, prog, g_units.value[i], PATTERN_DEPENDENT == g_pattern.value[j])) {
+				std::cerr << __FUNCTION__ << " failed at addProgramVariant" << std::endl;
+				return false;
+			}
+		}
+
+	if (!batch.submit() || !batch.finish()) {
+		std::cerr << __FUNCTION__ << " failed at ProgramBatch" << std::endl;
+		return false;
+	}
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		if (0 != g_shader_prog[i] && !setupProgramVariantBindings(i))
+			return false;
+
+	/////////////////////////////////////////////////////////////////
+
+#if PLATFORM_GL_OES_vertex_array_object
+	glGenVertexArraysOES(sizeof(g_vao) / sizeof(g_vao[0]), g_vao);
+
+	for (unsigned i = 0; i < sizeof(g_vao) / sizeof(g_vao[0]); ++i)
+		assert(g_vao[i]);
+
+#endif
+	glGenBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+
+	for (unsigned i = 0; i < sizeof(g_vbo) / sizeof(g_vbo[0]); ++i)
+		assert(g_vbo[i]);
+
+	if (!setupQuad(g_vbo[VBO_QUAD_VTX])) {
+		std::cerr << __FUNCTION__ << " failed at setupQuad" << std::endl;
+		return false;
+	}
+
+#if PLATFORM_GL_OES_vertex_array_object
+	for (unsigned i = 0; i < PROG_COUNT; ++i) {
+		if (0 == g_shader_prog[i])
+			continue;
+
+		glBindVertexArrayOES(g_vao[i]);
+		glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_QUAD_VTX]);
+
+		if (!rend::setupVertexAttrPointers< Vertex >(g_active_attr_semantics[i])) {
+			std::cerr << __FUNCTION__ <<
+				" failed at rend::setupVertexAttrPointers" << std::endl;
+			return false;
+		}
+
+		for (unsigned j = 0; j < g_active_attr_semantics[i].num_active_attr; ++j)
+			glEnableVertexAttribArray(g_active_attr_semantics[i].active_attr[j]);
+	}
+
+	glBindVertexArrayOES(0);
+
+#endif
+	/////////////////////////////////////////////////////////////////
+
+	g_phase = new util::BenchPhase(g_warmup, g_frames);
+
+	g_config = 0;
+	g_config_count = g_size.count * g_format.count * g_filter.count * g_pattern.count * g_units.count;
+	g_config_ready = false;
+
+	std::cout << scene_name << ": " << g_config_count << " configurations, " <<
+		g_warmup << " warmup + " << g_frames << " measured frames each" << std::endl;
+
+	on_error.reset();
+	return true;
+}
+
+static void report_config(
+	const Config& c,
+	const GLint (& vp)[4])
+{
+	util::BenchStats stats;
+
+	if (!g_phase->getStats(stats))
+		return;
+
+	const bool dependent = PATTERN_DEPENDENT == c.pattern;
+	const double pixels = double(vp[2]) * vp[3] * g_layers;
+	const double samples = pixels * (c.units + (dependent ? 1 : 0));
+	const double samples_per_s = samples / (stats.median * 1e-3);
+	const double texels_per_s = samples_per_s * filter_footprint[c.filter];
+	const double level0_bytes = double(c.size) * c.size * format_desc[c.format].bytes;
+	const double footprint = level0_bytes * (FILTER_MIPMAP == c.filter ? 4.0 / 3.0 : 1.0) * c.units;
+
+	// sizes are swept innermost and ascending - the smallest one of each group is the baseline
+	if (c.size == g_size.value[0] || 0.0 == g_baseline_rate)
+		g_baseline_rate = samples_per_s;
+
+	util::BenchRecord()
+		.param("size", c.size)
+		.param("format", format_name[c.format])
+		.param("filter", filter_name[c.filter])
+		.param("pattern", pattern_name[c.pattern])
+		.param("units", c.units)
+		.param("layers", g_layers)
+		.param("texel_ratio", g_texel_ratio)
+		.param("width", vp[2])
+		.param("height", vp[3])
+		.metric("frame_ms", stats)
+		.metric("samples_per_s", samples_per_s)
+		.metric("texels_per_s", texels_per_s)
+		.metric("texel_bytes_per_s", texels_per_s * format_desc[c.format].bytes)
+		.metric("footprint_bytes", footprint)
+		.metric("rate_vs_smallest", samples_per_s / g_baseline_rate)
+		.emit(scene_name);
+}
+
+bool render_frame()
+{
+	if (!check_context(__FUNCTION__))
+		return false;
+
+	if (g_config == g_config_count)
+		return false;
+
+	const Config c = get_config(g_config);
+	const unsigned prog = prog_index(c.units, c.pattern);
+
+	if (GLint(c.size) > g_max_tex_size) {
+		std::cout << scene_name << ": skipping size " << c.size <<
+			" above GL_MAX_TEXTURE_SIZE " << g_max_tex_size << std::endl;
+		++g_config;
+		return true;
+	}
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+
+	if (!g_config_ready) {
+		if (!setupTextures(c)) {
+			std::cerr << __FUNCTION__ << " failed at setupTextures" << std::endl;
+			return false;
+		}
+
+		g_phase->reset();
+		g_config_ready = true;
+	}
+
+	/////////////////////////////////////////////////////////////////
+
+	const float sx = vp[2] * g_texel_ratio / c.size;
+	const float sy = vp[3] * g_texel_ratio / c.size;
+
+	// column-major; rotated access walks texture rows along screen columns
+	const GLfloat tc_xform[2][2][2] = {
+		{ { sx,  0.f }, { 0.f, sy  } },
+		{ { 0.f, sx  }, { sy,  0.f } }
+	};
+
+	glUseProgram(g_shader_prog[prog]);
+
+	DEBUG_GL_ERR()
+
+	if (-1 != g_uni[prog][UNI_TC_XFORM])
+		glUniformMatrix2fv(g_uni[prog][UNI_TC_XFORM], 1, GL_FALSE,
+			reinterpret_cast< const GLfloat* >(tc_xform[PATTERN_ROTATED == c.pattern ? 1 : 0]));
+
+	if (-1 != g_uni[prog][UNI_DEP_SCALE])
+		glUniform1f(g_uni[prog][UNI_DEP_SCALE], 1.f);
+
+	DEBUG_GL_ERR()
+
+	for (unsigned i = 0; i < c.units; ++i) {
+		glActiveTexture(GL_TEXTURE0 + i);
+		glBindTexture(GL_TEXTURE_2D, g_tex[i]);
+	}
+
+	DEBUG_GL_ERR()
+
+#if PLATFORM_GL_OES_vertex_array_object
+	glBindVertexArrayOES(g_vao[prog]);
+
+#else
+	glBindBuffer(GL_ARRAY_BUFFER, g_vbo[VBO_QUAD_VTX]);
+
+	if (!rend::setupVertexAttrPointers< Vertex >(g_active_attr_semantics[prog]))
+		return false;
+
+	for (unsigned i = 0; i < g_active_attr_semantics[prog].num_active_attr; ++i)
+		glEnableVertexAttribArray(g_active_attr_semantics[prog].active_attr[i]);
+
+#endif
+	DEBUG_GL_ERR()
+
+	// drain any outstanding work so that only this frame's draws get timed
+	glFinish();
+	const uint64_t t0 = util::time_ns();
+
+	for (unsigned i = 0; i < g_layers; ++i)
+		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+
+	glFinish();
+	const uint64_t t1 = util::time_ns();
+
+	DEBUG_GL_ERR()
+
+#if PLATFORM_GL_OES_vertex_array_object == 0
+	for (unsigned i = 0; i < g_active_attr_semantics[prog].num_active_attr; ++i)
+		glDisableVertexAttribArray(g_active_attr_semantics[prog].active_attr[i]);
+
+#endif
+	if (g_phase->addFrame(t1 - t0)) {
+		report_config(c, vp);
+
+		++g_config;
+		g_config_ready = false;
+	}
+
+	return true;
+}
+
+} // namespace hook
@@ -0,0 +1,807 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+#include "scoped.hpp"
+#include "util_misc.hpp"
+#include "util_mesh.hpp"
+#include "util_bench.hpp"
+#include "util_progcache.hpp"
+#include "pure_macro.hpp"
+
+#include "rendVertAttr.hpp"
+#include "rendVertLayout.hpp"
+
+using util::scoped_ptr;
+using util::scoped_functor;
+using util::deinit_resources_t;
+
+namespace {
+
+struct Vertex {
+	GLfloat pos[3];
+	GLfloat nrm[3];
+	GLfloat txc[2];
+};
+
+struct PackedVertex {
+	GLshort pos[4];  // snorm16, w unused
+	GLbyte nrm[4];   // snorm8, w unused
+	GLushort txc[2]; // unorm16
+};
+
+} // namespace
+
+template <>
+const rend::VertAttrFormat rend::VertexLayout< Vertex >::attr[] = {
+	REND_VERT_ATTR(Vertex, pos, vertex, GL_FALSE, 0),
+	REND_VERT_ATTR(Vertex, nrm, normal, GL_FALSE, 0),
+	REND_VERT_ATTR(Vertex, txc, tcoord, GL_FALSE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< Vertex >::count = REND_VERT_LAYOUT_COUNT(Vertex);
+
+template <>
+const rend::VertAttrFormat rend::VertexLayout< PackedVertex >::attr[] = {
+	REND_VERT_ATTR(PackedVertex, pos, vertex, GL_TRUE, 3),
+	REND_VERT_ATTR(PackedVertex, nrm, normal, GL_TRUE, 3),
+	REND_VERT_ATTR(PackedVertex, txc, tcoord, GL_TRUE, 0)
+};
+
+template <>
+const unsigned rend::VertexLayout< PackedVertex >::count = REND_VERT_LAYOUT_COUNT(PackedVertex);
+
+namespace hook {
+
+static const char* arg_prefix    = "-";
+static const char* arg_app       = "app";
+
+static const char* arg_rows      = "rows";
+static const char* arg_format    = "format";
+static const char* arg_index     = "index";
+static const char* arg_order     = "order";
+static const char* arg_draws     = "draws";
+static const char* arg_radius_px = "radius_px";
+static const char* arg_warmup    = "warmup";
+static const char* arg_frames    = "frames";
+
+static const char scene_name[] = "vertex_tput";
+
+enum {
+	FORMAT_FLOAT,
+	FORMAT_PACKED,
+
+	FORMAT_COUNT,
+	FORMAT_FORCE_UINT = -1U
+};
+
+static const char* const format_name[FORMAT_COUNT] = {
+	"float",
+	"packed"
+};
+
+static const unsigned format_stride[FORMAT_COUNT] = {
+	sizeof(Vertex),
+	sizeof(PackedVertex)
+};
+
+enum {
+	INDEX_USHORT,
+	INDEX_UINT,
+
+	INDEX_COUNT,
+	INDEX_FORCE_UINT = -1U
+};
+
+static const char* const index_name[INDEX_COUNT] = {
+	"ushort",
+	"uint"
+};
+
+enum {
+	ORDER_NATIVE,
+	ORDER_RANDOM,
+	ORDER_OPTIMIZED,
+
+	ORDER_COUNT,
+	ORDER_FORCE_UINT = -1U
+};
+
+static const char* const order_name[ORDER_COUNT] = {
+	"native",
+	"random",
+	"optimized"
+};
+
+static const unsigned max_list_len = 16;
+
+struct ParamList {
+	unsigned value[max_list_len];
+	unsigned count;
+};
+
+static ParamList g_rows   = { { 17, 33, 65, 129, 257 }, 5 };
+static ParamList g_format = { { FORMAT_FLOAT, FORMAT_PACKED }, 2 };
+static ParamList g_index  = { { INDEX_USHORT, INDEX_UINT }, 2 };
+static ParamList g_order  = { { ORDER_NATIVE, ORDER_RANDOM, ORDER_OPTIMIZED }, 3 };
+
+static unsigned g_draws = 16;
+static float g_radius_px = 2.f;
+static unsigned g_warmup = 8;
+static unsigned g_frames = 32;
+
+#if PLATFORM_GLX == 0
+static EGLDisplay g_display = EGL_NO_DISPLAY;
+static EGLContext g_context = EGL_NO_CONTEXT;
+
+#endif
+enum {
+	PROG_MESH,
+
+	PROG_COUNT,
+	PROG_FORCE_UINT = -1U
+};
+
+enum {
+	UNI_MVP,
+
+	UNI_COUNT,
+	UNI_FORCE_UINT = -1U
+};
+
+enum {
+	VBO_MESH_VTX,
+	VBO_MESH_IDX,
+
+	VBO_COUNT,
+	VBO_FORCE_UINT = -1U
+};
+
+static GLint g_uni[PROG_COUNT][UNI_COUNT];
+
+static GLuint g_vbo[VBO_COUNT];
+static GLuint g_shader_vert[PROG_COUNT];
+static GLuint g_shader_frag[PROG_COUNT];
+static GLuint g_shader_prog[PROG_COUNT];
+
+static rend::ActiveAttrSemantics g_active_attr_semantics[PROG_COUNT];
+
+static bool g_index_uint_supported;
+
+// current mesh
+static size_t g_num_verts;
+static size_t g_num_tris;
+static double g_acmr_16;
+static double g_acmr_32;
+
+// sweep state
+static unsigned g_config;
+static unsigned g_config_count;
+static bool g_config_ready;
+
+static util::BenchPhase* g_phase;
+
+struct Config {
+	unsigned rows;
+	unsigned format;
+	unsigned index;
+	unsigned order;
+};
+
+static Config get_config(
+	const unsigned index)
+{
+	unsigned i = index;
+	Config c;
+
+	c.rows   = g_rows.value[i % g_rows.count];     i /= g_rows.count;
+	c.order  = g_order.value[i % g_order.count];   i /= g_order.count;
+	c.index  = g_index.value[i % g_index.count];   i /= g_index.count;
+	c.format = g_format.value[i % g_format.count];
+
+	return c;
+}
+
+bool set_num_drawcalls(
+	const unsigned n)
+{
+	if (0 == n)
+		return false;
+
+	g_draws = n;
+	return true;
+}
+
+unsigned get_num_drawcalls()
+{
+	return g_draws;
+}
+
+bool requires_depth()
+{
+	return false;
+}
+
+bool parse_cli(
+    const unsigned argc,
+    const char* const* argv)
+{
+	bool cli_err = false;
+	const unsigned prefix_len = strlen(arg_prefix);
+
+	for (unsigned i = 1; i < argc && !cli_err; ++i) {
+		if (strncmp(argv[i], arg_prefix, prefix_len) ||
+			strcmp(argv[i] + prefix_len, arg_app)) {
+			continue;
+		}
+
+		if (++i < argc) {
+			if (i + 1 < argc && !strcmp(argv[i], arg_rows)) {
+				if (0 != (g_rows.count = util::parseUintList(argv[i + 1], g_rows.value, max_list_len)) &&
+					2 < *std::min_element(g_rows.value, g_rows.value + g_rows.count)) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_format)) {
+				if (0 != (g_format.count = util::parseNameList(argv[i + 1],
+						format_name, FORMAT_COUNT, g_format.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_index)) {
+				if (0 != (g_index.count = util::parseNameList(argv[i + 1],
+						index_name, INDEX_COUNT, g_index.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_order)) {
+				if (0 != (g_order.count = util::parseNameList(argv[i + 1],
+						order_name, ORDER_COUNT, g_order.value, max_list_len))) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_draws)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_draws) && 0 < g_draws) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_radius_px)) {
+				if (1 == sscanf(argv[i + 1], "%f", &g_radius_px) && 0.f < g_radius_px) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_warmup)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_warmup)) {
+					i += 1;
+					continue;
+				}
+			}
+			else
+			if (i + 1 < argc && !strcmp(argv[i], arg_frames)) {
+				if (1 == sscanf(argv[i + 1], "%u", &g_frames) && 0 < g_frames) {
+					i += 1;
+					continue;
+				}
+			}
+		}
+
+		cli_err = true;
+	}
+
+	if (cli_err) {
+		std::cerr << "app options:\n"
+			"\t" << arg_prefix << arg_app << " " << arg_rows <<
+			" <n>[,<n>..]\t\t: sweep polar spheres of the specified rows, at 2 * rows - 1 columns\n"
+			"\t" << arg_prefix << arg_app << " " << arg_format <<
+			" <name>[,<name>..]\t: sweep the specified vertex formats: float, packed\n"
+			"\t" << arg_prefix << arg_app << " " << arg_index <<
+			" <name>[,<name>..]\t: sweep the specified index types: ushort, uint\n"
+			"\t" << arg_prefix << arg_app << " " << arg_order <<
+			" <name>[,<name>..]\t: sweep the specified triangle orders: native, random, optimized\n"
+			"\t" << arg_prefix << arg_app << " " << arg_draws <<
+			" <n>\t\t\t: draw the mesh the specified number of times per frame\n"
+			"\t" << arg_prefix << arg_app << " " << arg_radius_px <<
+			" <r>\t\t\t: use the specified on-screen mesh radius, in pixels\n"
+			"\t" << arg_prefix << arg_app << " " << arg_warmup <<
+			" <n>\t\t\t: use the specified number of warmup frames per configuration\n"
+			"\t" << arg_prefix << arg_app << " " << arg_frames <<
+			" <n>\t\t\t: use the specified number of measured frames per configuration\n" << std::endl;
+	}
+
+	return !cli_err;
+}
+
+template < typename T >
+class generic_free
+{
+public:
+	void operator()(T* arg)
+	{
+		free(arg);
+	}
+};
+
+static GLshort snorm16(
+	const float f)
+{
+	return GLshort(floorf(std::min(std::max(f, -1.f), 1.f) * 32767.f + .5f));
+}
+
+static GLbyte snorm8(
+	const float f)
+{
+	return GLbyte(floorf(std::min(std::max(f, -1.f), 1.f) * 127.f + .5f));
+}
+
+static GLushort unorm16(
+	const float f)
+{
+	return GLushort(floorf(std::min(std::max(f, 0.f), 1.f) * 65535.f + .5f));
+}
+
+// build a polar sphere in the given triangle order, vertex format and index type, and upload it
+static bool createMesh(
+	const Config& c,
+	const GLuint vbo_arr,
+	const GLuint vbo_idx)
+{
+	assert(vbo_arr && vbo_idx);
+
+	const int rows = c.rows;
+	const int cols = 2 * c.rows - 1;
+	const size_t num_verts = util::polarSphereNumVerts(rows, cols);
+	const size_t num_tris = util::polarSphereNumTris(rows, cols);
+
+	scoped_ptr< Vertex, generic_free > arr(
+		reinterpret_cast< Vertex* >(malloc(sizeof(Vertex) * num_verts)));
+	scoped_ptr< uint32_t[3], generic_free > idx(
+		reinterpret_cast< uint32_t(*)[3] >(malloc(sizeof(uint32_t[3]) * num_tris)));
+
+	if (0 == arr() || 0 == idx()) {
+		std::cerr << __FUNCTION__ << " failed to allocate mesh" << std::endl;
+		return false;
+	}
+
+	util::fillPolarSphereVerts(arr(), rows, cols, 1.f, 1.f);
+	util::fillPolarSphereIndices(idx(), rows, cols);
+
+	switch (c.order) {
+	case ORDER_RANDOM:
+		util::shuffleTriangles(idx(), num_tris, 0x2545f491U);
+		break;
+
+	case ORDER_OPTIMIZED:
+		if (!util::optimizeVertexCache(idx(), num_tris, num_verts)) {
+			std::cerr << __FUNCTION__ << " failed at optimizeVertexCache" << std::endl;
+			return false;
+		}
+		{
+			// follow up with vertex fetch locality
+			scoped_ptr< uint32_t, generic_free > remap(
+				reinterpret_cast< uint32_t* >(malloc(sizeof(uint32_t) * num_verts)));
+			scoped_ptr< Vertex, generic_free > reordered(
+				reinterpret_cast< Vertex* >(malloc(sizeof(Vertex) * num_verts)));
+
+			if (0 == remap() || 0 == reordered()) {
+				std::cerr << __FUNCTION__ << " failed to allocate mesh" << std::endl;
+				return false;
+			}
+
+			util::reorderVertsByFirstUse(idx(), num_tris, num_verts, remap());
+
+			// every vertex of the sphere is referenced, so the remap is a permutation
+			for (size_t i = 0; i < num_verts; ++i) {
+				assert(remap()[i] < num_verts);
+				reordered()[remap()[i]] = arr()[i];
+			}
+
+			arr.set(reordered());
+			reordered.reset();
+		}
+		break;
+	}
+
+	g_acmr_16 = util::computeACMR(idx(), num_tris, 16);
+	g_acmr_32 = util::computeACMR(idx(), num_tris, 32);
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_arr);
+
+	if (FORMAT_PACKED == c.format) {
+		scoped_ptr< PackedVertex, generic_free > packed(
+			reinterpret_cast< PackedVertex* >(malloc(sizeof(PackedVertex) * num_verts)));
+
+		if (0 == packed()) {
+			std::cerr << __FUNCTION__ << " failed to allocate mesh" << std::endl;
+			return false;
+		}
+
+		for (size_t i = 0; i < num_verts; ++i) {
+			for (unsigned j = 0; j < 3; ++j) {
+				packed()[i].pos[j] = snorm16(arr()[i].pos[j]);
+				packed()[i].nrm[j] = snorm8(arr()[i].nrm[j]);
+			}
+			packed()[i].pos[3] = 0;
+			packed()[i].nrm[3] = 0;
+			packed()[i].txc[0] = unorm16(arr()[i].txc[0]);
+			packed()[i].txc[1] = unorm16(arr()[i].txc[1]);
+		}
+
+		glBufferData(GL_ARRAY_BUFFER, sizeof(PackedVertex) * num_verts, packed(), GL_STATIC_DRAW);
+	}
+	else
+		glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * num_verts, arr(), GL_STATIC_DRAW);
+
+	if (util::reportGLError()) {
+		std::cerr << __FUNCTION__ <<
+			" failed at glBindBuffer/glBufferData for ARRAY_BUFFER" << std::endl;
+		return false;
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_idx);
+
+	if (INDEX_USHORT == c.index) {
+		scoped_ptr< GLushort[3], generic_free > idx16(
+			reinterpret_cast< GLushort(*)[3] >(malloc(sizeof(GLushort[3]) * num_tris)));
+
+		if (0 == idx16()) {
+			std::cerr << __FUNCTION__ << " failed to allocate mesh" << std::endl;
+			return false;
+		}
+
+		for (size_t i = 0; i < num_tris; ++i)
+			for (unsigned j = 0; j < 3; ++j)
+				idx16()[i][j] = GLushort(idx()[i][j]);
+
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(GLushort[3]) * num_tris, idx16(), GL_STATIC_DRAW);
+	}
+	else
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(uint32_t[3]) * num_tris, idx(), GL_STATIC_DRAW);
+
+	if (util::reportGLError()) {
+		std::cerr << __FUNCTION__ <<
+			" failed at glBindBuffer/glBufferData for ELEMENT_ARRAY_BUFFER" << std::endl;
+		return false;
+	}
+
+	g_num_verts = num_verts;
+	g_num_tris = num_tris;
+
+	return true;
+}
+
+static bool check_context(
+	const char* prefix)
+{
+	bool context_correct = true;
+
+#if PLATFORM_GLX == 0
+	if (g_display != eglGetCurrentDisplay()) {
+		std::cerr << prefix << " encountered foreign display" << std::endl;
+		context_correct = false;
+	}
+
+	if (g_context != eglGetCurrentContext()) {
+		std::cerr << prefix << " encountered foreign context" << std::endl;
+		context_correct = false;
+	}
+
+#endif
+	return context_correct;
+}
+
+bool deinit_resources()
+{
+	if (!check_context(__FUNCTION__))
+		return false;
+
+	for (unsigned i = 0; i < sizeof(g_shader_prog) / sizeof(g_shader_prog[0]); ++i)
+	{
+		glDeleteProgram(g_shader_prog[i]);
+		g_shader_prog[i] = 0;
+	}
+
+	for (unsigned i = 0; i < sizeof(g_shader_vert) / sizeof(g_shader_vert[0]); ++i)
+	{
+		glDeleteShader(g_shader_vert[i]);
+		g_shader_vert[i] = 0;
+	}
+
+	for (unsigned i = 0; i < sizeof(g_shader_frag) / sizeof(g_shader_frag[0]); ++i)
+	{
+		glDeleteShader(g_shader_frag[i]);
+		g_shader_frag[i] = 0;
+	}
+
+	glDeleteBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+	memset(g_vbo, 0, sizeof(g_vbo));
+
+	delete g_phase;
+	g_phase = 0;
+
+#if PLATFORM_GLX == 0
+	g_display = EGL_NO_DISPLAY;
+	g_context = EGL_NO_CONTEXT;
+
+#endif
+	return true;
+}
+
+bool init_resources()
+{
+#if PLATFORM_GLX == 0
+	g_display = eglGetCurrentDisplay();
+
+	if (EGL_NO_DISPLAY == g_display) {
+		std::cerr << __FUNCTION__ << " encountered nil display" << std::endl;
+		return false;
+	}
+
+	g_context = eglGetCurrentContext();
+
+	if (EGL_NO_CONTEXT == g_context) {
+		std::cerr << __FUNCTION__ << " encountered nil context" << std::endl;
+		return false;
+	}
+
+#endif
+	scoped_ptr< deinit_resources_t, scoped_functor > on_error(deinit_resources);
+
+	/////////////////////////////////////////////////////////////////
+
+#if PLATFORM_GLES
+	const char* const extensions = reinterpret_cast< const char* >(glGetString(GL_EXTENSIONS));
+	g_index_uint_supported = 0 != extensions && 0 != strstr(extensions, "GL_OES_element_index_uint");
+
+#else
+	g_index_uint_supported = true;
+
+#endif
+	glEnable(GL_CULL_FACE);
+	glDisable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+
+	const GLclampf red = 0.f;
+	const GLclampf green = 0.f;
+	const GLclampf blue = 0.f;
+	const GLclampf alpha = 1.f;
+
+	glClearColor(
+		red,
+		green,
+		blue,
+		alpha);
+
+	/////////////////////////////////////////////////////////////////
+
+	for (unsigned i = 0; i < PROG_COUNT; ++i)
+		for (unsigned j = 0; j < UNI_COUNT; ++j)
+			g_uni[i][j] = -1;
+
+	/////////////////////////////////////////////////////////////////
+
+	g_shader_vert[PROG_MESH] = glCreateShader(GL_VERTEX_SHADER);
+	assert(g_shader_vert[PROG_MESH]);
+
+	g_shader_frag[PROG_MESH] = glCreateShader(GL_FRAGMENT_SHADER);
+	assert(g_shader_frag[PROG_MESH]);
+
+	g_shader_prog[PROG_MESH] = glCreateProgram();
+	assert(g_shader_prog[PROG_MESH]);
+
+	if (!util::setupProgramCached(
+			g_shader_prog[PROG_MESH],
+			g_shader_vert[PROG_MESH],
+			g_shader_frag[PROG_MESH],
+			"vertex_tput.glslv",
+			"vertex_tput.glslf"))
+	{
+		std::cerr << __FUNCTION__ << " failed at setupProgramCached" << std::endl;
+		return false;
+	}
+
+	g_uni[PROG_MESH][UNI_MVP] = glGetUniformLocation(g_shader_prog[PROG_MESH], "mvp");
+
+	g_active_attr_semantics[PROG_MESH].registerVertexAttr(
+		glGetAttribLocation(g_shader_prog[PROG_MESH], "at_Vertex"));
+	g_active_attr_semantics[PROG_MESH].registerNormalAttr(
+		glGetAttribLocation(g_shader_prog[PROG_MESH], "at_Normal"));
+	g_active_attr_semantics[PROG_MESH].registerTCoordAttr(
+		glGetAttribLocation(g_shader_prog[PROG_MESH], "at_MultiTexCoord0"));
+
+	// both formats feed the same program
+	if (!rend::validateVertexLayout< Vertex >(g_shader_prog[PROG_MESH], g_active_attr_semantics[PROG_MESH]) ||
+		!rend::validateVertexLayout< PackedVertex >(g_shader_prog[PROG_MESH], g_active_attr_semantics[PROG_MESH])) {
+
+		std::cerr << __FUNCTION__ << " failed at rend::validateVertexLayout" << std::endl;
+		return false;
+	}
+
+	/////////////////////////////////////////////////////////////////
+
+	glGenBuffers(sizeof(g_vbo) / sizeof(g_vbo[0]), g_vbo);
+
+	for (unsigned i = 0; i < sizeof(g_vbo) / sizeof(g_vbo[0]); ++i)
+		assert(g_vbo[i]);
+
+	/////////////////////////////////////////////////////////////////
+
+	g_phase = new util::BenchPhase(g_warmup, g_frames);
+
+	g_config = 0;
+	g_config_count = g_rows.count * g_order.count * g_index.count * g_format.count;
+	g_config_ready = false;
+
+	std::cout << scene_name << ": " << g_config_count << " configurations, " <<
+		g_warmup << " warmup + " << g_frames << " measured frames each" << std::endl;
+
+	on_error.reset();
+	return true;
+}
+
+static void report_config(
+	const Config& c,
+	const GLint (& vp)[4])
+{
+	util::BenchStats stats;
+
+	if (!g_phase->getStats(stats))
+		return;
+
+	const double s = stats.median * 1e-3;
+
+	util::BenchRecord()
+		.param("rows", c.rows)
+		.param("verts", g_num_verts)
+		.param("tris", g_num_tris)
+		.param("format", format_name[c.format])
+		.param("index", index_name[c.index])
+		.param("order", order_name[c.order])
+		.param("draws", g_draws)
+		.param("width", vp[2])
+		.param("height", vp[3])
+		.metric("frame_ms", stats)
+		.metric("verts_per_s", g_num_verts * g_draws / s)
+		.metric("indices_per_s", g_num_tris * 3 * g_draws / s)
+		.metric("tris_per_s", g_num_tris * g_draws / s)
+		.metric("vertex_bytes_per_s", g_num_verts * format_stride[c.format] * g_draws / s)
+		.metric("acmr_fifo16", g_acmr_16)
+		.metric("acmr_fifo32", g_acmr_32)
+		.emit(scene_name);
+}
+
+bool render_frame()
+{
+	if (!check_context(__FUNCTION__))
+		return false;
+
+	if (g_config == g_config_count)
+		return false;
+
+	const Config c = get_config(g_config);
+	const unsigned rows = c.rows;
+	const unsigned cols = 2 * c.rows - 1;
+
+	if (INDEX_USHORT == c.index && util::polarSphereNumVerts(rows, cols) > 65536) {
+		std::cout << scene_name << ": skipping " << rows << " rows, too many vertices for ushort indices" << std::endl;
+		++g_config;
+		return true;
+	}
+
+	if (INDEX_UINT == c.index && !g_index_uint_supported) {
+		std::cout << scene_name << ": skipping uint indices, no GL_OES_element_index_uint" << std::endl;
+		++g_config;
+		return true;
+	}
+
+	GLint vp[4];
+	glGetIntegerv(GL_VIEWPORT, vp);
+
+	if (!g_config_ready) {
+		if (!createMesh(c, g_vbo[VBO_MESH_VTX], g_vbo[VBO_MESH_IDX])) {
+			std::cerr << __FUNCTION__ << " failed at createMesh" << std::endl;
+			return false;
+		}
+
+		if (FORMAT_PACKED == c.format) {
+			if (!rend::setupVertexAttrPointers< PackedVertex >(g_active_attr_semantics[PROG_MESH]))
+				return false;
+		}
+		else {
+			if (!rend::setupVertexAttrPointers< Vertex >(g_active_attr_semantics[PROG_MESH]))
+				return false;
+		}
+
+		g_phase->reset();
+		g_config_ready = true;
+	}
+
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	/////////////////////////////////////////////////////////////////
+
+	// keep pixel coverage to a few pixels so that only the vertex stage gets measured
+	const float sx = 2.f * g_radius_px / vp[2];
+	const float sy = 2.f * g_radius_px / vp[3];
+
+	const GLfloat mvp[4][4] =
+	{
+		{ sx,  0.f, 0.f, 0.f },
+		{ 0.f, sy,  0.f, 0.f },
+		{ 0.f, 0.f, -.5f, 0.f },
+		{ 0.f, 0.f, 0.f, 1.f }
+	};
+
+	glUseProgram(g_shader_prog[PROG_MESH]);
+
+	DEBUG_GL_ERR()
+
+	if (-1 != g_uni[PROG_MESH][UNI_MVP])
+	{
+		glUniformMatrix4fv(g_uni[PROG_MESH][UNI_MVP],
+			1, GL_FALSE, reinterpret_cast< const GLfloat* >(mvp));
+	}
+
+	DEBUG_GL_ERR()
+
+	for (unsigned i = 0; i < g_active_attr_semantics[PROG_MESH].num_active_attr; ++i)
+		glEnableVertexAttribArray(g_active_attr_semantics[PROG_MESH].active_attr[i]);
+
+	DEBUG_GL_ERR()
+
+	const GLenum index_type = INDEX_USHORT == c.index ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+	glFinish();
+	const uint64_t t0 = util::time_ns();
+
+	for (unsigned i = 0; i < g_draws; ++i)
+		glDrawElements(GL_TRIANGLES, GLsizei(g_num_tris * 3), index_type, (void*) 0);
+
+	glFinish();
+	const uint64_t t1 = util::time_ns();
+
+	DEBUG_GL_ERR()
+
+	for (unsigned i = 0; i < g_active_attr_semantics[PROG_MESH].num_active_attr; ++i)
+		glDisableVertexAttribArray(g_active_attr_semantics[PROG_MESH].active_attr[i]);
+
+	DEBUG_GL_ERR()
+
+	if (g_phase->addFrame(t1 - t0)) {
+		report_config(c, vp);
+
+		++g_config;
+		g_config_ready = false;
+	}
+
+	return true;
+}
+
+} // namespace hook
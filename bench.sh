@@ -0,0 +1,246 @@
+#!/bin/bash
+
+# Benchmark suite runner: builds the guest apps referenced by a suite file, runs every suite entry
+# for a number of repetitions and collects the bench-record lines of all runs, along with the device
+# caps, into a single json report.
+#
+# A suite file lists one entry per line: <entry_name> <guest_app> [<host_args>] [-- <app_args>]
+# Blank lines and lines starting with '#' are ignored.
+
+RESOURCE=resource
+SUITE=bench.suite
+REPS=3
+WARMUP=
+FRAMES=
+ISOLATED=0
+OUTPUT=
+BASELINE=
+
+usage() {
+	echo "usage: $0 [-r repetitions] [-w warmup_frames] [-f measured_frames] [-i] [-o report.json] [-b baseline_dir] [suite_file]"
+	echo "	-r: number of runs per suite entry; default ${REPS}"
+	echo "	-w, -f: warmup and measured frames per configuration, passed to every app; app defaults unless specified"
+	echo "	-i: isolated mode - run each point of a comma-separated sweep in its own process"
+	echo "	-o: report file; bench-<suite>-<timestamp>.json unless specified"
+	echo "	-b: compare the report against the device baseline under baseline_dir; exit status 2 on regressions"
+	echo "	suite_file: ${SUITE} unless specified"
+}
+
+while getopts "r:w:f:io:b:h" OPT; do
+	case $OPT in
+		r) REPS=$OPTARG ;;
+		w) WARMUP=$OPTARG ;;
+		f) FRAMES=$OPTARG ;;
+		i) ISOLATED=1 ;;
+		o) OUTPUT=$OPTARG ;;
+		b) BASELINE=$OPTARG ;;
+		*) usage; exit 1 ;;
+	esac
+done
+shift $((OPTIND - 1))
+
+if [[ -n $1 ]]; then
+	SUITE=$1
+fi
+
+if [[ ! -f $SUITE ]]; then
+	echo "suite file ${SUITE} not found"
+	exit 1
+fi
+
+if ! [[ $REPS =~ ^[1-9][0-9]*$ ]]; then
+	usage
+	exit 1
+fi
+
+TIMESTAMP=`date -u +%Y-%m-%dT%H:%M:%SZ`
+REVISION=`git rev-parse --short HEAD 2>/dev/null`
+
+if [[ -z $OUTPUT ]]; then
+	OUTPUT=bench-`basename ${SUITE} .suite`-`date -u +%Y%m%d%H%M%S`.json
+fi
+
+OUTPUT=`realpath -m ${OUTPUT}`
+
+# escape a string for inclusion in a json string literal
+json_escape() {
+	local str=${1//\\/\\\\}
+	echo -n "${str//\"/\\\"}"
+}
+
+# expand comma-separated values of '-app <key> <v0>,<v1>,..' options into one arg line per sweep point;
+# args are given word by word and result lines are echoed
+expand_sweep() {
+	local prefix=$1
+	shift
+
+	while [[ $# -gt 0 ]]; do
+		if [[ $1 == "-app" && $# -ge 3 && $3 == *,* ]]; then
+			local key=$2
+			local value
+			local IFS=,
+			local values=( $3 )
+			unset IFS
+			shift 3
+
+			for value in "${values[@]}"; do
+				expand_sweep "${prefix}-app ${key} ${value} " "$@"
+			done
+			return
+		fi
+
+		prefix+="$1 "
+		shift
+	done
+
+	echo "${prefix% }"
+}
+
+# parse the suite; keep entries in file order
+ENTRY_NAME=()
+ENTRY_APP=()
+ENTRY_ARGS=()
+
+while read -r NAME APP ARGS; do
+	if [[ -z $NAME || $NAME == \#* ]]; then
+		continue
+	fi
+
+	if [[ -z $APP ]]; then
+		echo "suite entry ${NAME} lacks a guest app"
+		exit 1
+	fi
+
+	ENTRY_NAME+=( "$NAME" )
+	ENTRY_APP+=( "$APP" )
+	ENTRY_ARGS+=( "$ARGS" )
+done < $SUITE
+
+# build each guest app once
+APPS=( `printf "%s\n" "${ENTRY_APP[@]}" | sort -u` )
+
+for APP in ${APPS[@]}; do
+	if [[ ! -f ${APP}.cpp ]]; then
+		echo "guest app ${APP} not found"
+		exit 1
+	fi
+
+	CLICK=0 ./build.sh guest ${APP} > /dev/null && mv ${RESOURCE}/hello-gles ${RESOURCE}/bench-${APP}
+
+	if [[ $? -ne 0 ]]; then
+		echo "failed building guest app ${APP}"
+		exit 1
+	fi
+done
+
+BENCH_DIR=`pwd`
+
+cleanup() {
+	for APP in ${APPS[@]}; do
+		rm -f ${BENCH_DIR}/${RESOURCE}/bench-${APP}
+	done
+}
+trap cleanup EXIT
+
+CAPS=null
+RECORDS=()
+RUNS=()
+
+cd ${RESOURCE}
+
+for (( i = 0; i < ${#ENTRY_NAME[@]}; i++ )); do
+	NAME=${ENTRY_NAME[$i]}
+	APP=${ENTRY_APP[$i]}
+	ARGS=${ENTRY_ARGS[$i]}
+
+	# app args go after the foreign-CLI marker; runner-level frame counts go last so that they prevail
+	if [[ " ${ARGS} " != *" -- "* ]]; then
+		ARGS+=" --"
+	fi
+
+	if [[ -n $WARMUP ]]; then
+		ARGS+=" -app warmup ${WARMUP}"
+	fi
+
+	if [[ -n $FRAMES ]]; then
+		ARGS+=" -app frames ${FRAMES}"
+	fi
+
+	if [[ $ISOLATED -eq 1 ]]; then
+		EXPANDED=`expand_sweep "" $ARGS`
+		IFS=$'\n' POINTS=( $EXPANDED )
+		unset IFS
+	else
+		POINTS=( "$ARGS" )
+	fi
+
+	for (( rep = 0; rep < REPS; rep++ )); do
+		for POINT in "${POINTS[@]}"; do
+			echo "${NAME} rep ${rep}: ${APP} ${POINT}" >&2
+
+			LOG=`./bench-${APP} ${POINT} 2>/dev/null`
+			STATUS=$?
+
+			if [[ $CAPS == null ]]; then
+				CAPS=`echo "$LOG" | sed -n "s/^caps-record: //p" | head -n 1`
+				CAPS=${CAPS:-null}
+			fi
+
+			PREFIX="{\"entry\":\"`json_escape "$NAME"`\",\"app\":\"${APP}\",\"rep\":${rep},\"args\":\"`json_escape "$POINT"`\""
+			NUM_RECORDS=0
+
+			while read -r RECORD; do
+				RECORDS+=( "${PREFIX},\"record\":${RECORD}}" )
+				(( NUM_RECORDS++ ))
+			done < <(echo "$LOG" | sed -n "s/^bench-record: //p")
+
+			RUNS+=( "${PREFIX},\"status\":${STATUS},\"num_records\":${NUM_RECORDS}}" )
+
+			if [[ $STATUS -ne 0 ]]; then
+				echo "${NAME} rep ${rep}: exit status ${STATUS}" >&2
+			fi
+		done
+	done
+done
+
+cd - > /dev/null
+
+join() {
+	local sep=$1
+	shift
+	local first=$1
+	shift
+	echo -n "$first"
+	printf "%s" "${@/#/$sep}"
+}
+
+{
+	echo "{"
+	echo "\"suite\":\"`json_escape "$SUITE"`\","
+	echo "\"timestamp\":\"${TIMESTAMP}\","
+	echo "\"revision\":\"${REVISION}\","
+	echo "\"repetitions\":${REPS},"
+	echo "\"isolated\":${ISOLATED},"
+	echo "\"caps\":${CAPS},"
+	echo "\"runs\":["
+	join $',\n' "${RUNS[@]}"
+	echo ""
+	echo "],"
+	echo "\"records\":["
+	join $',\n' "${RECORDS[@]}"
+	echo ""
+	echo "]"
+	echo "}"
+} > ${OUTPUT}
+
+echo "report written to ${OUTPUT}"
+
+if [[ -n $BASELINE ]]; then
+	BASELINE_TOOL=${RESOURCE}/bench-baseline
+
+	g++ -O2 bench_baseline.cpp util_bench.cpp util_file.cpp -o ${BASELINE_TOOL} || exit 1
+	${BASELINE_TOOL} compare ${BASELINE} ${OUTPUT}
+	STATUS=$?
+	rm -f ${BASELINE_TOOL}
+	exit $STATUS
+fi
@@ -0,0 +1,827 @@
+// Perf baseline store and regression detector for the reports of bench.sh, and for raw app logs
+// carrying bench-record lines. Baselines are kept per device - GL renderer and version - as a
+// directory of accepted reports; new reports get compared against the pool of all baseline runs,
+// metric by metric, via bootstrap confidence intervals of the ratio of medians.
+//
+// Build with:
+//
+//	g++ -O2 bench_baseline.cpp util_bench.cpp util_file.cpp -o bench_baseline
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <errno.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+
+#include "util_file.hpp"
+#include "util_bench.hpp"
+
+namespace json {
+
+enum Type {
+	TYPE_NULL,
+	TYPE_BOOL,
+	TYPE_NUMBER,
+	TYPE_STRING,
+	TYPE_ARRAY,
+	TYPE_OBJECT,
+
+	TYPE_FORCE_UINT = -1U
+};
+
+// document nodes refer to their children by index into the document's node array
+struct Node
+{
+	Type type;
+	double number;
+	std::string string;
+	std::vector< std::string > key;
+	std::vector< size_t > child;
+};
+
+class Document
+{
+	std::vector< Node > node;
+	size_t root_index;
+	const char* pos;
+
+	void skipSpace();
+	bool parseString(std::string& out);
+	bool parseValue(size_t& index);
+
+public:
+	// parse a json text; return false on syntax errors
+	bool parse(const char* const text);
+
+	const Node& root() const;
+	const Node& child(const Node& parent, const size_t i) const;
+
+	// member of an object by name, 0 if absent or not an object
+	const Node* member(const Node& parent, const char* const name) const;
+};
+
+void Document::skipSpace()
+{
+	while (' ' == *pos || '\t' == *pos || '\n' == *pos || '\r' == *pos)
+		++pos;
+}
+
+bool Document::parseString(
+	std::string& out)
+{
+	if ('"' != *pos)
+		return false;
+
+	for (++pos; '"' != *pos; ++pos) {
+		if ('\0' == *pos)
+			return false;
+
+		if ('\\' != *pos) {
+			out += *pos;
+			continue;
+		}
+
+		switch (*++pos) {
+		case 'n':
+			out += '\n';
+			break;
+		case 't':
+			out += '\t';
+			break;
+		case 'r':
+			out += '\r';
+			break;
+		case 'b':
+			out += '\b';
+			break;
+		case 'f':
+			out += '\f';
+			break;
+		case 'u':
+			// our producers never escape non-ascii; keep the code point as-is
+			for (unsigned i = 0; i < 4; ++i)
+				if (!isxdigit(*++pos))
+					return false;
+
+			out += '?';
+			break;
+		case '\0':
+			return false;
+		default:
+			out += *pos;
+			break;
+		}
+	}
+
+	++pos;
+	return true;
+}
+
+bool Document::parseValue(
+	size_t& index)
+{
+	skipSpace();
+
+	Node n;
+	n.number = 0.0;
+
+	if ('{' == *pos || '[' == *pos) {
+		const bool object = '{' == *pos;
+		const char close = object ? '}' : ']';
+
+		n.type = object ? TYPE_OBJECT : TYPE_ARRAY;
+		++pos;
+		skipSpace();
+
+		while (close != *pos) {
+			if (!n.child.empty()) {
+				if (',' != *pos)
+					return false;
+
+				++pos;
+				skipSpace();
+			}
+
+			if (object) {
+				std::string key;
+
+				if (!parseString(key))
+					return false;
+
+				skipSpace();
+
+				if (':' != *pos++)
+					return false;
+
+				n.key.push_back(key);
+			}
+
+			size_t child;
+
+			if (!parseValue(child))
+				return false;
+
+			n.child.push_back(child);
+			skipSpace();
+		}
+
+		++pos;
+	}
+	else
+	if ('"' == *pos) {
+		n.type = TYPE_STRING;
+
+		if (!parseString(n.string))
+			return false;
+	}
+	else
+	if (!strncmp(pos, "null", 4)) {
+		n.type = TYPE_NULL;
+		pos += 4;
+	}
+	else
+	if (!strncmp(pos, "true", 4)) {
+		n.type = TYPE_BOOL;
+		n.number = 1.0;
+		pos += 4;
+	}
+	else
+	if (!strncmp(pos, "false", 5)) {
+		n.type = TYPE_BOOL;
+		pos += 5;
+	}
+	else {
+		char* end;
+		n.type = TYPE_NUMBER;
+		n.number = strtod(pos, &end);
+
+		if (end == pos)
+			return false;
+
+		pos = end;
+	}
+
+	index = node.size();
+	node.push_back(n);
+	return true;
+}
+
+bool Document::parse(
+	const char* const text)
+{
+	node.clear();
+	pos = text;
+
+	if (!parseValue(root_index))
+		return false;
+
+	skipSpace();
+	return '\0' == *pos;
+}
+
+const Node& Document::root() const
+{
+	return node[root_index];
+}
+
+const Node& Document::child(
+	const Node& parent,
+	const size_t i) const
+{
+	return node[parent.child[i]];
+}
+
+const Node* Document::member(
+	const Node& parent,
+	const char* const name) const
+{
+	if (TYPE_OBJECT != parent.type)
+		return 0;
+
+	for (size_t i = 0; i < parent.key.size(); ++i)
+		if (parent.key[i] == name)
+			return &node[parent.child[i]];
+
+	return 0;
+}
+
+} // namespace json
+
+static const char caps_record_prefix[] = "caps-record: ";
+
+// per record key (entry, scene and params), per metric name, one sample per run
+typedef std::map< std::string, std::vector< double > > MetricSamples;
+typedef std::map< std::string, MetricSamples > SampleSet;
+
+// device key from a caps record: sanitized GL renderer and version
+static std::string getDeviceKey(
+	const json::Document& doc,
+	const json::Node& caps)
+{
+	const json::Node* const gl = doc.member(caps, "gl");
+	std::string key;
+
+	if (0 != gl) {
+		const char* const field[] = { "renderer", "version" };
+
+		for (size_t i = 0; i < sizeof(field) / sizeof(field[0]); ++i) {
+			const json::Node* const str = doc.member(*gl, field[i]);
+
+			if (0 == str || json::TYPE_STRING != str->type)
+				continue;
+
+			if (!key.empty())
+				key += '_';
+
+			key += str->string;
+		}
+	}
+
+	for (size_t i = 0; i < key.size(); ++i)
+		if (!isalnum(key[i]) && '.' != key[i] && '-' != key[i])
+			key[i] = '_';
+
+	return key.empty() ? "unknown" : key;
+}
+
+// add the metrics of a bench record under its key
+static bool addRecord(
+	const json::Document& doc,
+	const json::Node& record,
+	const std::string& entry,
+	SampleSet& set)
+{
+	const json::Node* const scene = doc.member(record, "scene");
+	const json::Node* const params = doc.member(record, "params");
+	const json::Node* const metrics = doc.member(record, "metrics");
+
+	if (0 == scene || 0 == metrics || json::TYPE_OBJECT != metrics->type)
+		return false;
+
+	std::string key = entry.empty() ? scene->string : entry + '/' + scene->string;
+	key += '{';
+
+	for (size_t i = 0; 0 != params && i < params->key.size(); ++i) {
+		const json::Node& value = doc.child(*params, i);
+		char buffer[32] = "";
+
+		if (json::TYPE_NUMBER == value.type)
+			snprintf(buffer, sizeof(buffer), "%g", value.number);
+
+		if (0 != i)
+			key += ',';
+
+		key += params->key[i];
+		key += '=';
+		key += json::TYPE_STRING == value.type ? value.string : buffer;
+	}
+
+	key += '}';
+
+	for (size_t i = 0; i < metrics->key.size(); ++i) {
+		const json::Node& value = doc.child(*metrics, i);
+
+		// nulls stand for non-finite results; skip those
+		if (json::TYPE_NUMBER == value.type)
+			set[key][metrics->key[i]].push_back(value.number);
+	}
+
+	return true;
+}
+
+// ingest a bench.sh report, or a raw app log carrying caps and bench record lines
+static bool ingestFile(
+	const char* const filename,
+	SampleSet& set,
+	std::string& device)
+{
+	size_t size;
+	char* const buffer = util::get_buffer_from_file(filename, size);
+
+	if (0 == buffer)
+		return false;
+
+	const std::string text(buffer, size);
+	free(buffer);
+
+	const size_t first = text.find_first_not_of(" \t\r\n");
+	json::Document doc;
+
+	if (std::string::npos != first && '{' == text[first]) {
+		if (!doc.parse(text.c_str())) {
+			fprintf(stderr, "%s failed parsing report '%s'\n", __FUNCTION__, filename);
+			return false;
+		}
+
+		const json::Node* const caps = doc.member(doc.root(), "caps");
+		const json::Node* const records = doc.member(doc.root(), "records");
+
+		if (0 == records || json::TYPE_ARRAY != records->type) {
+			fprintf(stderr, "%s found no records in report '%s'\n", __FUNCTION__, filename);
+			return false;
+		}
+
+		if (0 != caps && json::TYPE_OBJECT == caps->type)
+			device = getDeviceKey(doc, *caps);
+
+		for (size_t i = 0; i < records->child.size(); ++i) {
+			const json::Node& item = doc.child(*records, i);
+			const json::Node* const entry = doc.member(item, "entry");
+			const json::Node* const record = doc.member(item, "record");
+
+			if (0 == entry || 0 == record || !addRecord(doc, *record, entry->string, set)) {
+				fprintf(stderr, "%s skipping malformed record %zu in '%s'\n", __FUNCTION__, i, filename);
+				continue;
+			}
+		}
+
+		return true;
+	}
+
+	const size_t caps_len = strlen(caps_record_prefix);
+	const size_t bench_len = strlen(util::bench_record_prefix);
+
+	for (size_t pos = 0; pos < text.size();) {
+		size_t end = text.find('\n', pos);
+
+		if (std::string::npos == end)
+			end = text.size();
+
+		const std::string line(text, pos, end - pos);
+		pos = end + 1;
+
+		if (!line.compare(0, caps_len, caps_record_prefix)) {
+			if (doc.parse(line.c_str() + caps_len))
+				device = getDeviceKey(doc, doc.root());
+		}
+		else
+		if (!line.compare(0, bench_len, util::bench_record_prefix)) {
+			if (!doc.parse(line.c_str() + bench_len) || !addRecord(doc, doc.root(), std::string(), set))
+				fprintf(stderr, "%s skipping malformed record in '%s'\n", __FUNCTION__, filename);
+		}
+	}
+
+	return true;
+}
+
+static bool listDirectory(
+	const std::string& path,
+	std::vector< std::string >& name)
+{
+	DIR* const dir = opendir(path.c_str());
+
+	if (0 == dir)
+		return false;
+
+	while (const struct dirent* const ent = readdir(dir))
+		if ('.' != ent->d_name[0])
+			name.push_back(path + '/' + ent->d_name);
+
+	closedir(dir);
+	std::sort(name.begin(), name.end());
+	return true;
+}
+
+static bool makeDirectory(
+	const std::string& path)
+{
+	for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+		const std::string sub(path, 0, pos);
+
+		if (0 != mkdir(sub.c_str(), 0755) && EEXIST != errno) {
+			fprintf(stderr, "%s cannot create directory '%s'\n", __FUNCTION__, sub.c_str());
+			return false;
+		}
+
+		if (std::string::npos == pos)
+			return true;
+	}
+}
+
+static bool copyFile(
+	const char* const src,
+	const std::string& dst)
+{
+	size_t size;
+	char* const buffer = util::get_buffer_from_file(src, size);
+
+	if (0 == buffer)
+		return false;
+
+	FILE* const f = fopen(dst.c_str(), "w");
+	const bool success = 0 != f && size == fwrite(buffer, 1, size, f);
+
+	if (0 != f)
+		fclose(f);
+
+	free(buffer);
+
+	if (!success)
+		fprintf(stderr, "%s cannot write file '%s'\n", __FUNCTION__, dst.c_str());
+
+	return success;
+}
+
+static const char* baseName(
+	const char* const path)
+{
+	const char* const slash = strrchr(path, '/');
+	return 0 != slash ? slash + 1 : path;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// statistics
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static double median(
+	std::vector< double > sample)
+{
+	util::BenchStats stats;
+	return util::reduceSamples(sample, stats) ? stats.median : 0.0;
+}
+
+// reject outliers by modified z-score over the median absolute deviation (Iglewicz & Hoaglin), up to
+// a quarter of the samples, most extreme first; return the number of rejected samples
+static size_t rejectOutliers(
+	std::vector< double >& sample)
+{
+	const double threshold = 3.5;
+
+	if (sample.size() < 4)
+		return 0;
+
+	const double med = median(sample);
+	std::vector< double > dev(sample.size());
+
+	for (size_t i = 0; i < sample.size(); ++i)
+		dev[i] = fabs(sample[i] - med);
+
+	const double mad = median(dev);
+
+	// over half the samples are identical - nothing stands out
+	if (0.0 == mad)
+		return 0;
+
+	// small sample sets can have a deceptively tight MAD; cap the rejections
+	const size_t count = sample.size();
+	const size_t max_rejected = count / 4;
+
+	std::vector< std::pair< double, double > > scored(count);
+
+	for (size_t i = 0; i < count; ++i)
+		scored[i] = std::make_pair(.6745 * dev[i] / mad, sample[i]);
+
+	std::sort(scored.begin(), scored.end());
+
+	size_t kept = count;
+	while (kept > count - max_rejected && scored[kept - 1].first > threshold)
+		--kept;
+
+	for (size_t i = 0; i < kept; ++i)
+		sample[i] = scored[i].second;
+
+	sample.resize(kept);
+	return count - kept;
+}
+
+static uint32_t xorshift32(
+	uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+static double resampledMedian(
+	const std::vector< double >& sample,
+	std::vector< double >& scratch,
+	uint32_t& seed)
+{
+	for (size_t i = 0; i < sample.size(); ++i)
+		scratch[i] = sample[xorshift32(seed) % sample.size()];
+
+	std::nth_element(scratch.begin(), scratch.begin() + scratch.size() / 2, scratch.end());
+	double med = scratch[scratch.size() / 2];
+
+	if (0 == (scratch.size() & 1))
+		med = (med + *std::max_element(scratch.begin(), scratch.begin() + scratch.size() / 2)) * .5;
+
+	return med;
+}
+
+// percentile-bootstrap confidence interval of the ratio median(cand) / median(base)
+static void bootstrapRatioCI(
+	const std::vector< double >& base,
+	const std::vector< double >& cand,
+	const unsigned num_resamples,
+	const double confidence,
+	double& lo,
+	double& hi)
+{
+	std::vector< double > scratch_base(base.size());
+	std::vector< double > scratch_cand(cand.size());
+	std::vector< double > ratio;
+	ratio.reserve(num_resamples);
+
+	// deterministic, so that a given pair of data sets always gets the same verdict
+	uint32_t seed = 0x9e3779b9;
+
+	for (unsigned i = 0; i < num_resamples; ++i) {
+		const double b = resampledMedian(base, scratch_base, seed);
+		const double c = resampledMedian(cand, scratch_cand, seed);
+
+		if (0.0 != b)
+			ratio.push_back(c / b);
+	}
+
+	if (ratio.empty()) {
+		lo = hi = NAN;
+		return;
+	}
+
+	std::sort(ratio.begin(), ratio.end());
+
+	const double tail = (1.0 - confidence) * .5;
+	lo = ratio[size_t(floor(tail * (ratio.size() - 1)))];
+	hi = ratio[size_t(ceil((1.0 - tail) * (ratio.size() - 1)))];
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// commands
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+static const char* const default_metrics = "frame_ms_p95,startup_ms,max_rss_kb";
+
+static const unsigned num_resamples = 2000;
+static const double confidence = .95;
+
+// throughput metrics are higher-is-better; times, sizes and everything else are lower-is-better
+static bool isHigherBetter(
+	const std::string& metric)
+{
+	return std::string::npos != metric.find("_per_s");
+}
+
+static int store(
+	const std::string& dir,
+	const bool replace,
+	char** const report,
+	const int num_reports)
+{
+	std::vector< std::string > replaced;
+
+	for (int i = 0; i < num_reports; ++i) {
+		SampleSet set;
+		std::string device;
+
+		if (!ingestFile(report[i], set, device))
+			return 1;
+
+		if (device.empty()) {
+			fprintf(stderr, "report '%s' carries no device caps\n", report[i]);
+			return 1;
+		}
+
+		const std::string device_dir = dir + '/' + device;
+
+		if (!makeDirectory(device_dir))
+			return 1;
+
+		// replacing drops the existing baseline of a device before storing its first report
+		if (replace && replaced.end() == std::find(replaced.begin(), replaced.end(), device)) {
+			std::vector< std::string > existing;
+			listDirectory(device_dir, existing);
+
+			for (size_t j = 0; j < existing.size(); ++j)
+				remove(existing[j].c_str());
+
+			replaced.push_back(device);
+		}
+
+		const std::string dst = device_dir + '/' + baseName(report[i]);
+
+		if (!copyFile(report[i], dst))
+			return 1;
+
+		fprintf(stdout, "stored %s as %s\n", report[i], dst.c_str());
+	}
+
+	return 0;
+}
+
+static int compare(
+	const std::string& dir,
+	const double threshold,
+	const char* const metric_list,
+	char** const report,
+	const int num_reports)
+{
+	std::vector< std::string > metric;
+
+	for (const char* m = metric_list; *m;) {
+		const char* const comma = strchr(m, ',');
+		const size_t len = 0 != comma ? size_t(comma - m) : strlen(m);
+
+		if (0 != len)
+			metric.push_back(std::string(m, len));
+
+		m += len + (0 != comma);
+	}
+
+	SampleSet cand;
+	std::string device;
+
+	for (int i = 0; i < num_reports; ++i)
+		if (!ingestFile(report[i], cand, device))
+			return 1;
+
+	std::vector< std::string > baseline_file;
+
+	if (device.empty() || !listDirectory(dir + '/' + device, baseline_file) || baseline_file.empty()) {
+		fprintf(stderr, "no baseline for device '%s' under '%s'\n", device.c_str(), dir.c_str());
+		return 1;
+	}
+
+	SampleSet base;
+
+	for (size_t i = 0; i < baseline_file.size(); ++i) {
+		std::string base_device;
+
+		if (!ingestFile(baseline_file[i].c_str(), base, base_device))
+			return 1;
+	}
+
+	fprintf(stdout, "device %s: %zu baseline report(s), threshold %.1f%%, %.0f%% confidence\n",
+		device.c_str(), baseline_file.size(), threshold * 100.0, confidence * 100.0);
+
+	unsigned num_regressions = 0;
+	unsigned num_improvements = 0;
+	unsigned num_compared = 0;
+
+	for (SampleSet::const_iterator it = cand.begin(); it != cand.end(); ++it) {
+		const SampleSet::const_iterator bit = base.find(it->first);
+
+		if (base.end() == bit) {
+			fprintf(stdout, "new        %s\n", it->first.c_str());
+			continue;
+		}
+
+		for (size_t i = 0; i < metric.size(); ++i) {
+			const MetricSamples::const_iterator cm = it->second.find(metric[i]);
+			const MetricSamples::const_iterator bm = bit->second.find(metric[i]);
+
+			if (it->second.end() == cm || bit->second.end() == bm)
+				continue;
+
+			std::vector< double > b(bm->second);
+			std::vector< double > c(cm->second);
+			const size_t b_rejected = rejectOutliers(b);
+			const size_t c_rejected = rejectOutliers(c);
+
+			double lo, hi;
+			bootstrapRatioCI(b, c, num_resamples, confidence, lo, hi);
+
+			const double b_median = median(b);
+			const double c_median = median(c);
+
+			// a regression needs the whole confidence interval past the threshold in the bad direction
+			const char* verdict = "ok        ";
+
+			if (isnan(lo))
+				verdict = "n/a       ";
+			else
+			if (isHigherBetter(metric[i]) ? hi < 1.0 - threshold : lo > 1.0 + threshold) {
+				verdict = "REGRESSION";
+				++num_regressions;
+			}
+			else
+			if (isHigherBetter(metric[i]) ? lo > 1.0 + threshold : hi < 1.0 - threshold) {
+				verdict = "improved  ";
+				++num_improvements;
+			}
+
+			fprintf(stdout, "%s %s %s: %g -> %g, %+.1f%% [%+.1f%%, %+.1f%%], n %zu/%zu, outliers %zu/%zu\n",
+				verdict, it->first.c_str(), metric[i].c_str(),
+				b_median, c_median, (c_median / b_median - 1.0) * 100.0,
+				(lo - 1.0) * 100.0, (hi - 1.0) * 100.0,
+				b.size(), c.size(), b_rejected, c_rejected);
+
+			++num_compared;
+		}
+	}
+
+	fprintf(stdout, "%u comparisons, %u regressions, %u improvements\n",
+		num_compared, num_regressions, num_improvements);
+
+	return 0 != num_regressions ? 2 : 0;
+}
+
+static void usage(
+	const char* const name)
+{
+	fprintf(stderr,
+		"usage: %s store [-r] <baseline_dir> <report> [<report>..]\n"
+		"       %s compare [-t <threshold_%%>] [-m <metric>[,<metric>..]] <baseline_dir> <report> [<report>..]\n"
+		"\tstore: add the reports to the baseline of their device; -r replaces the existing baseline\n"
+		"\tcompare: flag metrics whose bootstrap confidence interval lies past the threshold (default 5%%);\n"
+		"\t\tdefault metrics: %s\n"
+		"reports are bench.sh json reports or raw app logs; exit status is 2 when regressions are found\n",
+		name, name, default_metrics);
+}
+
+int main(
+	int argc,
+	char** argv)
+{
+	if (argc < 2) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	const std::string command(argv[1]);
+	bool replace = false;
+	double threshold = .05;
+	const char* metric_list = default_metrics;
+	int i = 2;
+
+	for (; i < argc && '-' == argv[i][0]; ++i) {
+		if (!strcmp(argv[i], "-r") && "store" == command)
+			replace = true;
+		else
+		if (!strcmp(argv[i], "-t") && "compare" == command && i + 1 < argc) {
+			threshold = atof(argv[++i]) * .01;
+		}
+		else
+		if (!strcmp(argv[i], "-m") && "compare" == command && i + 1 < argc) {
+			metric_list = argv[++i];
+		}
+		else {
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	if (argc - i < 2 || !(threshold > 0.0)) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	if ("store" == command)
+		return store(argv[i], replace, argv + i + 1, argc - i - 1);
+
+	if ("compare" == command)
+		return compare(argv[i], threshold, metric_list, argv + i + 1, argc - i - 1);
+
+	usage(argv[0]);
+	return 1;
+}
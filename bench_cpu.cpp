@@ -0,0 +1,908 @@
+// CPU-side unit checks and microbenchmarks of the non-GL code paths: polar-sphere generation, matx3,
+// texture-buffer helpers, shader string patching and preprocessing, shader variant selection, and
+// file loading. Needs no EGL context - GL entry points get linked but never called. Run from the repo root; results go to stdout as bench records.
+//
+// Build with:
+//
+//	g++ -O3 -I./include -DANDROID -DPLATFORM_GLES -DNDEBUG -o bench_cpu bench_cpu.cpp util_bench.cpp
+//		util_file.cpp util_tex.cpp util_misc.cpp util_mesh.cpp util_preproc.cpp util_permute.cpp -lGLESv2
+
+#include <time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <math.h>
+#include <string>
+#include <vector>
+
+#include "util_file.hpp"
+#include "util_tex.hpp"
+#include "util_misc.hpp"
+#include "util_mesh.hpp"
+#include "util_matx.hpp"
+#include "util_bench.hpp"
+#include "util_preproc.hpp"
+#include "util_permute.hpp"
+
+namespace util {
+
+// no GL or EGL context in this host - there is nothing to report
+bool reportGLError(FILE*)
+{
+	return false;
+}
+
+bool reportEGLError(FILE*)
+{
+	return false;
+}
+
+uint64_t time_ns()
+{
+#if defined(CLOCK_MONOTONIC_RAW)
+	const clockid_t clockid = CLOCK_MONOTONIC_RAW;
+
+#else
+	const clockid_t clockid = CLOCK_MONOTONIC;
+
+#endif
+	timespec t;
+	clock_gettime(clockid, &t);
+
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
+} // namespace util
+
+namespace {
+
+struct Vertex {
+	float pos[3];
+	float nrm[3];
+	float txc[2];
+};
+
+// app_sphere's mesh
+const int sphere_rows = 33;
+const int sphere_cols = 65;
+
+const char* const shader_filename = "resource/phong_bump_tang.glslf";
+const char* const raw_filename = "resource/rockwall.raw";
+
+unsigned g_num_failed;
+unsigned g_num_checks;
+
+// results of benchmarked ops get folded in here, so the compiler cannot drop the ops
+volatile uint32_t g_sink;
+
+#define CHECK(cond)                                                                                \
+	do {                                                                                           \
+		++g_num_checks;                                                                            \
+		if (!(cond)) {                                                                             \
+			++g_num_failed;                                                                        \
+			fprintf(stderr, "%s:%d check failed: %s\n", __FILE__, __LINE__, #cond);                \
+		}                                                                                          \
+	} while (0)
+
+bool near(
+	const float a,
+	const float b,
+	const float eps = 1e-5f)
+{
+	return fabsf(a - b) <= eps;
+}
+
+bool read_file(
+	const char* const filename,
+	std::string& out)
+{
+	size_t size;
+	char* const buffer = util::get_buffer_from_file(filename, size);
+
+	if (0 == buffer)
+		return false;
+
+	out.assign(buffer, size);
+	free(buffer);
+	return true;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// unit checks
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+void check_polar_sphere()
+{
+	const size_t num_verts = util::polarSphereNumVerts(sphere_rows, sphere_cols);
+	const size_t num_tris = util::polarSphereNumTris(sphere_rows, sphere_cols);
+
+	CHECK(2143 == num_verts);
+	CHECK(3968 == num_tris);
+
+	const float r = 2.f;
+	std::vector< Vertex > arr(num_verts);
+	std::vector< uint16_t > idx(num_tris * 3);
+
+	util::fillPolarSphereVerts(&arr[0], sphere_rows, sphere_cols, r, 1.f);
+	util::fillPolarSphereIndices(reinterpret_cast< uint16_t(*)[3] >(&idx[0]), sphere_rows, sphere_cols);
+
+	bool unit_normals = true;
+	bool on_sphere = true;
+	bool txc_in_range = true;
+
+	for (size_t i = 0; i < num_verts; ++i) {
+		const Vertex& v = arr[i];
+		const float len = sqrtf(v.nrm[0] * v.nrm[0] + v.nrm[1] * v.nrm[1] + v.nrm[2] * v.nrm[2]);
+
+		unit_normals = unit_normals && near(len, 1.f);
+		on_sphere = on_sphere &&
+			near(v.pos[0], r * v.nrm[0]) &&
+			near(v.pos[1], r * v.nrm[1]) &&
+			near(v.pos[2], r * v.nrm[2]);
+		txc_in_range = txc_in_range &&
+			v.txc[0] >= 0.f && v.txc[0] <= 1.f &&
+			v.txc[1] >= 0.f && v.txc[1] <= .5f;
+	}
+
+	CHECK(unit_normals);
+	CHECK(on_sphere);
+	CHECK(txc_in_range);
+
+	bool in_range = true;
+	bool non_degenerate = true;
+	std::vector< bool > used(num_verts, false);
+
+	for (size_t i = 0; i < num_tris; ++i) {
+		const uint16_t* const t = &idx[i * 3];
+
+		in_range = in_range && t[0] < num_verts && t[1] < num_verts && t[2] < num_verts;
+
+		if (!in_range)
+			break;
+
+		non_degenerate = non_degenerate && t[0] != t[1] && t[1] != t[2] && t[2] != t[0];
+		used[t[0]] = used[t[1]] = used[t[2]] = true;
+	}
+
+	CHECK(in_range);
+	CHECK(non_degenerate);
+
+	// the seam column is duplicated for its texcoords; every vertex gets referenced regardless
+	size_t num_used = 0;
+	for (size_t i = 0; i < num_verts; ++i)
+		num_used += used[i];
+
+	CHECK(num_verts == num_used);
+
+	// all triangles wind counter-clockwise as seen from outside
+	bool outward = true;
+
+	for (size_t i = 0; i < num_tris && in_range; ++i) {
+		const float* const p0 = arr[idx[i * 3 + 0]].pos;
+		const float* const p1 = arr[idx[i * 3 + 1]].pos;
+		const float* const p2 = arr[idx[i * 3 + 2]].pos;
+
+		const float e0[3] = { p1[0] - p0[0], p1[1] - p0[1], p1[2] - p0[2] };
+		const float e1[3] = { p2[0] - p0[0], p2[1] - p0[1], p2[2] - p0[2] };
+		const float n[3] = {
+			e0[1] * e1[2] - e0[2] * e1[1],
+			e0[2] * e1[0] - e0[0] * e1[2],
+			e0[0] * e1[1] - e0[1] * e1[0]
+		};
+
+		const float c[3] = { p0[0] + p1[0] + p2[0], p0[1] + p1[1] + p2[1], p0[2] + p1[2] + p2[2] };
+
+		outward = outward && n[0] * c[0] + n[1] * c[1] + n[2] * c[2] > 0.f;
+	}
+
+	CHECK(outward);
+}
+
+void check_polar_sphere_tangents()
+{
+	struct TangentVertex {
+		float pos[3];
+		float nrm[3];
+		float txc[2];
+		float tng[4];
+	};
+
+	const size_t num_verts = util::polarSphereNumVerts(sphere_rows, sphere_cols);
+	const size_t num_tris = util::polarSphereNumTris(sphere_rows, sphere_cols);
+
+	std::vector< TangentVertex > arr(num_verts);
+	std::vector< uint16_t > idx(num_tris * 3);
+
+	util::fillPolarSphereVerts(&arr[0], sphere_rows, sphere_cols, 1.f, 2.f);
+	util::fillPolarSphereIndices(reinterpret_cast< uint16_t(*)[3] >(&idx[0]), sphere_rows, sphere_cols);
+	util::fillTangents(&arr[0], num_verts, reinterpret_cast< uint16_t(*)[3] >(&idx[0]), num_tris);
+
+	bool unit_tangents = true;
+	bool orthogonal = true;
+	bool unit_handedness = true;
+	bool along_u = true;
+
+	for (size_t i = 0; i < num_verts; ++i) {
+		const TangentVertex& v = arr[i];
+		const float len = sqrtf(v.tng[0] * v.tng[0] + v.tng[1] * v.tng[1] + v.tng[2] * v.tng[2]);
+
+		unit_tangents = unit_tangents && near(len, 1.f, 1e-4f);
+		orthogonal = orthogonal && near(v.nrm[0] * v.tng[0] + v.nrm[1] * v.tng[1] + v.nrm[2] * v.tng[2], 0.f, 1e-4f);
+		unit_handedness = unit_handedness && (1.f == v.tng[3] || -1.f == v.tng[3]);
+
+		// u grows with the azimuth: away from the poles, tangents point along the parallels, eastward
+		if (fabsf(v.nrm[2]) < .9f) {
+			const float east[2] = { -v.nrm[1], v.nrm[0] };
+			along_u = along_u && v.tng[0] * east[0] + v.tng[1] * east[1] > .99f * sqrtf(east[0] * east[0] + east[1] * east[1]);
+		}
+	}
+
+	CHECK(unit_tangents);
+	CHECK(orthogonal);
+	CHECK(unit_handedness);
+	CHECK(along_u);
+
+	// v grows northward, and the frame (t, cross(n, t) * w, n) keeps the bi-tangent along it
+	bool along_v = true;
+
+	for (size_t i = 0; i < num_verts; ++i) {
+		const TangentVertex& v = arr[i];
+
+		if (fabsf(v.nrm[2]) >= .9f)
+			continue;
+
+		const float b_z = (v.nrm[0] * v.tng[1] - v.nrm[1] * v.tng[0]) * v.tng[3];
+		along_v = along_v && b_z > 0.f;
+	}
+
+	CHECK(along_v);
+}
+
+void check_matx3()
+{
+	const float a = .7f;
+	const util::matx3 rz = util::matx3_rotate(a, 0.f, 0.f, 1.f);
+
+	// row-vector convention: x rotates towards y for positive angles about z
+	const float x[1][3] = { { 1.f, 0.f, 0.f } };
+	float out[1][3];
+	rz.transform(x, out);
+
+	CHECK(near(out[0][0], cosf(a)));
+	CHECK(near(out[0][1], sinf(a)));
+	CHECK(near(out[0][2], 0.f));
+
+	// extra vector elements pass through
+	const float x4[1][4] = { { 1.f, 0.f, 0.f, 42.f } };
+	float out4[1][4];
+	rz.transform(x4, out4);
+
+	CHECK(near(out4[0][0], out[0][0]) && near(out4[0][1], out[0][1]) && 42.f == out4[0][3]);
+
+	// rotations about an axis compose additively and invert by negation
+	const float nx = 1.f / sqrtf(3.f);
+	const util::matx3 ra = util::matx3_rotate(.3f, nx, nx, nx);
+	const util::matx3 rb = util::matx3_rotate(.5f, nx, nx, nx);
+	const util::matx3 rab = util::matx3_rotate(.8f, nx, nx, nx);
+	const util::matx3 prod = util::matx3_mul(ra, rb);
+	const util::matx3 ident = util::matx3_mul(ra, util::matx3_rotate(-.3f, nx, nx, nx));
+
+	bool composes = true;
+	bool inverts = true;
+	bool orthonormal = true;
+
+	for (size_t i = 0; i < 3; ++i)
+		for (size_t j = 0; j < 3; ++j) {
+			composes = composes && near(prod[i][j], rab[i][j]);
+			inverts = inverts && near(ident[i][j], i == j ? 1.f : 0.f);
+
+			float dot = 0.f;
+			for (size_t k = 0; k < 3; ++k)
+				dot += ra[i][k] * ra[j][k];
+
+			orthonormal = orthonormal && near(dot, i == j ? 1.f : 0.f);
+		}
+
+	CHECK(composes);
+	CHECK(inverts);
+	CHECK(orthonormal);
+}
+
+void check_integral_size()
+{
+	CHECK(1 == util::integral_size(1));
+	CHECK(2 == util::integral_size(2));
+	CHECK(4 == util::integral_size(3));
+	CHECK(4 == util::integral_size(sizeof(util::pix)));
+	CHECK(8 == util::integral_size(5));
+	CHECK(1024 == util::integral_size(1000));
+	CHECK(1024 == util::integral_size(1024));
+	CHECK(2048 == util::integral_size(1025));
+}
+
+void check_fill_with_checker()
+{
+	const unsigned dim_x = 24;
+	const unsigned dim_y = 20;
+	const unsigned stride = 32 * sizeof(util::pix);
+	const uint8_t canary = 0xcd;
+
+	std::vector< uint8_t > buffer(stride * dim_y, canary);
+	util::fill_with_checker(reinterpret_cast< util::pix* >(&buffer[0]), stride, dim_x, dim_y);
+
+	const util::pix* const row0 = reinterpret_cast< const util::pix* >(&buffer[0]);
+	const util::pix* const row8 = reinterpret_cast< const util::pix* >(&buffer[8 * stride]);
+
+	// 8x8 tiles, alternating
+	CHECK(255 == row0[0].c[0] && 128 == row0[0].c[2]);
+	CHECK(255 == row0[7].c[0]);
+	CHECK(128 == row0[8].c[0] && 255 == row0[8].c[2]);
+	CHECK(255 == row0[16].c[0]);
+	CHECK(128 == row8[0].c[0]);
+	CHECK(255 == row8[8].c[0]);
+
+	// the row padding stays untouched
+	bool padding_intact = true;
+
+	for (unsigned y = 0; y < dim_y; ++y)
+		for (unsigned i = dim_x * sizeof(util::pix); i < stride; ++i)
+			padding_intact = padding_intact && canary == buffer[y * stride + i];
+
+	CHECK(padding_intact);
+
+	// other granularities
+	util::fill_with_checker(reinterpret_cast< util::pix* >(&buffer[0]), stride, dim_x, dim_y, 2);
+
+	CHECK(255 == row0[1].c[0]);
+	CHECK(128 == row0[2].c[0]);
+}
+
+void check_patch_string()
+{
+	const std::string patch[] = {
+		std::string("///essl "),  std::string(""),
+		std::string("///defines"), std::string("#define FOO 1\n"),
+		std::string(""),           std::string("never"),
+		std::string("same"),       std::string("same")
+	};
+	const size_t patch_count = sizeof(patch) / sizeof(patch[0]) / 2;
+
+	std::string str("///essl precision lowp float;\n///defines\n///essl void main() {}\nsame\n");
+	CHECK(3 == util::patchString(str, patch_count, patch));
+	CHECK(str == "precision lowp float;\n#define FOO 1\n\nvoid main() {}\nsame\n");
+
+	// replacements that contain their source do not get re-patched
+	const std::string grow[] = { std::string("a"), std::string("aa") };
+	std::string str_grow("abca");
+	CHECK(2 == util::patchString(str_grow, 1, grow));
+	CHECK(str_grow == "aabcaa");
+
+	// patches apply in order, later ones seeing the output of earlier ones
+	const std::string chain[] = {
+		std::string("x"), std::string("y"),
+		std::string("y"), std::string("z")
+	};
+	std::string str_chain("xy");
+	CHECK(3 == util::patchString(str_chain, 2, chain));
+	CHECK(str_chain == "zz");
+
+	std::string str_none("nothing to see");
+	CHECK(0 == util::patchString(str_none, patch_count, patch));
+}
+
+bool write_file(
+	const std::string& filename,
+	const char* const content)
+{
+	FILE* const f = fopen(filename.c_str(), "wb");
+
+	if (0 == f)
+		return false;
+
+	const size_t len = strlen(content);
+	const bool success = len == fwrite(content, 1, len, f);
+	fclose(f);
+
+	return success;
+}
+
+std::string concat_source(
+	const util::ShaderSource& src)
+{
+	std::string str;
+
+	for (GLsizei i = 0; i < src.count(); ++i)
+		str.append(src.strings()[i], src.lengths()[i]);
+
+	return str;
+}
+
+void check_preprocess_shader()
+{
+	char dirname[] = "/tmp/bench_cpu_XXXXXX";
+	CHECK(0 != mkdtemp(dirname));
+
+	const std::string dir(dirname);
+	const std::string main_name = dir + "/main.glsl";
+	const std::string bad_name = dir + "/bad.glsl";
+	const std::string missing_name = dir + "/missing.glsl";
+
+	CHECK(write_file(main_name,
+		"// main\n"
+		"#include \"common.glslh\"\n"
+		"  #  include \"sub/leaf.glslh\"\n"
+		"void main() {}\n"));
+	CHECK(0 == mkdir((dir + "/sub").c_str(), 0755));
+	CHECK(write_file(dir + "/common.glslh",
+		"#define COMMON 1\n"));
+	// relative to the including file; repeated includes are skipped; no trailing newline
+	CHECK(write_file(dir + "/sub/leaf.glslh",
+		"#include \"../common.glslh\"\n"
+		"#include \"../common.glslh\"\n"
+		"#define LEAF 1"));
+	CHECK(write_file(bad_name,
+		"#include <common.glslh>\n"));
+	CHECK(write_file(missing_name,
+		"#include \"nonexistent.glslh\"\n"));
+
+	const util::ShaderSource* const src = util::preprocessShader(main_name.c_str(), "#define FOO 1\n");
+	CHECK(0 != src);
+
+	if (0 != src) {
+		const std::string expected =
+#if PLATFORM_GLES
+			"#version 100\n"
+#else
+			"#version 150\n"
+#endif
+			"#define FOO 1\n"
+			"#line 1 1\n"
+			"// main\n"
+			"#line 1 2\n"
+			"#define COMMON 1\n"
+			"#line 3 1\n"
+			"#line 1 3\n"
+			"\n"
+			"\n"
+			"#define LEAF 1\n"
+			"#line 4 1\n"
+			"void main() {}\n";
+
+		CHECK(concat_source(*src) == expected);
+		CHECK(4 == src->getFileCount());
+		CHECK(main_name == src->getFile(1));
+		CHECK(dir + "/common.glslh" == src->getFile(2));
+		CHECK(dir + "/sub/leaf.glslh" == src->getFile(3));
+
+		// cached by file name and defines
+		CHECK(src == util::preprocessShader(main_name.c_str(), "#define FOO 1\n"));
+
+		const util::ShaderSource* const src_other = util::preprocessShader(main_name.c_str(), "#define FOO 2\n");
+		CHECK(0 != src_other && src != src_other && src->getHash() != src_other->getHash());
+	}
+
+	// expect the respective complaints on stderr
+	CHECK(0 == util::preprocessShader(bad_name.c_str(), ""));
+	CHECK(0 == util::preprocessShader(missing_name.c_str(), ""));
+
+	util::clearShaderCache();
+
+	unlink(main_name.c_str());
+	unlink(bad_name.c_str());
+	unlink(missing_name.c_str());
+	unlink((dir + "/common.glslh").c_str());
+	unlink((dir + "/sub/leaf.glslh").c_str());
+	rmdir((dir + "/sub").c_str());
+	rmdir(dirname);
+}
+
+void check_spec_constants()
+{
+	util::SpecConstants spec;
+	spec.set("W", 0.f).set("EXP", 64.f).set("HALF", -.5f).set("COUNT", 3).set("NEG", -2).set("TINY", 1e-20f);
+
+	CHECK(spec.getDefines() ==
+		"#define SPEC_W 0.0\n"
+		"#define SPEC_EXP 64.0\n"
+		"#define SPEC_HALF (-0.5)\n"
+		"#define SPEC_COUNT 3\n"
+		"#define SPEC_NEG (-2)\n"
+		"#define SPEC_TINY 9.99999968e-21\n");
+
+	// literals read back as the very same floats
+	const float value = 0.1f;
+	util::SpecConstants spec_exact;
+	spec_exact.set("X", value);
+
+	const std::string& defines = spec_exact.getDefines();
+	CHECK(value == strtof(defines.c_str() + defines.find(' ', 8) + 1, 0));
+}
+
+void check_shader_permutations()
+{
+	static const char* const feature_name[] = { "a", "b", "c" };
+	static const char* const feature_macro[] = { "FEATURE_A", "FEATURE_B", "FEATURE_C" };
+
+	// all required features, nothing beyond the desired ones; required counts as desired
+	CHECK(util::ShaderPermutations::within(3, 1, 2));
+	CHECK(util::ShaderPermutations::within(1, 1, 2));
+	CHECK(util::ShaderPermutations::within(1, 1, 0));
+	CHECK(!util::ShaderPermutations::within(2, 1, 2));
+	CHECK(!util::ShaderPermutations::within(5, 1, 2));
+
+	util::ShaderPermutations perm(3, feature_name, feature_macro);
+
+	CHECK(8 == perm.getVariantCount());
+	CHECK(perm.getDefines(5) == "#define FEATURE_A 1\n#define FEATURE_B 0\n#define FEATURE_C 1\n");
+	CHECK(perm.getName(5) == "a+c");
+	CHECK(perm.getName(0) == "none");
+	CHECK(-1U == perm.select(0, 7, -1.0));
+
+	for (unsigned mask = 0; mask < perm.getVariantCount(); ++mask)
+		perm.setBuilt(mask);
+
+	// a negative budget admits any cost, known or not: the richest variant within the masks
+	CHECK(7 == perm.select(0, 7, -1.0));
+	CHECK(3 == perm.select(1, 2, -1.0));
+	CHECK(0 == perm.select(0, 0, -1.0));
+
+	// unknown costs fit no finite budget; with no cost known, the fallback is the richest variant
+	CHECK(7 == perm.select(0, 7, 10.0));
+
+	static const double cost[] = { 1.0, 2.0, 3.0, 5.0, 1.5, 4.0, 6.0, 9.0 };
+
+	for (unsigned mask = 0; mask < perm.getVariantCount(); ++mask)
+		perm.setCost(mask, cost[mask]);
+
+	// the richest variant under budget, the cheapest among equally rich ones
+	CHECK(7 == perm.select(0, 7, 10.0));
+	CHECK(5 == perm.select(0, 7, 5.0));
+	CHECK(4 == perm.select(0, 7, 2.5));
+	CHECK(1 == perm.select(1, 0, 2.0));
+
+	// nothing fits: the cheapest variant within the masks
+	CHECK(0 == perm.select(0, 7, 0.5));
+	CHECK(1 == perm.select(1, 0, 0.5));
+	CHECK(3 == perm.select(3, 0, 0.5));
+
+	// an unknown cost is never the cheapest, nor does it fit
+	perm.setCost(0, -1.0);
+	CHECK(4 == perm.select(0, 7, 0.5));
+	CHECK(4 == perm.select(0, 7, 1.5));
+
+	// among equally rich variants, a known cost beats an unknown one under any budget
+	util::ShaderPermutations pair(3, feature_name, feature_macro);
+	pair.setBuilt(1);
+	pair.setBuilt(4);
+	pair.setCost(4, 2.0);
+
+	CHECK(4 == pair.select(0, 7, -1.0));
+	CHECK(4 == pair.select(0, 7, 1.0));
+}
+
+void check_get_buffer_from_file()
+{
+	char filename[] = "/tmp/bench_cpu_XXXXXX";
+	const int fd = mkstemp(filename);
+
+	CHECK(-1 != fd);
+
+	if (-1 == fd)
+		return;
+
+	const char content[] = "0123456789abc";
+	const size_t content_len = sizeof(content) - 1;
+	CHECK(ssize_t(content_len) == write(fd, content, content_len));
+	close(fd);
+
+	size_t size = 0;
+	char* buffer = util::get_buffer_from_file(filename, size);
+
+	CHECK(0 != buffer);
+	CHECK(content_len == size);
+	CHECK(0 != buffer && !memcmp(buffer, content, content_len));
+	free(buffer);
+
+	// rounding up the allocation keeps the reported size
+	buffer = util::get_buffer_from_file(filename, size, 16);
+
+	CHECK(0 != buffer);
+	CHECK(content_len == size);
+	free(buffer);
+
+	unlink(filename);
+
+	// missing and non-regular files fail - expect the respective complaints on stderr
+	CHECK(0 == util::get_buffer_from_file(filename, size));
+	CHECK(0 == util::get_buffer_from_file("/tmp", size));
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// microbenchmarks
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct BenchState
+{
+	std::vector< Vertex > arr;
+	std::vector< uint16_t > idx;
+	std::vector< util::pix > pix;
+	std::string shader;
+	std::vector< std::string > patch;
+};
+
+BenchState g_state;
+
+void bench_sphere_verts(const unsigned reps)
+{
+	for (unsigned i = 0; i < reps; ++i) {
+		util::fillPolarSphereVerts(&g_state.arr[0], sphere_rows, sphere_cols, 1.f, 1.f);
+		g_sink += uint32_t(g_state.arr[i % g_state.arr.size()].pos[0] * 1e3f);
+	}
+}
+
+void bench_sphere_indices(const unsigned reps)
+{
+	for (unsigned i = 0; i < reps; ++i) {
+		util::fillPolarSphereIndices(reinterpret_cast< uint16_t(*)[3] >(&g_state.idx[0]), sphere_rows, sphere_cols);
+		g_sink += g_state.idx[i % g_state.idx.size()];
+	}
+}
+
+void bench_matx3_rotate(const unsigned reps)
+{
+	float acc = 0.f;
+
+	for (unsigned i = 0; i < reps; ++i) {
+		const util::matx3 m = util::matx3_rotate(float(i) * 1e-3f, 0.f, 1.f, 0.f);
+		acc += m[0][0];
+	}
+
+	g_sink += uint32_t(acc);
+}
+
+void bench_matx3_mul(const unsigned reps)
+{
+	// app_sphere's per-frame transform: three rotations, two products
+	float acc = 0.f;
+
+	for (unsigned i = 0; i < reps; ++i) {
+		const float a = float(i) * 1e-3f;
+		const util::matx3 r0 = util::matx3_rotate(a - M_PI_2, 1.f, 0.f, 0.f);
+		const util::matx3 r1 = util::matx3_rotate(a,          0.f, 1.f, 0.f);
+		const util::matx3 r2 = util::matx3_rotate(a,          0.f, 0.f, 1.f);
+		const util::matx3 p1 = util::matx3_mul(util::matx3_mul(r0, r1), r2);
+		acc += p1[2][1];
+	}
+
+	g_sink += uint32_t(acc);
+}
+
+void bench_integral_size(const unsigned reps)
+{
+	size_t acc = 0;
+
+	for (unsigned i = 0; i < reps; ++i)
+		acc += util::integral_size(i + (g_sink & 1));
+
+	g_sink += uint32_t(acc);
+}
+
+void bench_fill_with_checker(const unsigned reps)
+{
+	const unsigned dim = 256;
+
+	for (unsigned i = 0; i < reps; ++i) {
+		util::fill_with_checker(&g_state.pix[0], dim * sizeof(util::pix), dim, dim);
+		g_sink += g_state.pix[i % g_state.pix.size()].c[0];
+	}
+}
+
+void bench_patch_string(const unsigned reps)
+{
+	for (unsigned i = 0; i < reps; ++i) {
+		std::string str(g_state.shader);
+		g_sink += uint32_t(util::patchString(str, g_state.patch.size() / 2, &g_state.patch[0]));
+	}
+}
+
+void bench_preprocess_shader(const unsigned reps)
+{
+	// cold: load and scan the files anew each time
+	for (unsigned i = 0; i < reps; ++i) {
+		util::clearShaderCache();
+		const util::ShaderSource* const src = util::preprocessShader(shader_filename, "#define FOO 1\n");
+		g_sink += 0 != src ? uint32_t(src->count()) : 0;
+	}
+}
+
+void bench_preprocess_shader_cached(const unsigned reps)
+{
+	for (unsigned i = 0; i < reps; ++i) {
+		const util::ShaderSource* const src = util::preprocessShader(shader_filename, "#define FOO 1\n");
+		g_sink += 0 != src ? uint32_t(src->count()) : 0;
+	}
+}
+
+void bench_get_buffer_from_file(const unsigned reps)
+{
+	for (unsigned i = 0; i < reps; ++i) {
+		size_t size;
+		char* const buffer = util::get_buffer_from_file(raw_filename, size, util::integral_size(sizeof(util::pix)));
+
+		g_sink += 0 != buffer ? uint32_t(buffer[size / 2]) : 0;
+		free(buffer);
+	}
+}
+
+bool setup_bench_state()
+{
+	g_state.arr.resize(util::polarSphereNumVerts(sphere_rows, sphere_cols));
+	g_state.idx.resize(util::polarSphereNumTris(sphere_rows, sphere_cols) * 3);
+	g_state.pix.resize(256 * 256);
+
+	if (!read_file(shader_filename, g_state.shader))
+		return false;
+
+	// the version-line patches shaders used before the preprocessor
+	g_state.patch.push_back("///essl ");
+	g_state.patch.push_back("");
+	g_state.patch.push_back("///glsl ");
+	g_state.patch.push_back("#version 100\n");
+
+	return true;
+}
+
+struct Bench {
+	const char* name;
+	void (* fn)(const unsigned reps);
+};
+
+const Bench bench[] = {
+	{ "polar_sphere_verts",   bench_sphere_verts },
+	{ "polar_sphere_indices", bench_sphere_indices },
+	{ "matx3_rotate",         bench_matx3_rotate },
+	{ "matx3_mul",            bench_matx3_mul },
+	{ "integral_size",        bench_integral_size },
+	{ "fill_with_checker",    bench_fill_with_checker },
+	{ "patch_string",         bench_patch_string },
+	{ "preprocess_shader",    bench_preprocess_shader },
+	{ "preprocess_cached",    bench_preprocess_shader_cached },
+	{ "get_buffer_from_file", bench_get_buffer_from_file }
+};
+
+// time batches of reps, the batch size calibrated to span at least min_batch_ns, to keep the clock
+// granularity and the call overhead out of the per-op figures
+void run_bench(
+	const Bench& b,
+	const unsigned warmup,
+	const unsigned batches,
+	const uint64_t min_batch_ns)
+{
+	unsigned reps = 1;
+
+	for (;;) {
+		const uint64_t t0 = util::time_ns();
+		b.fn(reps);
+		const uint64_t dt = util::time_ns() - t0;
+
+		if (dt >= min_batch_ns || reps >= 1U << 30)
+			break;
+
+		reps *= 2;
+	}
+
+	for (unsigned i = 0; i < warmup; ++i)
+		b.fn(reps);
+
+	std::vector< double > sample(batches);
+
+	for (unsigned i = 0; i < batches; ++i) {
+		const uint64_t t0 = util::time_ns();
+		b.fn(reps);
+		sample[i] = double(util::time_ns() - t0) / reps;
+	}
+
+	util::BenchStats stats;
+	util::reduceSamples(sample, stats);
+
+	util::BenchRecord()
+		.param("name", b.name)
+		.metric("reps_per_batch", reps)
+		.metric("ns_per_op", stats)
+		.emit("cpu");
+}
+
+} // namespace
+
+static const char* arg_checks  = "-checks";
+static const char* arg_filter  = "-filter";
+static const char* arg_warmup  = "-warmup";
+static const char* arg_batches = "-batches";
+static const char* arg_min_ms  = "-min_ms";
+
+int main(
+	int argc,
+	char** argv)
+{
+	bool checks_only = false;
+	const char* filter = 0;
+	unsigned warmup = 3;
+	unsigned batches = 31;
+	unsigned min_ms = 2;
+	bool cli_err = false;
+
+	for (int i = 1; i < argc && !cli_err; ++i) {
+		if (!strcmp(argv[i], arg_checks)) {
+			checks_only = true;
+			continue;
+		}
+
+		if (i + 1 < argc && !strcmp(argv[i], arg_filter)) {
+			filter = argv[++i];
+			continue;
+		}
+
+		if (i + 1 < argc && !strcmp(argv[i], arg_warmup) && 1 == sscanf(argv[i + 1], "%u", &warmup)) {
+			++i;
+			continue;
+		}
+
+		if (i + 1 < argc && !strcmp(argv[i], arg_batches) &&
+			1 == sscanf(argv[i + 1], "%u", &batches) && 0 != batches) {
+			++i;
+			continue;
+		}
+
+		if (i + 1 < argc && !strcmp(argv[i], arg_min_ms) &&
+			1 == sscanf(argv[i + 1], "%u", &min_ms) && 0 != min_ms) {
+			++i;
+			continue;
+		}
+
+		cli_err = true;
+	}
+
+	if (cli_err) {
+		fprintf(stderr, "usage: %s [options]\n"
+			"\t%s\t\t: run the unit checks only\n"
+			"\t%s <substr>\t: run only the microbenchmarks whose name contains the given substring\n"
+			"\t%s <n>\t\t: use the specified number of warmup batches per microbenchmark\n"
+			"\t%s <n>\t: use the specified number of measured batches per microbenchmark\n"
+			"\t%s <n>\t\t: calibrate batches to span at least the specified number of ms\n",
+			argv[0], arg_checks, arg_filter, arg_warmup, arg_batches, arg_min_ms);
+		return 1;
+	}
+
+	check_polar_sphere();
+	check_polar_sphere_tangents();
+	check_matx3();
+	check_integral_size();
+	check_fill_with_checker();
+	check_patch_string();
+	check_preprocess_shader();
+	check_spec_constants();
+	check_shader_permutations();
+	check_get_buffer_from_file();
+
+	fprintf(stderr, "checks: %u, failed: %u\n", g_num_checks, g_num_failed);
+
+	if (0 != g_num_failed)
+		return 1;
+
+	if (checks_only)
+		return 0;
+
+	if (!setup_bench_state()) {
+		fprintf(stderr, "failed to set up the microbenchmarks; run from the repo root\n");
+		return 1;
+	}
+
+	for (size_t i = 0; i < sizeof(bench) / sizeof(bench[0]); ++i)
+		if (0 == filter || 0 != strstr(bench[i].name, filter))
+			run_bench(bench[i], warmup, batches, min_ms * 1000000ULL);
+
+	return 0;
+}
@@ -10,6 +10,7 @@ SOURCE=(
 	eglapp.cpp
 	hello.cpp
 	util_file.cpp
+	util_bench.cpp
 )
 CFLAGS=(
 	-o ${TARGET}
@@ -24,12 +25,28 @@ CFLAGS=(
 	-DANDROID
 	-DPLATFORM_GLES
 	-DPLATFORM_GL_OES_vertex_array_object
+	-DPLATFORM_GL_OES_get_program_binary
 )
 if [[ $1 == "guest" ]]; then
+	# guest app to build, by source name sans extension; app_sphere unless specified
+	GUEST_APP=${2:-app_sphere}
 	SOURCE+=(
 		util_tex.cpp
 		util_misc.cpp
-		app_sphere.cpp
+		util_preproc.cpp
+		util_progcache.cpp
+		util_permute.cpp
+		util_watch.cpp
+		rendDrawList.cpp
+		rendVertLayout.cpp
+		rendVertArray.cpp
+		rendInstancing.cpp
+		rendUniformBlock.cpp
+		rendRenderPass.cpp
+		rendFrameGraph.cpp
+		rendOverdraw.cpp
+		util_mesh.cpp
+		${GUEST_APP}.cpp
 	)
 	CFLAGS+=(
 		-DGUEST_APP
@@ -80,9 +97,38 @@ elif [[ $HOSTTYPE == "x86_64" || $HOSTTYPE == "i686" ]]; then
 
 fi
 
+# with GLSL_OPTIMIZER set to a built checkout of glsl-optimizer, run every permutation of the sphere
+# shaders through it, into ${RESOURCE}/opt, for app_sphere -app optimized 1
+if [[ $1 == "guest" && -n $GLSL_OPTIMIZER ]]; then
+	SHADER_OPT_TOOL=${RESOURCE}/shader-opt
+	SHADER_OPT_DIR=${RESOURCE}/opt
+
+	g++ -O2 -I./include -I${GLSL_OPTIMIZER}/src/glsl -DANDROID -DPLATFORM_GLES -o ${SHADER_OPT_TOOL} shader_opt.cpp \
+		util_preproc.cpp util_permute.cpp util_file.cpp util_misc.cpp -L${GLSL_OPTIMIZER} \
+		-lglsl_optimizer -lglcpp-library -lmesa ${DEPEND[1]} || exit 1
+
+	mkdir -p ${SHADER_OPT_DIR} && ${SHADER_OPT_TOOL} \
+		${RESOURCE}/phong_bump_tang.glslv \
+		${RESOURCE}/phong_bump_tang.glslf \
+		${SHADER_OPT_DIR} \
+		FEATURE_TCOORD_TANGENT,FEATURE_MESH_NORMAL,FEATURE_ALBEDO_MAP,FEATURE_VERTEX_TANGENT
+	STATUS=$?
+	rm -f ${SHADER_OPT_TOOL}
+
+	if [[ $STATUS != 0 ]]; then
+		exit $STATUS
+	fi
+fi
+
 BUILD_CMD=${SOURCE[@]}" "${CFLAGS[@]}" "${DEPEND[@]}
 echo $CC $BUILD_CMD
 
+# CLICK=0 builds the binary in place and skips packaging - used by bench.sh
+if [[ $CLICK == "0" ]]; then
+	"$CC" $BUILD_CMD
+	exit $?
+fi
+
 "$CC" $BUILD_CMD && click build ${RESOURCE} && pkcon install-local --allow-untrusted ${CLICK_PACKAGE}
 
 if [ -f $TARGET ]; then
@@ -436,7 +436,7 @@ static bool reportEGLCaps(
 	return true;
 }
 
-bool eglapp_init(int argc, char **argv)
+bool eglapp_init(int argc, char **argv, bool depth)
 {
 	MirSurfaceParameters surfParam = {
 		"eglappsurface",
@@ -501,8 +501,8 @@ bool eglapp_init(int argc, char **argv)
 		EGL_GREEN_SIZE, 8,
 		EGL_BLUE_SIZE, 8,
 		EGL_ALPHA_SIZE, 0,
-		EGL_DEPTH_SIZE, 24,
-		EGL_STENCIL_SIZE, 8,
+		EGL_DEPTH_SIZE, depth ? 24 : 0,
+		EGL_STENCIL_SIZE, depth ? 8 : 0,
 		EGL_SAMPLES, 0,
 		EGL_SURFACE_TYPE, EGL_WINDOW_BIT,
 		EGL_RENDERABLE_TYPE, EGL_OPENGL_ES2_BIT,
@@ -518,6 +518,14 @@ bool eglapp_init(int argc, char **argv)
 	ok = eglChooseConfig(display, configAttribs, config, configCount, &configCount);
 	CHECK(ok, "Could not eglChooseConfig (2)");
 
+	// sizes are minimums - a config can come with more than asked for
+	EGLint depthSize = 0;
+	EGLint stencilSize = 0;
+	eglGetConfigAttrib(display, config[0], EGL_DEPTH_SIZE, &depthSize);
+	eglGetConfigAttrib(display, config[0], EGL_STENCIL_SIZE, &stencilSize);
+
+	fprintf(stdout, "egl config: depth %d bits, stencil %d bits\n", depthSize, stencilSize);
+
 	const EGLint contextAttribs[] = {
 		EGL_CONTEXT_CLIENT_VERSION, 2,
 		EGL_NONE
@@ -22,7 +22,9 @@
 #ifndef __EGLAPP_H__
 #define __EGLAPP_H__
 
-bool eglapp_init(int argc, char **argv);
+// depth: whether the surface gets a depth buffer, and a stencil buffer along with it - the two
+// share a packed buffer on most hardware
+bool eglapp_init(int argc, char **argv, bool depth = true);
 void eglapp_swap_buffers(void);
 bool eglapp_running(void);
 void eglapp_shutdown(void);
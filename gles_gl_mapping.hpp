@@ -17,6 +17,12 @@
 #define GL_RGB565 GL_RGB5
 #endif
 
+#if !defined(GL_COLOR_EXT)
+#define GL_COLOR_EXT   GL_COLOR
+#define GL_DEPTH_EXT   GL_DEPTH
+#define GL_STENCIL_EXT GL_STENCIL
+#endif
+
 // desktop GL has had VAOs in GL Core since version 3.0
 #if PLATFORM_GL_OES_vertex_array_object == 0
 	#define PLATFORM_GL_OES_vertex_array_object 1
@@ -26,6 +32,14 @@
 #define glGenVertexArraysOES    glGenVertexArrays
 #define glIsVertexArrayOES      glIsVertexArray
 
+// and instanced arrays since version 3.3
+#define glVertexAttribDivisorEXT   glVertexAttribDivisor
+#define glDrawElementsInstancedEXT glDrawElementsInstanced
+
+#if !defined(GL_VERTEX_ATTRIB_ARRAY_DIVISOR_EXT)
+#define GL_VERTEX_ATTRIB_ARRAY_DIVISOR_EXT GL_VERTEX_ATTRIB_ARRAY_DIVISOR
+#endif
+
 #if GL_ARB_debug_output != 0
 #define glDebugMessageControlKHR  glDebugMessageControlARB
 #define glDebugMessageInsertKHR   glDebugMessageInsertARB
@@ -28,11 +28,14 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <stdlib.h>
+#include <sys/resource.h>
+#include <EGL/egl.h>
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 
 #include "eglapp.h"
 #include "util_file.hpp"
+#include "util_bench.hpp"
 #if GUEST_APP
 #include "util_misc.hpp"
 #endif
@@ -126,6 +129,120 @@ static bool reportGLCaps(FILE* f)
 	return true;
 }
 
+static void fputs_json_string(
+	const char* str,
+	FILE* f)
+{
+	fputc('"', f);
+
+	for (; str && *str; ++str) {
+		if (*str == '"' || *str == '\\')
+			fputc('\\', f);
+
+		if (*str >= ' ')
+			fputc(*str, f);
+	}
+
+	fputc('"', f);
+}
+
+// single-line json digest of the EGL and GL caps, prefixed for the benchmark runner to pick up
+static bool reportCapsRecord(FILE* f)
+{
+	const EGLDisplay display = eglGetCurrentDisplay();
+	const EGLContext context = eglGetCurrentContext();
+
+	if (EGL_NO_DISPLAY == display || EGL_NO_CONTEXT == context)
+		return false;
+
+	fputs("caps-record: {\"egl\":{\"version\":", f);
+	fputs_json_string(eglQueryString(display, EGL_VERSION), f);
+	fputs(",\"vendor\":", f);
+	fputs_json_string(eglQueryString(display, EGL_VENDOR), f);
+	fputs(",\"extensions\":", f);
+	fputs_json_string(eglQueryString(display, EGL_EXTENSIONS), f);
+
+	EGLint config_id = 0;
+	EGLint num_config = 0;
+	EGLConfig config;
+
+	eglQueryContext(display, context, EGL_CONFIG_ID, &config_id);
+	const EGLint config_attr[] = { EGL_CONFIG_ID, config_id, EGL_NONE };
+
+	if (EGL_TRUE == eglChooseConfig(display, config_attr, &config, 1, &num_config) && 1 == num_config) {
+		static const struct {
+			EGLint attr;
+			const char* name;
+		} attr[] = {
+			{ EGL_CONFIG_ID,    "config_id" },
+			{ EGL_RED_SIZE,     "red_size" },
+			{ EGL_GREEN_SIZE,   "green_size" },
+			{ EGL_BLUE_SIZE,    "blue_size" },
+			{ EGL_ALPHA_SIZE,   "alpha_size" },
+			{ EGL_DEPTH_SIZE,   "depth_size" },
+			{ EGL_STENCIL_SIZE, "stencil_size" },
+			{ EGL_SAMPLES,      "samples" }
+		};
+
+		for (unsigned i = 0; i < sizeof(attr) / sizeof(attr[0]); ++i) {
+			EGLint value = 0;
+			eglGetConfigAttrib(display, config, attr[i].attr, &value);
+			fprintf(f, ",\"%s\":%d", attr[i].name, value);
+		}
+	}
+
+	fputs("},\"gl\":{\"version\":", f);
+	fputs_json_string((const char*) glGetString(GL_VERSION), f);
+	fputs(",\"vendor\":", f);
+	fputs_json_string((const char*) glGetString(GL_VENDOR), f);
+	fputs(",\"renderer\":", f);
+	fputs_json_string((const char*) glGetString(GL_RENDERER), f);
+	fputs(",\"glsl_version\":", f);
+	fputs_json_string((const char*) glGetString(GL_SHADING_LANGUAGE_VERSION), f);
+	fputs(",\"extensions\":", f);
+	fputs_json_string((const char*) glGetString(GL_EXTENSIONS), f);
+
+	static const struct {
+		GLenum pname;
+		const char* name;
+	} param[] = {
+		{ GL_MAX_TEXTURE_SIZE,                 "max_texture_size" },
+		{ GL_MAX_CUBE_MAP_TEXTURE_SIZE,        "max_cube_map_texture_size" },
+		{ GL_MAX_RENDERBUFFER_SIZE,            "max_renderbuffer_size" },
+		{ GL_MAX_VERTEX_ATTRIBS,               "max_vertex_attribs" },
+		{ GL_MAX_VERTEX_UNIFORM_VECTORS,       "max_vertex_uniform_vectors" },
+		{ GL_MAX_VARYING_VECTORS,              "max_varying_vectors" },
+		{ GL_MAX_FRAGMENT_UNIFORM_VECTORS,     "max_fragment_uniform_vectors" },
+		{ GL_MAX_COMBINED_TEXTURE_IMAGE_UNITS, "max_combined_texture_image_units" },
+		{ GL_MAX_VERTEX_TEXTURE_IMAGE_UNITS,   "max_vertex_texture_image_units" },
+		{ GL_MAX_TEXTURE_IMAGE_UNITS,          "max_texture_image_units" }
+	};
+
+	for (unsigned i = 0; i < sizeof(param) / sizeof(param[0]); ++i) {
+		GLint value = 0;
+		glGetIntegerv(param[i].pname, &value);
+		fprintf(f, ",\"%s\":%d", param[i].name, value);
+	}
+
+	fputs("}}\n", f);
+	fflush(f);
+	return true;
+}
+
+uint64_t time_ns()
+{
+#if defined(CLOCK_MONOTONIC_RAW)
+	const clockid_t clockid = CLOCK_MONOTONIC_RAW;
+
+#else
+	const clockid_t clockid = CLOCK_MONOTONIC;
+
+#endif
+	timespec t;
+	clock_gettime(clockid, &t);
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+
 } // namespace util
 
 /*
@@ -262,20 +379,6 @@ static int make_resources(void)
 	return 1;
 }
 
-static uint64_t time_ns()
-{
-#if defined(CLOCK_MONOTONIC_RAW)
-	const clockid_t clockid = CLOCK_MONOTONIC_RAW;
-
-#else
-	const clockid_t clockid = CLOCK_MONOTONIC;
-
-#endif
-	timespec t;
-	clock_gettime(clockid, &t);
-	return t.tv_sec * 1000000000ULL + t.tv_nsec;
-}
-
 static void update_blend_factor(void)
 {
 	struct timespec t;
@@ -312,17 +415,38 @@ static void render(void)
 	glDisableVertexAttribArray(g_resources.attributes.position);
 }
 
+// frame-time samples kept for the host record; the most recent ones if the run goes beyond that
+static const size_t max_frame_samples = 1 << 16;
+
+// leading frames reported on their own, as that is where deferred shader compilation and other
+// first-use costs show up
+static const size_t num_first_frames = 16;
+
 int main(int argc, char **argv)
 {
+	const uint64_t t_start = util::time_ns();
+
+#if GUEST_APP
+	// app options come first, as they decide whether the surface gets a depth buffer
+	if (!hook::parse_cli(argc, argv))
+		return 1;
+
+	if (!eglapp_init(argc, argv, hook::requires_depth()))
+		return 1;
+
+#else
 	if (!eglapp_init(argc, argv))
 		return 1;
 
+#endif
+
 	util::reportGLCaps(stdout);
+	util::reportCapsRecord(stdout);
 
 	fprintf(stderr, "make resources..\n");
 
 #if GUEST_APP
-	if (!hook::init_resources(argc, argv)) {
+	if (!hook::init_resources()) {
 		fprintf(stderr, "Failed to load resources\n");
 		return 1;
 	}
@@ -335,13 +459,21 @@ int main(int argc, char **argv)
 
 #endif
 	size_t frameCount = 0;
-	const uint64_t t0 = time_ns();
+	const uint64_t t0 = util::time_ns();
+
+	std::vector< double > frame_ms;
+	frame_ms.reserve(max_frame_samples);
+	std::vector< double > first_ms;
+	first_ms.reserve(num_first_frames);
+	uint64_t t_startup = 0;
+	uint64_t t_last = t0;
 
 	while (eglapp_running()) {
 		glViewport(GLint(0), GLint(0), GLsizei(eglapp_target_width()), GLsizei(eglapp_target_height()));
 
 #if GUEST_APP
-		hook::render_frame();
+		if (!hook::render_frame())
+			break;
 
 #else
 		update_blend_factor();
@@ -349,14 +481,51 @@ int main(int argc, char **argv)
 
 #endif
 		eglapp_swap_buffers();
+
+		// startup spans from process entry to the first frame swapped; the frame times that follow
+		// are swap to swap; the first frames are timed from the end of resource init on
+		const uint64_t t_swap = util::time_ns();
+
+		if (frameCount < num_first_frames)
+			first_ms.push_back((t_swap - t_last) * 1e-6);
+
+		if (0 == frameCount)
+			t_startup = t_swap - t_start;
+		else if (frame_ms.size() < max_frame_samples)
+			frame_ms.push_back((t_swap - t_last) * 1e-6);
+		else
+			frame_ms[(frameCount - 1) % max_frame_samples] = (t_swap - t_last) * 1e-6;
+
+		t_last = t_swap;
 		frameCount++;
 	}
 
-	const double dt = (time_ns() - t0) * 1e-9;
+	const double dt = (util::time_ns() - t0) * 1e-9;
 
 	fprintf(stdout, "elapsed %f s, frames %llu, fps %f\n",
 		dt, uint64_t(frameCount),  frameCount / dt);
 
+	// host record, for the perf-regression baselines: startup time, frame-time stats and peak memory
+	util::BenchRecord record;
+	record
+		.param("width", eglapp_target_width())
+		.param("height", eglapp_target_height())
+		.metric("startup_ms", t_startup * 1e-6)
+		.metric("frames", frameCount);
+
+	util::BenchStats stats;
+	if (util::reduceSamples(frame_ms, stats))
+		record.metric("frame_ms", stats);
+
+	if (util::reduceSamples(first_ms, stats))
+		record.metric("first_frames_ms", stats);
+
+	struct rusage usage;
+	if (0 == getrusage(RUSAGE_SELF, &usage))
+		record.metric("max_rss_kb", usage.ru_maxrss);
+
+	record.emit("host");
+
 #if GUEST_APP
 	hook::deinit_resources();
 
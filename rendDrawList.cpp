@@ -0,0 +1,349 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include "util_misc.hpp"
+#include "pure_macro.hpp"
+#include "rendDrawList.hpp"
+
+namespace rend
+{
+
+DrawList::DrawList()
+: vertex_arrays(0)
+, uniform_blocks(0)
+, instanced_arrays(0)
+, order_first(false)
+{
+}
+
+void DrawList::setVertexArrays(
+	VertexArrays* const arrays)
+{
+	vertex_arrays = arrays;
+}
+
+void DrawList::setUniformBlocks(
+	UniformBlocks* const blocks)
+{
+	uniform_blocks = blocks;
+}
+
+void DrawList::setInstancedArrays(
+	const InstancedArrays* const instanced)
+{
+	instanced_arrays = instanced;
+}
+
+void DrawList::setOrderFirst(
+	const bool order_first)
+{
+	this->order_first = order_first;
+
+	for (size_t i = 0; i < packet.size(); ++i)
+		updateKey(packet[i]);
+}
+
+void DrawList::clear()
+{
+	source.clear();
+	packet.clear();
+	sorted.clear();
+	program_id.clear();
+	texture_set_id.clear();
+}
+
+unsigned DrawList::addVertexSource(
+	const VertexSource& src)
+{
+	assert(0 != src.attr);
+	assert(0 != src.vao || 0 != src.setup);
+	assert(0 == src.vao || 0 != vertex_arrays);
+
+	source.push_back(src);
+	return unsigned(source.size() - 1);
+}
+
+// look up the id of an element, or assign it the next one
+template < typename T >
+static unsigned intern(
+	std::vector< T >& table,
+	const T& elem)
+{
+	const typename std::vector< T >::const_iterator it = std::find(table.begin(), table.end(), elem);
+
+	if (table.end() != it)
+		return unsigned(it - table.begin());
+
+	table.push_back(elem);
+	return unsigned(table.size() - 1);
+}
+
+void DrawList::updateKey(
+	DrawPacket& p)
+{
+	const uint64_t prog = intern(program_id, p.program);
+	const uint64_t tex = intern(texture_set_id,
+		std::vector< GLuint >(p.texture, p.texture + DRAW_PACKET_MAX_TEXTURES));
+
+	assert(prog <= 0xffff && tex <= 0xffff && p.source <= 0xffff);
+
+	if (order_first)
+		p.key = uint64_t(p.order) << 48 | prog << 32 | tex << 16 | p.source;
+	else
+		p.key = prog << 48 | tex << 32 | uint64_t(p.source) << 16 | p.order;
+}
+
+unsigned DrawList::addPacket(
+	const GLuint program,
+	const unsigned source_id,
+	const GLenum mode,
+	const GLsizei count,
+	const GLenum index_type,
+	const uintptr_t index_offset)
+{
+	assert(source_id < source.size());
+
+	DrawPacket p;
+	memset(&p, 0, sizeof(p));
+
+	p.program = program;
+	p.source = source_id;
+	p.mode = mode;
+	p.count = count;
+	p.index_type = index_type;
+	p.index_offset = index_offset;
+
+	updateKey(p);
+	packet.push_back(p);
+
+	return unsigned(packet.size() - 1);
+}
+
+void DrawList::setTexture(
+	const unsigned index,
+	const unsigned unit,
+	const GLuint texture)
+{
+	assert(index < packet.size());
+	assert(unit < DRAW_PACKET_MAX_TEXTURES);
+
+	packet[index].texture[unit] = texture;
+	updateKey(packet[index]);
+}
+
+bool DrawList::setUniform(
+	const unsigned index,
+	const GLint location,
+	const UniformType type,
+	const void* const data)
+{
+	assert(index < packet.size());
+	assert(0 != data);
+
+	if (-1 == location)
+		return true;
+
+	DrawPacket& p = packet[index];
+
+	if (DRAW_PACKET_MAX_UNIFORMS == p.num_uniforms)
+		return false;
+
+	const UniformSlot slot = { location, type, data };
+	p.uniform[p.num_uniforms++] = slot;
+
+	return true;
+}
+
+void DrawList::setBlock(
+	const unsigned index,
+	const UniformFrequency freq,
+	const UniformBlockSource& source)
+{
+	assert(index < packet.size());
+	assert(freq < UNIFORM_FREQ_COUNT);
+	assert(0 != uniform_blocks);
+
+	packet[index].block[freq] = source;
+}
+
+void DrawList::setInstances(
+	const unsigned index,
+	const GLsizei instances)
+{
+	assert(index < packet.size());
+	assert(0 != instanced_arrays && instanced_arrays->isAvailable());
+
+	packet[index].instances = instances;
+}
+
+void DrawList::setOrder(
+	const unsigned index,
+	const uint16_t order)
+{
+	assert(index < packet.size());
+
+	packet[index].order = order;
+	updateKey(packet[index]);
+}
+
+unsigned DrawList::getPacketCount() const
+{
+	return unsigned(packet.size());
+}
+
+void DrawList::bindSource(
+	const unsigned prev,
+	const unsigned next) const
+{
+	assert(next < source.size());
+
+	// arrays enabled outside vertex array objects stay enabled until disabled
+	if (prev < source.size() && 0 == source[prev].vao) {
+		const ActiveAttrSemantics& attr = *source[prev].attr;
+
+		for (unsigned i = 0; i < attr.num_active_attr; ++i)
+			glDisableVertexAttribArray(attr.active_attr[i]);
+	}
+
+	const VertexSource& src = source[next];
+
+	if (0 != src.vao) {
+		vertex_arrays->bind(src.vao);
+		return;
+	}
+
+	if (prev < source.size() && 0 != source[prev].vao)
+		vertex_arrays->bind(0);
+
+	glBindBuffer(GL_ARRAY_BUFFER, src.vbo_arr);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, src.vbo_idx);
+
+	src.setup(*src.attr, 0);
+
+	if (0 != vertex_arrays)
+		vertex_arrays->invalidate();
+
+	for (unsigned i = 0; i < src.attr->num_active_attr; ++i)
+		glEnableVertexAttribArray(src.attr->active_attr[i]);
+}
+
+bool DrawList::submit(
+	DrawStats& stats,
+	const bool sort)
+{
+	memset(&stats, 0, sizeof(stats));
+
+	sorted.resize(packet.size());
+
+	for (size_t i = 0; i < packet.size(); ++i)
+		sorted[i] = std::make_pair(sort ? packet[i].key : uint64_t(i), unsigned(i));
+
+	if (sort)
+		std::sort(sorted.begin(), sorted.end());
+
+	// nothing is known of the state on entry
+	GLuint program = 0;
+	unsigned source_id = -1U;
+	GLuint texture[DRAW_PACKET_MAX_TEXTURES];
+
+	for (unsigned i = 0; i < DRAW_PACKET_MAX_TEXTURES; ++i)
+		texture[i] = 0;
+
+	for (size_t i = 0; i < sorted.size(); ++i) {
+		const DrawPacket& p = packet[sorted[i].second];
+
+		if (p.program != program || 0 == stats.packets) {
+			glUseProgram(p.program);
+			program = p.program;
+			++stats.program_changes;
+		}
+
+		if (p.source != source_id) {
+			bindSource(source_id, p.source);
+			source_id = p.source;
+			++stats.source_changes;
+		}
+
+		for (unsigned j = 0; j < DRAW_PACKET_MAX_TEXTURES; ++j) {
+			if (0 == p.texture[j] || p.texture[j] == texture[j])
+				continue;
+
+			glActiveTexture(GL_TEXTURE0 + j);
+			glBindTexture(GL_TEXTURE_2D, p.texture[j]);
+			texture[j] = p.texture[j];
+			++stats.texture_changes;
+		}
+
+		DEBUG_GL_ERR()
+
+		for (unsigned j = 0; j < p.num_uniforms; ++j) {
+			const UniformSlot& u = p.uniform[j];
+
+			switch (u.type) {
+			case UNIFORM_1I:
+				glUniform1i(u.location, *reinterpret_cast< const GLint* >(u.data));
+				break;
+			case UNIFORM_1F:
+				glUniform1f(u.location, *reinterpret_cast< const GLfloat* >(u.data));
+				break;
+			case UNIFORM_4FV:
+				glUniform4fv(u.location, 1, reinterpret_cast< const GLfloat* >(u.data));
+				break;
+			case UNIFORM_MATRIX4FV:
+				glUniformMatrix4fv(u.location, 1, GL_FALSE, reinterpret_cast< const GLfloat* >(u.data));
+				break;
+			default:
+				assert(false);
+			}
+		}
+
+		stats.uniform_updates += p.num_uniforms;
+
+		if (0 != uniform_blocks) {
+			for (unsigned j = 0; j < UNIFORM_FREQ_COUNT; ++j)
+				if (0 != p.block[j].data)
+					uniform_blocks->setBlock(UniformFrequency(j), p.block[j]);
+
+			stats.uniform_updates += uniform_blocks->apply(p.program);
+		}
+
+		DEBUG_GL_ERR()
+
+		if (0 != p.instances)
+			instanced_arrays->drawElements(p.mode, p.count, p.index_type, p.index_offset, p.instances);
+		else
+			glDrawElements(p.mode, p.count, p.index_type, reinterpret_cast< const GLvoid* >(p.index_offset));
+		++stats.packets;
+
+		DEBUG_GL_ERR()
+	}
+
+	// leave no arrays enabled and no vertex array object bound
+	if (source_id < source.size()) {
+		if (0 == source[source_id].vao) {
+			const ActiveAttrSemantics& attr = *source[source_id].attr;
+
+			for (unsigned i = 0; i < attr.num_active_attr; ++i)
+				glDisableVertexAttribArray(attr.active_attr[i]);
+		}
+		else
+			vertex_arrays->bind(0);
+	}
+
+	return true;
+}
+
+} // namespace rend
@@ -0,0 +1,192 @@
+#ifndef rend_draw_list_H__
+#define rend_draw_list_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+#include <vector>
+#include <utility>
+
+#include "rendVertAttr.hpp"
+#include "rendVertArray.hpp"
+#include "rendInstancing.hpp"
+#include "rendUniformBlock.hpp"
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// DrawList holds draws baked into flat packets - program, vertex source, textures by unit, uniform
+// slots and index range - and submits them in order of a 64-bit state key, binding only what changes
+// from one packet to the next. Uniform lookups that came back -1 get dropped at bake time, so the
+// submit loop sets exactly the uniforms that exist. Uniform slots point at caller-owned data, which
+// the caller updates between submits. Packets can also carry emulated uniform blocks, which go
+// through a UniformBlocks and get uploaded only when changed, and draw a number of instances through
+// an InstancedArrays.
+//
+// Keys hold, from the most significant bits down: program, texture set, vertex source - each a dense
+// id in order of first use - and a caller-supplied order within equal state. Lists of opaque draws
+// sorted front to back can put the order first instead, where fragments rejected early by the depth
+// test save more than the state changes the order costs.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+struct VertexSource
+{
+	GLuint vao;                      // vertex array of the list's VertexArrays, or 0
+	GLuint vbo_arr;                  // without a vertex array object: buffers,
+	GLuint vbo_idx;
+	const ActiveAttrSemantics* attr; // active attributes
+	SetupVertexAttrPointers setup;   // and their setup
+};
+
+enum UniformType {
+	UNIFORM_1I,
+	UNIFORM_1F,
+	UNIFORM_4FV,
+	UNIFORM_MATRIX4FV,
+
+	UNIFORM_FORCE_UINT = -1U
+};
+
+struct UniformSlot
+{
+	GLint location;
+	UniformType type;
+	const void* data;
+};
+
+enum {
+	DRAW_PACKET_MAX_TEXTURES = 4,
+	DRAW_PACKET_MAX_UNIFORMS = 8
+};
+
+struct DrawPacket
+{
+	uint64_t key;
+	GLuint program;
+	unsigned source;
+	GLuint texture[DRAW_PACKET_MAX_TEXTURES]; // 2D textures by unit; 0 for none
+	UniformSlot uniform[DRAW_PACKET_MAX_UNIFORMS];
+	unsigned num_uniforms;
+	UniformBlockSource block[UNIFORM_FREQ_COUNT]; // null data for blocks left as they are
+	GLenum mode;
+	GLsizei count;
+	GLenum index_type;
+	uintptr_t index_offset;
+	GLsizei instances; // 0 for a draw without instanced arrays
+	uint16_t order;
+};
+
+// state changes of a submit
+struct DrawStats
+{
+	unsigned packets;
+	unsigned program_changes;
+	unsigned texture_changes;
+	unsigned source_changes;
+	unsigned uniform_updates;   // uniform calls, including block uploads
+};
+
+class DrawList
+{
+	std::vector< VertexSource > source;
+	std::vector< DrawPacket > packet;
+	std::vector< std::pair< uint64_t, unsigned > > sorted;
+
+	std::vector< GLuint > program_id;
+	std::vector< std::vector< GLuint > > texture_set_id;
+
+	VertexArrays* vertex_arrays;
+	UniformBlocks* uniform_blocks;
+	const InstancedArrays* instanced_arrays;
+
+	bool order_first;
+
+	void updateKey(
+		DrawPacket& p);
+
+	void bindSource(
+		const unsigned prev,
+		const unsigned next) const;
+
+public:
+	DrawList();
+
+	// vertex arrays of the vertex sources that have one
+	void setVertexArrays(
+		VertexArrays* const arrays);
+
+	// uniform blocks of the programs of packets that carry blocks
+	void setUniformBlocks(
+		UniformBlocks* const blocks);
+
+	// instanced arrays of packets that draw instances
+	void setInstancedArrays(
+		const InstancedArrays* const instanced);
+
+	// lead keys with the order of packets rather than with their state; re-keys all packets
+	void setOrderFirst(
+		const bool order_first);
+
+	// drop all packets and vertex sources
+	void clear();
+
+	// return the id of the new vertex source
+	unsigned addVertexSource(
+		const VertexSource& src);
+
+	// bake a draw of indexed primitives; return the index of the new packet
+	unsigned addPacket(
+		const GLuint program,
+		const unsigned source,
+		const GLenum mode,
+		const GLsizei count,
+		const GLenum index_type,
+		const uintptr_t index_offset = 0);
+
+	void setTexture(
+		const unsigned index,
+		const unsigned unit,
+		const GLuint texture);
+
+	// add a uniform slot to a packet, unless the location is -1; return false if the packet is full
+	bool setUniform(
+		const unsigned index,
+		const GLint location,
+		const UniformType type,
+		const void* const data);
+
+	// set a uniform block of a packet
+	void setBlock(
+		const unsigned index,
+		const UniformFrequency freq,
+		const UniformBlockSource& source);
+
+	// draw a packet as the given number of instances, through the list's instanced arrays
+	void setInstances(
+		const unsigned index,
+		const GLsizei instances);
+
+	// order among packets of equal state, or among all packets if the order comes first; e.g. front
+	// to back
+	void setOrder(
+		const unsigned index,
+		const uint16_t order);
+
+	unsigned getPacketCount() const;
+
+	// issue all packets, in key order if sorting, in order of baking otherwise
+	bool submit(
+		DrawStats& stats,
+		const bool sort = true);
+};
+
+} // namespace rend
+
+#endif // rend_draw_list_H__
@@ -0,0 +1,588 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include "util_misc.hpp"
+#include "pure_macro.hpp"
+#include "rendFrameGraph.hpp"
+
+namespace rend
+{
+
+static bool isDepthFormat(
+	const GLenum format)
+{
+	return GL_DEPTH_COMPONENT16 == format;
+}
+
+static uint64_t targetBytes(
+	const TargetDesc& desc)
+{
+	unsigned bytes_per_pixel = 0;
+
+	switch (desc.format) {
+	case GL_RGB:
+		bytes_per_pixel = 3;
+		break;
+	case GL_RGBA:
+		bytes_per_pixel = 4;
+		break;
+	case GL_DEPTH_COMPONENT16:
+		bytes_per_pixel = 2;
+		break;
+	default:
+		assert(false);
+	}
+
+	return uint64_t(desc.width) * uint64_t(desc.height) * bytes_per_pixel;
+}
+
+static bool operator ==(
+	const TargetDesc& a,
+	const TargetDesc& b)
+{
+	return a.width == b.width && a.height == b.height && a.format == b.format;
+}
+
+FrameGraph::FrameGraph()
+: allow_discard(true)
+, compiled(false)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+void FrameGraph::reset()
+{
+	resource.clear();
+	pass.clear();
+	order.clear();
+	compiled = false;
+
+	memset(&stats, 0, sizeof(stats));
+}
+
+void FrameGraph::clear()
+{
+	for (size_t i = 0; i < framebuffer.size(); ++i)
+		glDeleteFramebuffers(1, &framebuffer[i].fbo);
+
+	for (size_t i = 0; i < physical.size(); ++i) {
+		if (isDepthFormat(physical[i].desc.format))
+			glDeleteRenderbuffers(1, &physical[i].name);
+		else
+			glDeleteTextures(1, &physical[i].name);
+	}
+
+	framebuffer.clear();
+	physical.clear();
+	reset();
+}
+
+void FrameGraph::setAllowDiscard(
+	const bool allow)
+{
+	allow_discard = allow;
+}
+
+unsigned FrameGraph::importBackbuffer(
+	const char* const name,
+	const GLsizei width,
+	const GLsizei height)
+{
+	Resource r;
+	r.name = name;
+	r.desc.width = width;
+	r.desc.height = height;
+	r.desc.format = GL_RGBA;
+	r.imported = true;
+	r.writer = -1U;
+	r.physical = -1U;
+	r.first = -1U;
+	r.last = -1U;
+
+	resource.push_back(r);
+	return unsigned(resource.size() - 1);
+}
+
+unsigned FrameGraph::createTarget(
+	const char* const name,
+	const TargetDesc& desc)
+{
+	Resource r;
+	r.name = name;
+	r.desc = desc;
+	r.imported = false;
+	r.writer = -1U;
+	r.physical = -1U;
+	r.first = -1U;
+	r.last = -1U;
+
+	resource.push_back(r);
+	return unsigned(resource.size() - 1);
+}
+
+unsigned FrameGraph::addPass(
+	const char* const name,
+	const ExecutePass execute,
+	void* const context)
+{
+	pass.push_back(Pass());
+	Pass& p = pass.back();
+
+	p.name = name;
+	p.execute = execute;
+	p.context = context;
+	p.color = -1U;
+	p.depth = -1U;
+	p.clear = false;
+	p.side_effect = false;
+	p.culled = false;
+	p.clear_color[0] = 0.f;
+	p.clear_color[1] = 0.f;
+	p.clear_color[2] = 0.f;
+	p.clear_color[3] = 1.f;
+	p.fbo = 0;
+
+	return unsigned(pass.size() - 1);
+}
+
+void FrameGraph::read(
+	const unsigned pass_index,
+	const unsigned resource_index)
+{
+	assert(pass_index < pass.size());
+	assert(resource_index < resource.size());
+
+	// sampled targets are textures
+	assert(!resource[resource_index].imported);
+	assert(!isDepthFormat(resource[resource_index].desc.format));
+
+	pass[pass_index].read.push_back(resource_index);
+	resource[resource_index].reader.push_back(pass_index);
+}
+
+void FrameGraph::write(
+	const unsigned pass_index,
+	const unsigned resource_index,
+	const bool clear)
+{
+	assert(pass_index < pass.size());
+	assert(resource_index < resource.size());
+
+	Pass& p = pass[pass_index];
+	Resource& r = resource[resource_index];
+
+	// a single writer per resource
+	assert(-1U == r.writer);
+	r.writer = pass_index;
+
+	if (isDepthFormat(r.desc.format)) {
+		assert(-1U == p.depth);
+		p.depth = resource_index;
+	}
+	else {
+		assert(-1U == p.color);
+		p.color = resource_index;
+	}
+
+	p.clear = p.clear || clear;
+}
+
+void FrameGraph::setClearColor(
+	const unsigned pass_index,
+	const GLfloat r,
+	const GLfloat g,
+	const GLfloat b,
+	const GLfloat a)
+{
+	assert(pass_index < pass.size());
+
+	pass[pass_index].clear_color[0] = r;
+	pass[pass_index].clear_color[1] = g;
+	pass[pass_index].clear_color[2] = b;
+	pass[pass_index].clear_color[3] = a;
+}
+
+void FrameGraph::setSideEffect(
+	const unsigned pass_index)
+{
+	assert(pass_index < pass.size());
+	pass[pass_index].side_effect = true;
+}
+
+bool FrameGraph::cull()
+{
+	std::vector< unsigned > stack;
+
+	for (size_t i = 0; i < pass.size(); ++i) {
+		Pass& p = pass[i];
+		p.culled = true;
+
+		const bool to_import =
+			(-1U != p.color && resource[p.color].imported) ||
+			(-1U != p.depth && resource[p.depth].imported);
+
+		if (p.side_effect || to_import)
+			stack.push_back(unsigned(i));
+	}
+
+	// keep the passes the kept ones read from, transitively
+	while (!stack.empty()) {
+		Pass& p = pass[stack.back()];
+		stack.pop_back();
+
+		if (!p.culled)
+			continue;
+
+		p.culled = false;
+
+		for (size_t i = 0; i < p.read.size(); ++i) {
+			const unsigned writer = resource[p.read[i]].writer;
+
+			if (-1U == writer) {
+				std::cerr << __FUNCTION__ << " pass '" << p.name << "' reads unwritten target '" <<
+					resource[p.read[i]].name << "'" << std::endl;
+				return false;
+			}
+
+			if (pass[writer].culled)
+				stack.push_back(writer);
+		}
+	}
+
+	stats.passes = unsigned(pass.size());
+	stats.passes_culled = 0;
+
+	for (size_t i = 0; i < pass.size(); ++i)
+		if (pass[i].culled)
+			++stats.passes_culled;
+
+	return true;
+}
+
+bool FrameGraph::sort()
+{
+	// a pass waits for the writers of what it reads; among ready passes, the first declared goes first
+	std::vector< unsigned > wait(pass.size(), 0);
+	size_t num_live = 0;
+
+	for (size_t i = 0; i < pass.size(); ++i) {
+		if (pass[i].culled)
+			continue;
+
+		wait[i] = unsigned(pass[i].read.size());
+		++num_live;
+	}
+
+	std::vector< bool > done(pass.size(), false);
+	order.clear();
+
+	while (order.size() < num_live) {
+		size_t next = 0;
+
+		while (next < pass.size() && (pass[next].culled || done[next] || 0 != wait[next]))
+			++next;
+
+		if (pass.size() == next) {
+			std::cerr << __FUNCTION__ << " found a cycle among passes" << std::endl;
+			return false;
+		}
+
+		done[next] = true;
+		order.push_back(unsigned(next));
+
+		const Pass& p = pass[next];
+		const unsigned out[] = { p.color, p.depth };
+
+		for (unsigned i = 0; i < sizeof(out) / sizeof(out[0]); ++i) {
+			if (-1U == out[i])
+				continue;
+
+			const Resource& r = resource[out[i]];
+
+			for (size_t j = 0; j < r.reader.size(); ++j)
+				if (!pass[r.reader[j]].culled)
+					--wait[r.reader[j]];
+		}
+	}
+
+	return true;
+}
+
+bool FrameGraph::alias()
+{
+	std::vector< unsigned > position(pass.size(), -1U);
+
+	for (size_t i = 0; i < order.size(); ++i)
+		position[order[i]] = unsigned(i);
+
+	// lifetimes of the targets in use, from writer to last reader
+	std::vector< std::pair< unsigned, unsigned > > by_first;
+
+	for (size_t i = 0; i < resource.size(); ++i) {
+		Resource& r = resource[i];
+
+		if (r.imported || -1U == r.writer || pass[r.writer].culled)
+			continue;
+
+		r.first = position[r.writer];
+		r.last = r.first;
+
+		for (size_t j = 0; j < r.reader.size(); ++j)
+			if (!pass[r.reader[j]].culled)
+				r.last = std::max(r.last, position[r.reader[j]]);
+
+		by_first.push_back(std::make_pair(r.first, unsigned(i)));
+	}
+
+	std::sort(by_first.begin(), by_first.end());
+
+	for (size_t i = 0; i < physical.size(); ++i)
+		physical[i].last = -1U;
+
+	std::vector< bool > used(physical.size(), false);
+
+	stats.targets = unsigned(by_first.size());
+	stats.bytes_requested = 0;
+
+	for (size_t i = 0; i < by_first.size(); ++i) {
+		Resource& r = resource[by_first[i].second];
+		size_t j = 0;
+
+		// take a physical target of the same description that is free by the time this one is written
+		while (j < physical.size() && !(physical[j].desc == r.desc && (-1U == physical[j].last || physical[j].last < r.first)))
+			++j;
+
+		if (physical.size() == j) {
+			Physical ph;
+			ph.desc = r.desc;
+			ph.name = 0;
+			ph.last = -1U;
+
+			if (isDepthFormat(r.desc.format)) {
+				glGenRenderbuffers(1, &ph.name);
+				glBindRenderbuffer(GL_RENDERBUFFER, ph.name);
+				glRenderbufferStorage(GL_RENDERBUFFER, r.desc.format, r.desc.width, r.desc.height);
+				glBindRenderbuffer(GL_RENDERBUFFER, 0);
+			}
+			else {
+				glGenTextures(1, &ph.name);
+				glBindTexture(GL_TEXTURE_2D, ph.name);
+				glTexImage2D(GL_TEXTURE_2D, 0, r.desc.format, r.desc.width, r.desc.height, 0,
+					r.desc.format, GL_UNSIGNED_BYTE, 0);
+
+				// sampled at the same extent, or filtered down; NPOT-safe
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+				glBindTexture(GL_TEXTURE_2D, 0);
+			}
+
+			if (util::reportGLError()) {
+				std::cerr << __FUNCTION__ << " failed to allocate target '" << r.name << "'" << std::endl;
+				return false;
+			}
+
+			physical.push_back(ph);
+			used.push_back(false);
+		}
+
+		physical[j].last = r.last;
+		used[j] = true;
+		r.physical = unsigned(j);
+
+		stats.bytes_requested += targetBytes(r.desc);
+	}
+
+	// release what this compile does not use, along with the framebuffers holding it
+	std::vector< Physical > kept;
+	std::vector< unsigned > remap(physical.size(), -1U);
+
+	for (size_t i = 0; i < physical.size(); ++i) {
+		if (used[i]) {
+			remap[i] = unsigned(kept.size());
+			kept.push_back(physical[i]);
+			continue;
+		}
+
+		for (size_t j = 0; j < framebuffer.size(); ++j) {
+			if (framebuffer[j].color != physical[i].name && framebuffer[j].depth != physical[i].name)
+				continue;
+
+			glDeleteFramebuffers(1, &framebuffer[j].fbo);
+			framebuffer.erase(framebuffer.begin() + j--);
+		}
+
+		if (isDepthFormat(physical[i].desc.format))
+			glDeleteRenderbuffers(1, &physical[i].name);
+		else
+			glDeleteTextures(1, &physical[i].name);
+	}
+
+	physical.swap(kept);
+
+	for (size_t i = 0; i < resource.size(); ++i)
+		if (-1U != resource[i].physical)
+			resource[i].physical = remap[resource[i].physical];
+
+	stats.targets_physical = unsigned(physical.size());
+	stats.bytes_peak = 0;
+
+	for (size_t i = 0; i < physical.size(); ++i)
+		stats.bytes_peak += targetBytes(physical[i].desc);
+
+	return true;
+}
+
+GLuint FrameGraph::getFramebuffer(
+	const GLuint color,
+	const GLuint depth)
+{
+	for (size_t i = 0; i < framebuffer.size(); ++i)
+		if (color == framebuffer[i].color && depth == framebuffer[i].depth)
+			return framebuffer[i].fbo;
+
+	Framebuffer fb;
+	fb.color = color;
+	fb.depth = depth;
+	fb.fbo = 0;
+
+	glGenFramebuffers(1, &fb.fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fb.fbo);
+
+	if (0 != color)
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, color, 0);
+
+	if (0 != depth)
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (GL_FRAMEBUFFER_COMPLETE != status) {
+		std::cerr << __FUNCTION__ << " found framebuffer incomplete, status 0x" << std::hex << status << std::dec << std::endl;
+		glDeleteFramebuffers(1, &fb.fbo);
+		return 0;
+	}
+
+	framebuffer.push_back(fb);
+	return fb.fbo;
+}
+
+bool FrameGraph::setupPasses()
+{
+	for (size_t i = 0; i < order.size(); ++i) {
+		Pass& p = pass[order[i]];
+		const bool to_import = -1U != p.color && resource[p.color].imported;
+
+		// the default framebuffer comes with depth and stencil of its own, which no pass declares
+		assert(!to_import || -1U == p.depth);
+
+		p.fbo = 0;
+
+		if (!to_import) {
+			const GLuint color = -1U != p.color ? physical[resource[p.color].physical].name : 0;
+			const GLuint depth = -1U != p.depth ? physical[resource[p.depth].physical].name : 0;
+
+			p.fbo = getFramebuffer(color, depth);
+
+			if (0 == p.fbo) {
+				std::cerr << __FUNCTION__ << " failed at getFramebuffer for pass '" << p.name << "'" << std::endl;
+				return false;
+			}
+		}
+
+		RenderPassDesc desc;
+		desc.fbo = p.fbo;
+		memcpy(desc.clear_color, p.clear_color, sizeof(desc.clear_color));
+		desc.clear_depth = 1.f;
+		desc.clear_stencil = 0;
+
+		const unsigned attachment[ATTACHMENT_COUNT] = { p.color, p.depth, -1U };
+
+		for (unsigned j = 0; j < ATTACHMENT_COUNT; ++j) {
+			desc.load[j] = p.clear ? LOAD_ACTION_CLEAR : LOAD_ACTION_DONT_CARE;
+			desc.store[j] = STORE_ACTION_DISCARD;
+
+			if (-1U == attachment[j])
+				continue;
+
+			const Resource& r = resource[attachment[j]];
+
+			if (r.imported || r.last > r.first)
+				desc.store[j] = STORE_ACTION_STORE;
+		}
+
+		p.pass.init(desc, allow_discard);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return true;
+}
+
+bool FrameGraph::compile()
+{
+	compiled = false;
+
+	if (!cull() || !sort() || !alias() || !setupPasses())
+		return false;
+
+	compiled = true;
+	return true;
+}
+
+bool FrameGraph::execute(
+	RenderPassStats& pass_stats)
+{
+	assert(compiled);
+
+	for (size_t i = 0; i < order.size(); ++i) {
+		Pass& p = pass[order[i]];
+		const Resource& target = resource[-1U != p.color ? p.color : p.depth];
+
+		glViewport(0, 0, target.desc.width, target.desc.height);
+
+		if (!p.pass.begin(target.desc.width, target.desc.height, pass_stats))
+			return false;
+
+		if (!p.execute(*this, p.context))
+			return false;
+
+		if (!p.pass.end(pass_stats))
+			return false;
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	return true;
+}
+
+GLuint FrameGraph::getTexture(
+	const unsigned resource_index) const
+{
+	assert(resource_index < resource.size());
+	const Resource& r = resource[resource_index];
+
+	assert(!r.imported && !isDepthFormat(r.desc.format));
+	assert(-1U != r.physical);
+
+	return physical[r.physical].name;
+}
+
+const FrameGraphStats& FrameGraph::getStats() const
+{
+	return stats;
+}
+
+} // namespace rend
@@ -0,0 +1,193 @@
+#ifndef rend_frame_graph_H__
+#define rend_frame_graph_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <vector>
+
+#include "rendRenderPass.hpp"
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FrameGraph schedules the render passes of a frame from what each pass declares it reads and writes,
+// rather than from hand-managed FBOs. Resources are either imported - the default framebuffer - or
+// transient render targets, which the graph owns: a target is written by exactly one pass, and read,
+// as a texture, by any number of passes after it. Compilation
+//
+// - culls passes that contribute to no imported resource, and to no pass marked as having side
+//	effects, along with the targets only they use;
+// - orders the remaining passes writers-first, keeping the order of declaration where free;
+// - gives each pass its load and store actions: a target gets cleared or not cared about when written,
+//	and stored only if read later - depth gets discarded after its pass;
+// - aliases targets of the same description whose lifetimes, from writer to last reader, do not
+//	overlap, onto the same texture or renderbuffer, drawn from a pool kept across compiles.
+//
+// Executing runs the passes in order, each in a RenderPass over its target, with the viewport set
+// to the target's extent; pass callbacks look up the textures of the targets they read via getTexture.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// transient render target: a color texture of an unsized format - GL_RGB or GL_RGBA, of unsigned bytes
+// - or a depth renderbuffer, GL_DEPTH_COMPONENT16
+struct TargetDesc
+{
+	GLsizei width;
+	GLsizei height;
+	GLenum format;
+};
+
+// compile results
+struct FrameGraphStats
+{
+	unsigned passes;           // declared
+	unsigned passes_culled;
+	unsigned targets;          // transient targets in use
+	unsigned targets_physical; // textures and renderbuffers backing them
+	uint64_t bytes_requested;  // of all transient targets in use, without aliasing
+	uint64_t bytes_peak;       // of the physical targets backing them - all alive at once
+};
+
+class FrameGraph;
+
+// issue the draws of a pass; return false to abort the frame
+typedef bool (*ExecutePass)(
+	const FrameGraph& graph,
+	void* const context);
+
+class FrameGraph
+{
+	struct Resource {
+		const char* name;
+		TargetDesc desc;
+		bool imported;
+		unsigned writer;               // pass index; -1U for none
+		std::vector< unsigned > reader; // pass indices
+		unsigned physical;             // -1U for none
+		unsigned first;                // lifetime, in order positions
+		unsigned last;
+	};
+
+	struct Pass {
+		const char* name;
+		ExecutePass execute;
+		void* context;
+		std::vector< unsigned > read;
+		unsigned color;                // resource index; -1U for none
+		unsigned depth;
+		bool clear;
+		bool side_effect;
+		bool culled;
+		GLfloat clear_color[4];
+		GLuint fbo;
+		RenderPass pass;
+	};
+
+	struct Physical {
+		TargetDesc desc;
+		GLuint name;                   // texture, or renderbuffer for depth
+		unsigned last;                 // last order position of its current occupant; -1U when free
+	};
+
+	struct Framebuffer {
+		GLuint color;
+		GLuint depth;
+		GLuint fbo;
+	};
+
+	std::vector< Resource > resource;
+	std::vector< Pass > pass;
+	std::vector< unsigned > order;     // pass indices, in execution order
+	std::vector< Physical > physical;
+	std::vector< Framebuffer > framebuffer;
+
+	FrameGraphStats stats;
+	bool allow_discard;
+	bool compiled;
+
+	bool cull();
+	bool sort();
+	bool alias();
+	bool setupPasses();
+
+	GLuint getFramebuffer(
+		const GLuint color,
+		const GLuint depth);
+
+public:
+	FrameGraph();
+
+	// drop all passes and resources, keeping the physical targets for the next compile
+	void reset();
+
+	// delete all GL objects; needs a current context
+	void clear();
+
+	// whether pass discards may reach the driver, for the passes set up by the next compile
+	void setAllowDiscard(
+		const bool allow);
+
+	// return the handle of a new imported resource: the default framebuffer, of the given extent
+	unsigned importBackbuffer(
+		const char* const name,
+		const GLsizei width,
+		const GLsizei height);
+
+	// return the handle of a new transient target
+	unsigned createTarget(
+		const char* const name,
+		const TargetDesc& desc);
+
+	// return the index of a new pass; name and context are caller-owned
+	unsigned addPass(
+		const char* const name,
+		const ExecutePass execute,
+		void* const context);
+
+	// declare a pass to sample a target
+	void read(
+		const unsigned pass,
+		const unsigned resource);
+
+	// declare a pass to render to a resource - as color or depth attachment, by its format; a pass
+	// that clears gets a clear load action on all of its attachments, a don't-care one otherwise
+	void write(
+		const unsigned pass,
+		const unsigned resource,
+		const bool clear = false);
+
+	void setClearColor(
+		const unsigned pass,
+		const GLfloat r,
+		const GLfloat g,
+		const GLfloat b,
+		const GLfloat a);
+
+	// keep a pass regardless of its outputs, e.g. a capture
+	void setSideEffect(
+		const unsigned pass);
+
+	// cull, order, alias and set up passes; report failures - e.g. cycles, incomplete framebuffers - on
+	// stderr and return false; needs a current context
+	bool compile();
+
+	// run the compiled passes; leaves the default framebuffer bound
+	bool execute(
+		RenderPassStats& pass_stats);
+
+	// texture of a color target, while executing
+	GLuint getTexture(
+		const unsigned resource) const;
+
+	const FrameGraphStats& getStats() const;
+};
+
+} // namespace rend
+
+#endif // rend_frame_graph_H__
@@ -0,0 +1,93 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+
+#include "util_misc.hpp"
+#include "rendInstancing.hpp"
+
+namespace rend
+{
+
+#if PLATFORM_GLES
+// entry points of GL_EXT_instanced_arrays, or of their GL_ANGLE_instanced_arrays twins
+static PFNGLVERTEXATTRIBDIVISOREXTPROC   glVertexAttribDivisorEXT;
+static PFNGLDRAWELEMENTSINSTANCEDEXTPROC glDrawElementsInstancedEXT;
+
+#endif
+InstancedArrays::InstancedArrays()
+: available(false)
+{
+}
+
+void InstancedArrays::init(
+	const bool allow)
+{
+#if PLATFORM_GL
+	available = allow;
+
+#else
+	available = false;
+
+	if (!allow)
+		return;
+
+	if (util::hasExtension("GL_EXT_instanced_arrays")) {
+		glVertexAttribDivisorEXT   = (PFNGLVERTEXATTRIBDIVISOREXTPROC)   eglGetProcAddress("glVertexAttribDivisorEXT");
+		glDrawElementsInstancedEXT = (PFNGLDRAWELEMENTSINSTANCEDEXTPROC) eglGetProcAddress("glDrawElementsInstancedEXT");
+	}
+	else
+	if (util::hasExtension("GL_ANGLE_instanced_arrays")) {
+		glVertexAttribDivisorEXT   = (PFNGLVERTEXATTRIBDIVISOREXTPROC)   eglGetProcAddress("glVertexAttribDivisorANGLE");
+		glDrawElementsInstancedEXT = (PFNGLDRAWELEMENTSINSTANCEDEXTPROC) eglGetProcAddress("glDrawElementsInstancedANGLE");
+	}
+
+	available = 0 != glVertexAttribDivisorEXT && 0 != glDrawElementsInstancedEXT;
+
+#endif
+}
+
+bool InstancedArrays::isAvailable() const
+{
+	return available;
+}
+
+void InstancedArrays::setDivisor(
+	const GLuint attr,
+	const GLuint divisor) const
+{
+	assert(available);
+	glVertexAttribDivisorEXT(attr, divisor);
+}
+
+GLuint InstancedArrays::getDivisor(
+	const GLuint attr) const
+{
+	if (!available)
+		return 0;
+
+	GLint divisor = 0;
+	glGetVertexAttribiv(attr, GL_VERTEX_ATTRIB_ARRAY_DIVISOR_EXT, &divisor);
+
+	return GLuint(divisor);
+}
+
+void InstancedArrays::drawElements(
+	const GLenum mode,
+	const GLsizei count,
+	const GLenum index_type,
+	const uintptr_t index_offset,
+	const GLsizei instances) const
+{
+	assert(available);
+	glDrawElementsInstancedEXT(mode, count, index_type, reinterpret_cast< const GLvoid* >(index_offset), instances);
+}
+
+} // namespace rend
@@ -0,0 +1,87 @@
+#ifndef rend_instancing_H__
+#define rend_instancing_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Instancing draws a batch of objects, sharing a mesh and material, in a single draw call; each vertex
+// carries the index of its object in the batch, in the index attribute, and the vertex shader reads the
+// object's parameters - e.g. its transform - from a uniform array by that index. Two ways to get there:
+//
+// pseudo-instancing - the mesh gets replicated once per object in a single buffer, with the object
+//	index stored per vertex; any GLES2 does it, at the cost of memory and of batches capped by the
+//	index type, and a batch of n objects draws the first n copies;
+// instanced arrays - with GL_EXT_instanced_arrays or GL_ANGLE_instanced_arrays, a single copy of the
+//	mesh gets drawn once per object, with the object index in its own buffer and an attribute divisor
+//	of 1, so it advances per instance rather than per vertex.
+//
+// Both feed the same shaders. InstancedArrays finds the extension at run time.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// replicate a mesh copies times: vertices verbatim, indices offset by the vertex count of each copy
+template < typename VERTEX_T, typename INDEX_T >
+void replicateMesh(
+	const VERTEX_T* const vert,
+	const size_t num_verts,
+	const INDEX_T* const idx,
+	const size_t num_idx,
+	const unsigned copies,
+	VERTEX_T* const out_vert,
+	INDEX_T* const out_idx)
+{
+	assert(num_verts * copies <= size_t(INDEX_T(-1)) + 1);
+
+	for (unsigned i = 0; i < copies; ++i) {
+		for (size_t j = 0; j < num_verts; ++j)
+			out_vert[i * num_verts + j] = vert[j];
+
+		for (size_t j = 0; j < num_idx; ++j)
+			out_idx[i * num_idx + j] = INDEX_T(idx[j] + i * num_verts);
+	}
+}
+
+class InstancedArrays
+{
+	bool available;
+
+public:
+	InstancedArrays();
+
+	// pick up instanced arrays if the extension is present and allowed; needs a current context
+	void init(
+		const bool allow = true);
+
+	bool isAvailable() const;
+
+	// set how many instances an attribute advances per; 0 for per vertex; needs instanced arrays
+	void setDivisor(
+		const GLuint attr,
+		const GLuint divisor) const;
+
+	// divisor in effect for an attribute; 0 without instanced arrays
+	GLuint getDivisor(
+		const GLuint attr) const;
+
+	// draw indexed primitives instances times; needs instanced arrays
+	void drawElements(
+		const GLenum mode,
+		const GLsizei count,
+		const GLenum index_type,
+		const uintptr_t index_offset,
+		const GLsizei instances) const;
+};
+
+} // namespace rend
+
+#endif // rend_instancing_H__
@@ -0,0 +1,177 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include "util_misc.hpp"
+#include "pure_macro.hpp"
+#include "rendOverdraw.hpp"
+
+namespace rend
+{
+
+OverdrawCounter::OverdrawCounter()
+: texture(0)
+, depth(0)
+, fbo(0)
+, width(0)
+, height(0)
+{
+}
+
+bool OverdrawCounter::init(
+	const GLsizei width,
+	const GLsizei height,
+	const bool depth)
+{
+	if (0 != fbo && width == this->width && height == this->height && depth == (0 != this->depth))
+		return true;
+
+	clear();
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, 0);
+
+	// counts get sampled texel for texel
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	if (depth) {
+		glGenRenderbuffers(1, &this->depth);
+		glBindRenderbuffer(GL_RENDERBUFFER, this->depth);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, width, height);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+	}
+
+	glGenFramebuffers(1, &fbo);
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+
+	if (depth)
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, this->depth);
+
+	const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	if (GL_FRAMEBUFFER_COMPLETE != status) {
+		std::cerr << __FUNCTION__ << " found framebuffer incomplete, status 0x" << std::hex << status << std::dec << std::endl;
+		clear();
+		return false;
+	}
+
+	if (util::reportGLError()) {
+		std::cerr << __FUNCTION__ << " failed to set up the count target" << std::endl;
+		clear();
+		return false;
+	}
+
+	this->width = width;
+	this->height = height;
+	readback.resize(size_t(width) * size_t(height) * 4);
+
+	return true;
+}
+
+void OverdrawCounter::clear()
+{
+	glDeleteFramebuffers(1, &fbo);
+	glDeleteRenderbuffers(1, &depth);
+	glDeleteTextures(1, &texture);
+
+	fbo = 0;
+	depth = 0;
+	texture = 0;
+	width = 0;
+	height = 0;
+	readback.clear();
+}
+
+bool OverdrawCounter::begin()
+{
+	assert(0 != fbo);
+
+	glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+	glViewport(0, 0, width, height);
+
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glClearColor(0.f, 0.f, 0.f, 0.f);
+	GLbitfield mask = GL_COLOR_BUFFER_BIT;
+
+	if (0 != depth) {
+		glDepthMask(GL_TRUE);
+		glClearDepthf(1.f);
+		mask |= GL_DEPTH_BUFFER_BIT;
+	}
+
+	glClear(mask);
+
+	glEnable(GL_BLEND);
+	glBlendEquation(GL_FUNC_ADD);
+	glBlendFunc(GL_ONE, GL_ONE);
+
+	setChannel(OVERDRAW_CHANNEL_SHADED);
+
+	DEBUG_GL_ERR()
+
+	return true;
+}
+
+void OverdrawCounter::setChannel(
+	const OverdrawChannel channel)
+{
+	assert(channel < OVERDRAW_CHANNEL_COUNT);
+
+	glColorMask(
+		OVERDRAW_CHANNEL_SHADED == channel ? GL_TRUE : GL_FALSE,
+		OVERDRAW_CHANNEL_RASTERIZED == channel ? GL_TRUE : GL_FALSE,
+		GL_FALSE,
+		GL_FALSE);
+}
+
+bool OverdrawCounter::end(
+	OverdrawStats& stats)
+{
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDisable(GL_BLEND);
+
+	glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, &readback[0]);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	DEBUG_GL_ERR()
+
+	for (size_t i = 0; i < readback.size(); i += 4) {
+		const unsigned shaded = readback[i + OVERDRAW_CHANNEL_SHADED];
+		const unsigned rasterized = readback[i + OVERDRAW_CHANNEL_RASTERIZED];
+
+		stats.histogram[std::min(shaded, unsigned(OVERDRAW_HISTOGRAM_SIZE - 1))] += 1;
+		stats.fragments_shaded += shaded;
+		stats.fragments_rasterized += rasterized;
+		stats.max_count = std::max(stats.max_count, shaded);
+
+		if (0 != shaded)
+			stats.pixels += 1;
+	}
+
+	++stats.frames;
+	return true;
+}
+
+GLuint OverdrawCounter::getTexture() const
+{
+	return texture;
+}
+
+} // namespace rend
@@ -0,0 +1,100 @@
+#ifndef rend_overdraw_H__
+#define rend_overdraw_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <vector>
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// OverdrawCounter measures how many times each pixel of a frame gets shaded: the caller re-renders
+// the frame into an offscreen target, with a program whose fragments all output 1/255, under additive
+// blending - each fragment that lands adds one to its pixel. Two channels count separately, picked by
+// color mask:
+//
+// rasterized - every fragment of the geometry, as drawn without a depth test;
+// shaded - the fragments that reach the fragment shader in the frame's own visibility setup, e.g.
+//	depth tested front to back, or after a depth prepass; with early depth testing those are the ones
+//	the frame pays shading for.
+//
+// Ending a measurement reads the target back and accumulates a histogram of pixels by shaded count,
+// and the fragment totals, into an OverdrawStats. The readback drains the pipeline - a debug mode,
+// not one to time. Counts saturate at 255. The target's texture can be sampled afterwards, e.g. for a
+// heatmap.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum OverdrawChannel {
+	OVERDRAW_CHANNEL_SHADED,
+	OVERDRAW_CHANNEL_RASTERIZED,
+
+	OVERDRAW_CHANNEL_COUNT,
+	OVERDRAW_CHANNEL_FORCE_UINT = -1U
+};
+
+enum {
+	OVERDRAW_HISTOGRAM_SIZE = 16 // pixels shaded 0 to 14 times, and 15 or more
+};
+
+// counts, summed over measured frames
+struct OverdrawStats
+{
+	unsigned frames;
+	uint64_t pixels;               // shaded at least once
+	uint64_t fragments_shaded;
+	uint64_t fragments_rasterized;
+	uint64_t histogram[OVERDRAW_HISTOGRAM_SIZE];
+	unsigned max_count;            // of shaded fragments at a pixel, over all frames
+};
+
+class OverdrawCounter
+{
+	GLuint texture;
+	GLuint depth;   // renderbuffer; 0 without depth
+	GLuint fbo;
+
+	GLsizei width;
+	GLsizei height;
+
+	std::vector< uint8_t > readback;
+
+public:
+	OverdrawCounter();
+
+	// set up the count target, with a depth buffer if asked; keeps the target if already of that
+	// extent and kind; needs a current context
+	bool init(
+		const GLsizei width,
+		const GLsizei height,
+		const bool depth);
+
+	// delete the count target; needs a current context
+	void clear();
+
+	// bind the count target, clear it - depth to 1 - and enable additive blending; color writes go to
+	// the shaded channel
+	bool begin();
+
+	// direct color writes to a channel
+	void setChannel(
+		const OverdrawChannel channel);
+
+	// read the counts back into the stats; restore color writes and blending, and bind the default
+	// framebuffer
+	bool end(
+		OverdrawStats& stats);
+
+	// texture of the counts - shaded in red, rasterized in green, in units of 1/255
+	GLuint getTexture() const;
+};
+
+} // namespace rend
+
+#endif // rend_overdraw_H__
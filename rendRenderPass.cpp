@@ -0,0 +1,175 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+
+#include "util_misc.hpp"
+#include "pure_macro.hpp"
+#include "rendRenderPass.hpp"
+
+namespace rend
+{
+
+#if PLATFORM_GLES
+static PFNGLDISCARDFRAMEBUFFEREXTPROC glDiscardFramebufferEXT;
+
+#endif
+RenderPass::RenderPass()
+: discard(false)
+, width(0)
+, height(0)
+{
+	memset(&desc, 0, sizeof(desc));
+	memset(bytes_per_pixel, 0, sizeof(bytes_per_pixel));
+}
+
+static unsigned bytesPerPixel(
+	const GLint bits)
+{
+	return unsigned(bits + 7) / 8;
+}
+
+void RenderPass::init(
+	const RenderPassDesc& desc,
+	const bool allow_discard)
+{
+	this->desc = desc;
+
+#if PLATFORM_GLES
+	discard = allow_discard && util::hasExtension("GL_EXT_discard_framebuffer");
+
+	if (discard) {
+		glDiscardFramebufferEXT = (PFNGLDISCARDFRAMEBUFFEREXTPROC) eglGetProcAddress("glDiscardFramebufferEXT");
+		discard = 0 != glDiscardFramebufferEXT;
+	}
+
+#else
+	discard = false;
+
+#endif
+	glBindFramebuffer(GL_FRAMEBUFFER, desc.fbo);
+
+	GLint red = 0, green = 0, blue = 0, alpha = 0, depth = 0, stencil = 0;
+
+	glGetIntegerv(GL_RED_BITS, &red);
+	glGetIntegerv(GL_GREEN_BITS, &green);
+	glGetIntegerv(GL_BLUE_BITS, &blue);
+	glGetIntegerv(GL_ALPHA_BITS, &alpha);
+	glGetIntegerv(GL_DEPTH_BITS, &depth);
+	glGetIntegerv(GL_STENCIL_BITS, &stencil);
+
+	bytes_per_pixel[ATTACHMENT_COLOR] = bytesPerPixel(red + green + blue + alpha);
+	bytes_per_pixel[ATTACHMENT_DEPTH] = bytesPerPixel(depth);
+	bytes_per_pixel[ATTACHMENT_STENCIL] = bytesPerPixel(stencil);
+}
+
+bool RenderPass::canDiscard() const
+{
+	return discard;
+}
+
+bool RenderPass::begin(
+	const GLsizei width,
+	const GLsizei height,
+	RenderPassStats& stats)
+{
+	this->width = width;
+	this->height = height;
+
+	glBindFramebuffer(GL_FRAMEBUFFER, desc.fbo);
+
+	GLbitfield mask = 0;
+	const uint64_t pixels = uint64_t(width) * uint64_t(height);
+
+	for (unsigned i = 0; i < ATTACHMENT_COUNT; ++i) {
+		const uint64_t bytes = pixels * bytes_per_pixel[i];
+
+		if (LOAD_ACTION_LOAD == desc.load[i]) {
+			stats.bytes_loaded += bytes;
+			continue;
+		}
+
+		stats.bytes_saved += bytes;
+
+		if (0 == bytes)
+			continue;
+
+		switch (i) {
+		case ATTACHMENT_COLOR:
+			glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+			glClearColor(desc.clear_color[0], desc.clear_color[1], desc.clear_color[2], desc.clear_color[3]);
+			mask |= GL_COLOR_BUFFER_BIT;
+			break;
+		case ATTACHMENT_DEPTH:
+			glDepthMask(GL_TRUE);
+			glClearDepthf(desc.clear_depth);
+			mask |= GL_DEPTH_BUFFER_BIT;
+			break;
+		case ATTACHMENT_STENCIL:
+			glStencilMask(~0U);
+			glClearStencil(desc.clear_stencil);
+			mask |= GL_STENCIL_BUFFER_BIT;
+			break;
+		}
+	}
+
+	if (0 != mask)
+		glClear(mask);
+
+	DEBUG_GL_ERR()
+
+	++stats.passes;
+	return true;
+}
+
+bool RenderPass::end(
+	RenderPassStats& stats)
+{
+	static const GLenum attachment_default[ATTACHMENT_COUNT] = {
+		GL_COLOR_EXT,
+		GL_DEPTH_EXT,
+		GL_STENCIL_EXT
+	};
+	static const GLenum attachment_fbo[ATTACHMENT_COUNT] = {
+		GL_COLOR_ATTACHMENT0,
+		GL_DEPTH_ATTACHMENT,
+		GL_STENCIL_ATTACHMENT
+	};
+
+	GLenum attachment[ATTACHMENT_COUNT];
+	GLsizei num_attachments = 0;
+	const uint64_t pixels = uint64_t(width) * uint64_t(height);
+
+	for (unsigned i = 0; i < ATTACHMENT_COUNT; ++i) {
+		const uint64_t bytes = pixels * bytes_per_pixel[i];
+
+		if (STORE_ACTION_STORE == desc.store[i] || !discard) {
+			stats.bytes_stored += bytes;
+			continue;
+		}
+
+		stats.bytes_saved += bytes;
+
+		if (0 != bytes)
+			attachment[num_attachments++] = 0 == desc.fbo ? attachment_default[i] : attachment_fbo[i];
+	}
+
+#if PLATFORM_GLES
+	if (0 != num_attachments)
+		glDiscardFramebufferEXT(GL_FRAMEBUFFER, num_attachments, attachment);
+
+#endif
+	DEBUG_GL_ERR()
+
+	return true;
+}
+
+} // namespace rend
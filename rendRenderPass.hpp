@@ -0,0 +1,110 @@
+#ifndef rend_render_pass_H__
+#define rend_render_pass_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// RenderPass brackets the draws into a framebuffer with what happens to each attachment around them:
+// at the start its previous contents get loaded, cleared, or not cared about; at the end its new
+// contents get stored or discarded. A tile-based GPU needs to read an attachment from memory only to
+// load it, and to write it back only to store it; GLES2 has no direct way to say either, so the
+// actions map to what drivers read them from:
+//
+// clear, don't care - a glClear of the attachment, with its write mask enabled, as a full clear is
+//	what lets a tiler skip the load;
+// discard - glDiscardFramebufferEXT at the end, where GL_EXT_discard_framebuffer is present; a store
+//	otherwise.
+//
+// Each pass counts the attachment bytes it moves to and from memory, and those its actions save, into
+// a RenderPassStats - an estimate from attachment sizes, as the actual traffic is up to the driver.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum Attachment {
+	ATTACHMENT_COLOR,
+	ATTACHMENT_DEPTH,
+	ATTACHMENT_STENCIL,
+
+	ATTACHMENT_COUNT,
+	ATTACHMENT_FORCE_UINT = -1U
+};
+
+enum LoadAction {
+	LOAD_ACTION_LOAD,
+	LOAD_ACTION_CLEAR,
+	LOAD_ACTION_DONT_CARE,
+
+	LOAD_ACTION_FORCE_UINT = -1U
+};
+
+enum StoreAction {
+	STORE_ACTION_STORE,
+	STORE_ACTION_DISCARD,
+
+	STORE_ACTION_FORCE_UINT = -1U
+};
+
+struct RenderPassDesc
+{
+	GLuint fbo; // 0 for the default framebuffer
+	LoadAction load[ATTACHMENT_COUNT];
+	StoreAction store[ATTACHMENT_COUNT];
+	GLfloat clear_color[4];
+	GLfloat clear_depth;
+	GLint clear_stencil;
+};
+
+// attachment traffic, in bytes
+struct RenderPassStats
+{
+	unsigned passes;
+	uint64_t bytes_loaded;
+	uint64_t bytes_stored;
+	uint64_t bytes_saved; // by clears and discards, against loading and storing every attachment
+};
+
+class RenderPass
+{
+	RenderPassDesc desc;
+	unsigned bytes_per_pixel[ATTACHMENT_COUNT]; // 0 for attachments the framebuffer lacks
+	bool discard;
+
+	GLsizei width;
+	GLsizei height;
+
+public:
+	RenderPass();
+
+	// set up a pass on the framebuffer of a description, querying the sizes of its attachments; needs a
+	// current context; allow_discard false makes discards stores, for comparison
+	void init(
+		const RenderPassDesc& desc,
+		const bool allow_discard = true);
+
+	// whether discards reach the driver
+	bool canDiscard() const;
+
+	// bind the framebuffer and apply the load actions over the given extent; leaves the write masks of
+	// cleared attachments enabled
+	bool begin(
+		const GLsizei width,
+		const GLsizei height,
+		RenderPassStats& stats);
+
+	// apply the store actions
+	bool end(
+		RenderPassStats& stats);
+};
+
+} // namespace rend
+
+#endif // rend_render_pass_H__
@@ -0,0 +1,186 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <GLES2/gl2.h>
+#endif
+
+#include <string.h>
+#include <assert.h>
+#include <vector>
+#include <iostream>
+
+#include "rendUniformBlock.hpp"
+
+namespace rend
+{
+
+static const char* const block_name[UNIFORM_FREQ_COUNT] = {
+	"frame_block",
+	"material_block",
+	"object_block"
+};
+
+UniformBlocks::UniformBlocks()
+: uploads(0)
+{
+	for (unsigned i = 0; i < UNIFORM_FREQ_COUNT; ++i) {
+		block[i].source.data = 0;
+		block[i].source.num_vec4 = 0;
+		block[i].version = 1;
+	}
+}
+
+// name of a uniform sans array subscript
+static size_t baseNameLength(
+	const GLchar* const name)
+{
+	const GLchar* const bracket = strchr(name, '[');
+	return 0 != bracket ? size_t(bracket - name) : strlen(name);
+}
+
+static bool isSampler(
+	const GLenum type)
+{
+	return GL_SAMPLER_2D == type || GL_SAMPLER_CUBE == type;
+}
+
+bool UniformBlocks::addProgram(
+	const GLuint prog)
+{
+	ProgramBlocks p;
+	p.prog = prog;
+
+	for (unsigned i = 0; i < UNIFORM_FREQ_COUNT; ++i) {
+		p.location[i] = -1;
+		p.num_vec4[i] = 0;
+		p.version[i] = 0;
+	}
+
+	GLint num_uniforms = 0;
+	GLint max_len = 0;
+
+	glGetProgramiv(prog, GL_ACTIVE_UNIFORMS, &num_uniforms);
+	glGetProgramiv(prog, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_len);
+
+	std::vector< GLchar > name(max_len + 1);
+	bool success = true;
+
+	for (GLint i = 0; i < num_uniforms; ++i) {
+		GLint size = 0;
+		GLenum type = 0;
+
+		glGetActiveUniform(prog, GLuint(i), GLsizei(name.size()), 0, &size, &type, &name[0]);
+
+		const size_t len = baseNameLength(&name[0]);
+		unsigned freq = 0;
+
+		while (freq < UNIFORM_FREQ_COUNT && (len != strlen(block_name[freq]) || strncmp(&name[0], block_name[freq], len)))
+			++freq;
+
+		if (UNIFORM_FREQ_COUNT == freq) {
+			if (!isSampler(type))
+				std::cerr << __FUNCTION__ << " uniform '" << &name[0] << "' outside blocks" << std::endl;
+
+			continue;
+		}
+
+		if (GL_FLOAT_VEC4 != type) {
+			std::cerr << __FUNCTION__ << " block '" << block_name[freq] << "' not of vec4" << std::endl;
+			success = false;
+			continue;
+		}
+
+		name[len] = '\0';
+
+		// active size covers the elements up to the last one read
+		p.location[freq] = glGetUniformLocation(prog, &name[0]);
+		p.num_vec4[freq] = size;
+	}
+
+	for (size_t i = 0; i < program.size(); ++i)
+		if (prog == program[i].prog) {
+			program[i] = p;
+			return success;
+		}
+
+	program.push_back(p);
+	return success;
+}
+
+void UniformBlocks::removeProgram(
+	const GLuint prog)
+{
+	for (size_t i = 0; i < program.size(); ++i)
+		if (prog == program[i].prog) {
+			program.erase(program.begin() + i);
+			return;
+		}
+}
+
+void UniformBlocks::clear()
+{
+	program.clear();
+}
+
+void UniformBlocks::setBlock(
+	const UniformFrequency freq,
+	const UniformBlockSource& source)
+{
+	assert(freq < UNIFORM_FREQ_COUNT);
+	Block& b = block[freq];
+
+	if (source.data == b.source.data && source.num_vec4 == b.source.num_vec4)
+		return;
+
+	b.source = source;
+	++b.version;
+}
+
+void UniformBlocks::setDirty(
+	const UniformFrequency freq)
+{
+	assert(freq < UNIFORM_FREQ_COUNT);
+	++block[freq].version;
+}
+
+unsigned UniformBlocks::apply(
+	const GLuint prog)
+{
+	size_t i = 0;
+
+	while (i < program.size() && prog != program[i].prog)
+		++i;
+
+	assert(i < program.size());
+
+	if (program.size() == i)
+		return 0;
+
+	ProgramBlocks& p = program[i];
+	unsigned count = 0;
+
+	for (unsigned j = 0; j < UNIFORM_FREQ_COUNT; ++j) {
+		const Block& b = block[j];
+
+		if (-1 == p.location[j] || b.version == p.version[j] || 0 == b.source.data)
+			continue;
+
+		// a short source fills the head of the block, e.g. the first entries of a palette
+		const GLsizei num_vec4 = GLsizei(b.source.num_vec4) < p.num_vec4[j] ? GLsizei(b.source.num_vec4) : p.num_vec4[j];
+		glUniform4fv(p.location[j], num_vec4, b.source.data);
+
+		p.version[j] = b.version;
+		++count;
+	}
+
+	uploads += count;
+	return count;
+}
+
+unsigned UniformBlocks::getUploads() const
+{
+	return uploads;
+}
+
+} // namespace rend
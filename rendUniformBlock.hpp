@@ -0,0 +1,116 @@
+#ifndef rend_uniform_block_H__
+#define rend_uniform_block_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+#endif
+
+#include <vector>
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// UniformBlocks emulates uniform blocks on GLES2: shader parameters get packed by update frequency -
+// per frame, per material, per object - into vec4 arrays, declared in the shaders as
+//
+//	uniform vec4 frame_block[N];
+//	uniform vec4 material_block[N];
+//	uniform vec4 object_block[N];
+//
+// with the parameters as macros over the elements, e.g. '#define lp_obj frame_block[0]'. The blocks
+// of a program come from reflection of its active uniforms - location, and the number of vec4s it
+// reads - and each gets uploaded with a single glUniform4fv, only when its data changed since the last
+// upload to that program. A block gets declared in one shader stage only, as stages differ in
+// default precision. Block data is caller-owned, laid out as in the shaders.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+enum UniformFrequency {
+	UNIFORM_FREQ_FRAME,
+	UNIFORM_FREQ_MATERIAL,
+	UNIFORM_FREQ_OBJECT,
+
+	UNIFORM_FREQ_COUNT,
+	UNIFORM_FREQ_FORCE_UINT = -1U
+};
+
+// caller-owned data of a block
+struct UniformBlockSource
+{
+	const GLfloat* data;
+	unsigned num_vec4;
+};
+
+// source of a block held in a struct of vec4s
+template < typename BLOCK_T >
+inline UniformBlockSource
+getBlockSource(
+	const BLOCK_T& block)
+{
+	const UniformBlockSource source = {
+		reinterpret_cast< const GLfloat* >(&block),
+		sizeof(BLOCK_T) / (4 * sizeof(GLfloat))
+	};
+
+	return source;
+}
+
+class UniformBlocks
+{
+	struct Block {
+		UniformBlockSource source;
+		unsigned version;
+	};
+
+	struct ProgramBlocks {
+		GLuint prog;
+		GLint location[UNIFORM_FREQ_COUNT];
+		GLsizei num_vec4[UNIFORM_FREQ_COUNT];
+		unsigned version[UNIFORM_FREQ_COUNT]; // block version last uploaded; 0 for none
+	};
+
+	Block block[UNIFORM_FREQ_COUNT];
+	std::vector< ProgramBlocks > program;
+
+	unsigned uploads;
+
+public:
+	UniformBlocks();
+
+	// reflect the blocks of a linked program, replacing any earlier reflection of the same program
+	// name; report active uniforms outside blocks, other than samplers, and return false on blocks of
+	// the wrong type
+	bool addProgram(
+		const GLuint prog);
+
+	// drop the reflection of a program, e.g. ahead of deleting it
+	void removeProgram(
+		const GLuint prog);
+
+	// drop all programs
+	void clear();
+
+	// point a block at its data; a change of data pointer counts as a change of data; data shorter than
+	// a program's block gets uploaded to the head of it
+	void setBlock(
+		const UniformFrequency freq,
+		const UniformBlockSource& source);
+
+	// mark the data of a block changed
+	void setDirty(
+		const UniformFrequency freq);
+
+	// upload to the program in use the blocks it reads whose data changed since their last upload to
+	// it; return the number of uploads
+	unsigned apply(
+		const GLuint prog);
+
+	// uploads so far
+	unsigned getUploads() const;
+};
+
+} // namespace rend
+
+#endif // rend_uniform_block_H__
@@ -0,0 +1,290 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <string.h>
+#include <assert.h>
+#include <vector>
+
+#include "util_misc.hpp"
+#include "rendInstancing.hpp"
+#include "rendVertArray.hpp"
+
+namespace rend
+{
+
+#if PLATFORM_GLES && PLATFORM_GL_OES_vertex_array_object
+static PFNGLBINDVERTEXARRAYOESPROC    glBindVertexArrayOES;
+static PFNGLDELETEVERTEXARRAYSOESPROC glDeleteVertexArraysOES;
+static PFNGLGENVERTEXARRAYSOESPROC    glGenVertexArraysOES;
+
+#endif
+VertexArrays::VertexArrays()
+: native(false)
+, num_attribs(0)
+, instanced(0)
+, current_valid(false)
+, pointer_updates(0)
+{
+}
+
+void VertexArrays::init(
+	const bool allow_native,
+	const InstancedArrays* const instanced)
+{
+	clear();
+
+	this->instanced = 0 != instanced && instanced->isAvailable() ? instanced : 0;
+
+#if PLATFORM_GL
+	native = allow_native;
+
+#elif PLATFORM_GL_OES_vertex_array_object
+	native = allow_native && util::hasExtension("GL_OES_vertex_array_object");
+
+	if (native) {
+		glBindVertexArrayOES    = (PFNGLBINDVERTEXARRAYOESPROC)    eglGetProcAddress("glBindVertexArrayOES");
+		glDeleteVertexArraysOES = (PFNGLDELETEVERTEXARRAYSOESPROC) eglGetProcAddress("glDeleteVertexArraysOES");
+		glGenVertexArraysOES    = (PFNGLGENVERTEXARRAYSOESPROC)    eglGetProcAddress("glGenVertexArraysOES");
+
+		native = 0 != glBindVertexArrayOES && 0 != glDeleteVertexArraysOES && 0 != glGenVertexArraysOES;
+	}
+
+#else
+	native = false;
+
+#endif
+	GLint max_attribs = 0;
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &max_attribs);
+
+	num_attribs = max_attribs < VERTEX_ARRAY_MAX_ATTRIBS ? unsigned(max_attribs) : unsigned(VERTEX_ARRAY_MAX_ATTRIBS);
+	current_valid = false;
+	pointer_updates = 0;
+}
+
+bool VertexArrays::isNative() const
+{
+	return native;
+}
+
+bool VertexArrays::createEmulated(
+	const GLuint vbo_idx,
+	const ActiveAttrSemantics& attr)
+{
+	Record r;
+	memset(&r, 0, sizeof(r));
+	r.vbo_idx = vbo_idx;
+
+	// read back what the setup function specified; a one-off at creation
+	for (unsigned i = 0; i < attr.num_active_attr; ++i) {
+		const GLuint loc = GLuint(attr.active_attr[i]);
+
+		if (loc >= num_attribs) {
+			assert(false);
+			return false;
+		}
+
+		AttrPointer& a = r.attr[loc];
+		GLint buffer = 0;
+		GLint size = 0;
+		GLint type = 0;
+		GLint stride = 0;
+		GLvoid* pointer = 0;
+
+		glGetVertexAttribiv(loc, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &buffer);
+		glGetVertexAttribiv(loc, GL_VERTEX_ATTRIB_ARRAY_SIZE, &size);
+		glGetVertexAttribiv(loc, GL_VERTEX_ATTRIB_ARRAY_TYPE, &type);
+		glGetVertexAttribiv(loc, GL_VERTEX_ATTRIB_ARRAY_NORMALIZED, &a.normalized);
+		glGetVertexAttribiv(loc, GL_VERTEX_ATTRIB_ARRAY_STRIDE, &stride);
+		glGetVertexAttribPointerv(loc, GL_VERTEX_ATTRIB_ARRAY_POINTER, &pointer);
+
+		a.buffer = GLuint(buffer);
+		a.size = size;
+		a.type = GLenum(type);
+		a.stride = stride;
+		a.pointer = pointer;
+		a.divisor = 0 != instanced ? instanced->getDivisor(loc) : 0;
+		a.enabled = true;
+	}
+
+	record.push_back(r);
+	return true;
+}
+
+GLuint VertexArrays::create(
+	const GLuint vbo_arr,
+	const GLuint vbo_idx,
+	const ActiveAttrSemantics& attr,
+	const SetupVertexAttrPointers setup)
+{
+	assert(0 != setup);
+
+#if PLATFORM_GL_OES_vertex_array_object
+	if (native) {
+		GLuint name = 0;
+		glGenVertexArraysOES(1, &name);
+
+		if (0 == name)
+			return 0;
+
+		glBindVertexArrayOES(name);
+		glBindBuffer(GL_ARRAY_BUFFER, vbo_arr);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_idx);
+
+		const bool success = setup(attr, 0);
+
+		for (unsigned i = 0; i < attr.num_active_attr; ++i)
+			glEnableVertexAttribArray(attr.active_attr[i]);
+
+		glBindVertexArrayOES(0);
+
+		if (!success) {
+			glDeleteVertexArraysOES(1, &name);
+			return 0;
+		}
+
+		vao.push_back(name);
+		return GLuint(vao.size());
+	}
+
+#endif
+	// the setup function overwrites pointers in effect
+	invalidate();
+
+	glBindBuffer(GL_ARRAY_BUFFER, vbo_arr);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vbo_idx);
+
+	if (!setup(attr, 0) || !createEmulated(vbo_idx, attr))
+		return 0;
+
+	return GLuint(record.size());
+}
+
+void VertexArrays::bindEmulated(
+	const GLuint id)
+{
+	if (0 == id) {
+		for (unsigned i = 0; i < num_attribs; ++i) {
+			if (!current_valid || current[i].enabled) {
+				glDisableVertexAttribArray(i);
+				current[i].enabled = false;
+			}
+
+			if (!current_valid) {
+				current[i].buffer = ~0U;
+				current[i].divisor = ~0U;
+			}
+		}
+
+		// all disabled, and pointers marked unknown
+		current_valid = true;
+		return;
+	}
+
+	assert(id <= record.size());
+	const Record& r = record[id - 1];
+
+	// element buffer bindings change outside vertex arrays too, e.g. at buffer updates
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, r.vbo_idx);
+
+	GLuint buffer = 0;
+	bool buffer_known = false;
+
+	for (unsigned i = 0; i < num_attribs; ++i) {
+		const AttrPointer& a = r.attr[i];
+		AttrPointer& c = current[i];
+
+		if (!a.enabled) {
+			if (!current_valid || c.enabled) {
+				glDisableVertexAttribArray(i);
+				c.enabled = false;
+			}
+
+			// the pointer left by whoever invalidated is unknown; make sure the next record to
+			// enable the attribute re-specifies it
+			if (!current_valid) {
+				c.buffer = ~0U;
+				c.divisor = ~0U;
+			}
+
+			continue;
+		}
+
+		if (!current_valid ||
+			a.buffer != c.buffer ||
+			a.size != c.size ||
+			a.type != c.type ||
+			a.normalized != c.normalized ||
+			a.stride != c.stride ||
+			a.pointer != c.pointer ||
+			a.divisor != c.divisor) {
+
+			if (!buffer_known || a.buffer != buffer) {
+				glBindBuffer(GL_ARRAY_BUFFER, a.buffer);
+				buffer = a.buffer;
+				buffer_known = true;
+			}
+
+			glVertexAttribPointer(i, a.size, a.type, GLboolean(a.normalized), a.stride, a.pointer);
+			++pointer_updates;
+
+			if (0 != instanced && (!current_valid || a.divisor != c.divisor))
+				instanced->setDivisor(i, a.divisor);
+
+			const bool enabled = current_valid && c.enabled;
+			c = a;
+			c.enabled = enabled;
+		}
+
+		if (!current_valid || !c.enabled) {
+			glEnableVertexAttribArray(i);
+			c.enabled = true;
+		}
+	}
+
+	current_valid = true;
+}
+
+void VertexArrays::bind(
+	const GLuint id)
+{
+#if PLATFORM_GL_OES_vertex_array_object
+	if (native) {
+		assert(id <= vao.size());
+		glBindVertexArrayOES(0 != id ? vao[id - 1] : 0);
+		return;
+	}
+
+#endif
+	bindEmulated(id);
+}
+
+void VertexArrays::invalidate()
+{
+	current_valid = false;
+}
+
+void VertexArrays::clear()
+{
+#if PLATFORM_GL_OES_vertex_array_object
+	if (!vao.empty())
+		glDeleteVertexArraysOES(GLsizei(vao.size()), &vao[0]);
+
+#endif
+	vao.clear();
+	record.clear();
+	current_valid = false;
+}
+
+unsigned VertexArrays::getPointerUpdates() const
+{
+	return pointer_updates;
+}
+
+} // namespace rend
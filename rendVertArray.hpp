@@ -0,0 +1,113 @@
+#ifndef rend_vert_array_H__
+#define rend_vert_array_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <vector>
+
+#include "rendVertAttr.hpp"
+#include "rendInstancing.hpp"
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// VertexArrays provides vertex array objects whether or not the driver has them, as found at run
+// time: with GL_OES_vertex_array_object they are native objects; without it, each array gets recorded
+// at creation - element buffer, and buffer and pointer of each attribute - and binding one applies
+// only what differs from the attribute state applied last. While emulating, attribute pointers are
+// assumed to change only through the VertexArrays; code that sets them up otherwise calls invalidate.
+// Unbinding disables all arrays but keeps their pointers, so that rebinding the same array costs no
+// pointer setup. With instanced arrays, emulated arrays record attribute divisors as well.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// set up vertex attribute pointers for the bound buffers, e.g. setupVertexAttrPointers< VERTEX_T >
+typedef bool (*SetupVertexAttrPointers)(
+	const ActiveAttrSemantics&,
+	const uintptr_t);
+
+enum {
+	VERTEX_ARRAY_MAX_ATTRIBS = 16
+};
+
+class VertexArrays
+{
+	struct AttrPointer {
+		GLuint buffer;
+		GLint size;
+		GLenum type;
+		GLint normalized;
+		GLsizei stride;
+		const GLvoid* pointer;
+		GLuint divisor;
+		bool enabled;
+	};
+
+	struct Record {
+		GLuint vbo_idx;
+		AttrPointer attr[VERTEX_ARRAY_MAX_ATTRIBS];
+	};
+
+	bool native;
+	unsigned num_attribs;
+
+	const InstancedArrays* instanced; // divisors, if not null and available
+
+	std::vector< GLuint > vao;     // native arrays by id - 1
+	std::vector< Record > record;  // emulated arrays by id - 1
+
+	// attribute state applied last, while emulating
+	AttrPointer current[VERTEX_ARRAY_MAX_ATTRIBS];
+	bool current_valid;
+
+	unsigned pointer_updates;
+
+	bool createEmulated(
+		const GLuint vbo_idx,
+		const ActiveAttrSemantics& attr);
+
+	void bindEmulated(
+		const GLuint id);
+
+public:
+	VertexArrays();
+
+	// pick native arrays if the extension is present and allowed, emulation otherwise; needs a current
+	// context, and drops all arrays; instanced arrays, if given, get initialized before
+	void init(
+		const bool allow_native = true,
+		const InstancedArrays* const instanced = 0);
+
+	bool isNative() const;
+
+	// create a vertex array from buffers and the attribute pointers a setup function sets for the
+	// given active attributes, all of which get enabled; return its id, or 0 on failure
+	GLuint create(
+		const GLuint vbo_arr,
+		const GLuint vbo_idx,
+		const ActiveAttrSemantics& attr,
+		const SetupVertexAttrPointers setup);
+
+	// bind a vertex array by id, or unbind with 0
+	void bind(
+		const GLuint id);
+
+	// forget the attribute state applied last, after changing attribute pointers directly
+	void invalidate();
+
+	// delete all arrays; needs a current context
+	void clear();
+
+	// glVertexAttribPointer calls issued by emulated binds so far
+	unsigned getPointerUpdates() const;
+};
+
+} // namespace rend
+
+#endif // rend_vert_array_H__
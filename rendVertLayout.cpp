@@ -0,0 +1,104 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdint.h>
+#include <assert.h>
+#include <vector>
+#include <iostream>
+
+#include "rendVertLayout.hpp"
+
+namespace rend
+{
+
+// components read by an attribute of the given type, or 0 for types a single pointer cannot feed
+static GLint attrComponents(
+	const GLenum type)
+{
+	switch (type) {
+	case GL_FLOAT:
+		return 1;
+	case GL_FLOAT_VEC2:
+		return 2;
+	case GL_FLOAT_VEC3:
+		return 3;
+	case GL_FLOAT_VEC4:
+		return 4;
+	}
+
+	return 0;
+}
+
+bool validateVertexLayout(
+	const GLuint prog,
+	const ActiveAttrSemantics& active_attr_semantics,
+	const VertAttrFormat* const attr,
+	const unsigned count)
+{
+	GLint num_attr = 0;
+	GLint max_len = 0;
+
+	glGetProgramiv(prog, GL_ACTIVE_ATTRIBUTES, &num_attr);
+	glGetProgramiv(prog, GL_ACTIVE_ATTRIBUTE_MAX_LENGTH, &max_len);
+
+	std::vector< GLchar > name(max_len + 1);
+	bool success = true;
+
+	for (GLint i = 0; i < num_attr; ++i) {
+		GLint size = 0;
+		GLenum type = 0;
+
+		glGetActiveAttrib(prog, GLuint(i), GLsizei(name.size()), 0, &size, &type, &name[0]);
+
+		const GLint location = glGetAttribLocation(prog, &name[0]);
+
+		// built-ins have no location
+		if (-1 == location)
+			continue;
+
+		unsigned j = 0;
+
+		while (j < active_attr_semantics.num_active_attr && location != active_attr_semantics.active_attr[j])
+			++j;
+
+		if (active_attr_semantics.num_active_attr == j) {
+			std::cerr << __FUNCTION__ << " attribute '" << &name[0] << "' has no semantics" << std::endl;
+			success = false;
+			continue;
+		}
+
+		const VertAttrFormat* format = 0;
+
+		for (unsigned k = 0; k < count && 0 == format; ++k)
+			if (int(j) == active_attr_semantics.*attr[k].semantics)
+				format = attr + k;
+
+		if (0 == format) {
+			std::cerr << __FUNCTION__ << " attribute '" << &name[0] << "' not fed by the vertex layout" << std::endl;
+			success = false;
+			continue;
+		}
+
+		const GLint components = attrComponents(type);
+
+		if (0 == components || 1 != size) {
+			std::cerr << __FUNCTION__ << " attribute '" << &name[0] << "' of unsupported type" << std::endl;
+			success = false;
+			continue;
+		}
+
+		if (format->size > components) {
+			std::cerr << __FUNCTION__ << " attribute '" << &name[0] << "' reads " << components <<
+				" components of " << format->size << " fetched" << std::endl;
+		}
+	}
+
+	return success;
+}
+
+} // namespace rend
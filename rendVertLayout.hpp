@@ -0,0 +1,256 @@
+#ifndef rend_vert_layout_H__
+#define rend_vert_layout_H__
+
+#if PLATFORM_GL
+	#include <GL/gl.h>
+	#include "gles_gl_mapping.hpp"
+#else
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include <assert.h>
+#include <cstddef>
+
+#include "util_misc.hpp"
+#include "pure_macro.hpp"
+#include "rendVertAttr.hpp"
+
+namespace rend
+{
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Vertex layouts are traits of the vertex type: VertexLayout< VERTEX_T > lists one VertAttrFormat per
+// attribute the type supplies - the semantics it feeds, and the exact arguments of its
+// glVertexAttribPointer call. Component type and count come from the member's type, so a layout
+// entry cannot drift from the struct, e.g.:
+//
+//	template <>
+//	const rend::VertAttrFormat rend::VertexLayout< Vertex >::attr[] = {
+//		REND_VERT_ATTR(Vertex, pos, vertex, GL_FALSE, 0),
+//		REND_VERT_ATTR(Vertex, nrm, normal, GL_TRUE, 3)
+//	};
+//
+//	template <>
+//	const unsigned rend::VertexLayout< Vertex >::count = REND_VERT_LAYOUT_COUNT(Vertex);
+//
+// A size of 0 takes the member's full component count; a member can feed more than one semantics.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// component types with no C counterpart; raw bits, encoded by the app
+struct half_t {                 // GL_HALF_FLOAT_OES, per OES_vertex_half_float
+	uint16_t bits;
+};
+
+struct int_10_10_10_2_t {       // GL_INT_10_10_10_2_OES, per OES_vertex_type_10_10_10_2
+	uint32_t bits;
+};
+
+struct uint_10_10_10_2_t {      // GL_UNSIGNED_INT_10_10_10_2_OES, per OES_vertex_type_10_10_10_2
+	uint32_t bits;
+};
+
+// GL type of a component, and the number of components it packs
+template < typename T >
+struct AttrComponent;
+
+template <>
+struct AttrComponent< GLfloat > {
+	static const GLenum type = GL_FLOAT;
+	static const GLint size = 1;
+};
+
+template <>
+struct AttrComponent< GLbyte > {
+	static const GLenum type = GL_BYTE;
+	static const GLint size = 1;
+};
+
+template <>
+struct AttrComponent< GLubyte > {
+	static const GLenum type = GL_UNSIGNED_BYTE;
+	static const GLint size = 1;
+};
+
+template <>
+struct AttrComponent< GLshort > {
+	static const GLenum type = GL_SHORT;
+	static const GLint size = 1;
+};
+
+template <>
+struct AttrComponent< GLushort > {
+	static const GLenum type = GL_UNSIGNED_SHORT;
+	static const GLint size = 1;
+};
+
+#if GL_OES_vertex_half_float
+template <>
+struct AttrComponent< half_t > {
+	static const GLenum type = GL_HALF_FLOAT_OES;
+	static const GLint size = 1;
+};
+
+#endif
+#if GL_OES_vertex_type_10_10_10_2
+template <>
+struct AttrComponent< int_10_10_10_2_t > {
+	static const GLenum type = GL_INT_10_10_10_2_OES;
+	static const GLint size = 4;
+};
+
+template <>
+struct AttrComponent< uint_10_10_10_2_t > {
+	static const GLenum type = GL_UNSIGNED_INT_10_10_10_2_OES;
+	static const GLint size = 4;
+};
+
+#endif
+// GL type and component count of a vertex member - a component, or an array of those
+template < typename T >
+struct AttrFormat {
+	static const GLenum type = AttrComponent< T >::type;
+	static const GLint size = AttrComponent< T >::size;
+};
+
+template < typename T, size_t N >
+struct AttrFormat< T[N] > {
+	static const GLenum type = AttrComponent< T >::type;
+	static const GLint size = GLint(N) * AttrComponent< T >::size;
+};
+
+struct VertAttrFormat
+{
+	int ActiveAttrSemantics::* semantics; // semantics fed by the attribute
+	GLint size;
+	GLenum type;
+	GLboolean normalized;
+	uintptr_t offset;
+};
+
+// to be specialized for each vertex type
+template < typename VERTEX_T >
+struct VertexLayout {
+	static const VertAttrFormat attr[];
+	static const unsigned count;
+};
+
+template < typename VERTEX_T, typename MEMBER_T >
+inline VertAttrFormat
+vertAttr(
+	MEMBER_T VERTEX_T::*,
+	const uintptr_t offset,
+	int ActiveAttrSemantics::* const semantics,
+	const GLboolean normalized,
+	const GLint size)
+{
+	assert(size <= AttrFormat< MEMBER_T >::size);
+
+	const VertAttrFormat format = {
+		semantics,
+		0 != size ? size : AttrFormat< MEMBER_T >::size,
+		AttrFormat< MEMBER_T >::type,
+		normalized,
+		offset
+	};
+
+	return format;
+}
+
+#define REND_VERT_ATTR(vertex_t, member, semantics, normalized, size) \
+	rend::vertAttr(&vertex_t::member, offsetof(vertex_t, member), \
+		&rend::ActiveAttrSemantics::semantics_ ## semantics, normalized, size)
+
+#define REND_VERT_LAYOUT_COUNT(vertex_t) \
+	sizeof(rend::VertexLayout< vertex_t >::attr) / sizeof(rend::VertexLayout< vertex_t >::attr[0])
+
+// fixed location of a semantics, as bound by util::bindAttribLocations
+inline GLint
+getFixedAttrLocation(
+	int ActiveAttrSemantics::* const semantics)
+{
+	if (&ActiveAttrSemantics::semantics_vertex == semantics)
+		return util::ATTR_LOC_VERTEX;
+	if (&ActiveAttrSemantics::semantics_normal == semantics)
+		return util::ATTR_LOC_NORMAL;
+	if (&ActiveAttrSemantics::semantics_blendw == semantics)
+		return util::ATTR_LOC_BLENDW;
+	if (&ActiveAttrSemantics::semantics_tcoord == semantics)
+		return util::ATTR_LOC_TCOORD;
+	if (&ActiveAttrSemantics::semantics_index == semantics)
+		return util::ATTR_LOC_INDEX;
+	if (&ActiveAttrSemantics::semantics_tangent == semantics)
+		return util::ATTR_LOC_TANGENT;
+
+	assert(false);
+	return -1;
+}
+
+// semantics of all attributes a layout feeds, at their fixed locations: the vertex state of a mesh of
+// the layout, which serves every program linked with fixed attribute locations - whichever subset of
+// the attributes a program reads
+template < typename VERTEX_T >
+ActiveAttrSemantics getFixedAttrSemantics()
+{
+	typedef VertexLayout< VERTEX_T > Layout;
+	ActiveAttrSemantics active_attr_semantics;
+
+	for (unsigned i = 0; i < Layout::count; ++i) {
+		int ActiveAttrSemantics::* const semantics = Layout::attr[i].semantics;
+
+		if (-1 == active_attr_semantics.*semantics)
+			active_attr_semantics.*semantics = active_attr_semantics.registerAttr(getFixedAttrLocation(semantics));
+	}
+
+	return active_attr_semantics;
+}
+
+// set up the attribute pointers of all active semantics the layout feeds, for vertices at the given
+// offset in the bound array buffer
+template < typename VERTEX_T >
+bool setupVertexAttrPointers(
+	const ActiveAttrSemantics& active_attr_semantics,
+	const uintptr_t va = 0)
+{
+	typedef VertexLayout< VERTEX_T > Layout;
+
+	for (unsigned i = 0; i < Layout::count; ++i) {
+		const VertAttrFormat& f = Layout::attr[i];
+		const int semantics = active_attr_semantics.*f.semantics;
+
+		if (-1 == semantics)
+			continue;
+
+		glVertexAttribPointer(active_attr_semantics.active_attr[semantics], f.size, f.type, f.normalized,
+			sizeof(VERTEX_T), (GLvoid*)(f.offset + va));
+
+		DEBUG_GL_ERR()
+	}
+
+	return true;
+}
+
+// check a layout against the active attributes of a linked program: each must be registered with
+// its semantics and fed by the layout; report mismatches on stderr and return false on any. Layout
+// entries that fetch more components than their attribute reads get reported, but pass
+bool validateVertexLayout(
+	const GLuint prog,
+	const ActiveAttrSemantics& active_attr_semantics,
+	const VertAttrFormat* const attr,
+	const unsigned count);
+
+template < typename VERTEX_T >
+bool validateVertexLayout(
+	const GLuint prog,
+	const ActiveAttrSemantics& active_attr_semantics)
+{
+	typedef VertexLayout< VERTEX_T > Layout;
+
+	return validateVertexLayout(prog, active_attr_semantics, Layout::attr, Layout::count);
+}
+
+} // namespace rend
+
+#endif // rend_vert_layout_H__
@@ -0,0 +1,298 @@
+// Offline optimizer for the permutations of a shader pair. Each variant - every on/off combination of
+// the given feature macros - gets preprocessed as the apps would, run through glsl-optimizer (the
+// Mesa-based GLSL ES optimizer) for dead-code elimination, constant folding and inlining, and written
+// out as flat GLSL ES 1.00, for the apps to load in place of the original sources. Per variant, the
+// approximate ALU op and texture fetch counts before and after optimization go to stdout.
+//
+// Build with (GLSL_OPTIMIZER being a built checkout of https://github.com/aras-p/glsl-optimizer):
+//
+//	g++ -O2 -I./include -I${GLSL_OPTIMIZER}/src/glsl -DANDROID -DPLATFORM_GLES -o shader_opt shader_opt.cpp
+//		util_preproc.cpp util_permute.cpp util_file.cpp util_misc.cpp -L${GLSL_OPTIMIZER}
+//		-lglsl_optimizer -lglcpp-library -lmesa -lGLESv2
+//
+// Usage:
+//
+//	shader_opt <shader_vert> <shader_frag> <output_dir> <macro>[,<macro>..]
+
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "glsl_optimizer.h"
+#include "util_misc.hpp"
+#include "util_preproc.hpp"
+#include "util_permute.hpp"
+
+namespace util {
+
+// no GL context in this tool - there is nothing to report
+bool reportGLError(FILE*)
+{
+	return false;
+}
+
+} // namespace util
+
+namespace {
+
+struct OpCount
+{
+	unsigned alu;
+	unsigned tex;
+};
+
+const char* const tex_func[] = {
+	"texture2D",
+	"texture2DProj",
+	"texture2DLod",
+	"texture2DProjLod",
+	"textureCube",
+	"textureCubeLod"
+};
+
+const char* const alu_func[] = {
+	"radians", "degrees", "sin", "cos", "tan", "asin", "acos", "atan",
+	"pow", "exp", "log", "exp2", "log2", "sqrt", "inversesqrt",
+	"abs", "sign", "floor", "ceil", "fract", "mod", "min", "max", "clamp", "mix", "step", "smoothstep",
+	"length", "distance", "dot", "cross", "normalize", "faceforward", "reflect", "refract",
+	"matrixCompMult", "lessThan", "lessThanEqual", "greaterThan", "greaterThanEqual", "equal", "notEqual",
+	"any", "all", "not", "dFdx", "dFdy", "fwidth"
+};
+
+bool inList(
+	const std::string& name,
+	const char* const* const list,
+	const size_t count)
+{
+	for (size_t i = 0; i < count; ++i)
+		if (name == list[i])
+			return true;
+
+	return false;
+}
+
+// approximate op count of flat GLSL, as printed by the optimizer: arithmetic operators and built-in
+// function calls within function bodies, one op each regardless of vector width; constructors and
+// swizzles count as free moves
+OpCount countOps(
+	const char* const src)
+{
+	OpCount count = { 0, 0 };
+	unsigned depth = 0;
+	bool line_start = true;
+
+	for (const char* p = src; '\0' != *p; ++p) {
+		// skip directives
+		if (line_start && '#' == *p) {
+			while ('\0' != p[1] && '\n' != p[1])
+				++p;
+
+			continue;
+		}
+
+		line_start = '\n' == *p || (line_start && isspace(*p));
+
+		if ('{' == *p) {
+			++depth;
+			continue;
+		}
+
+		if ('}' == *p) {
+			depth -= 0 != depth;
+			continue;
+		}
+
+		if (isalpha(*p) || '_' == *p) {
+			const char* const start = p;
+
+			while (isalnum(p[1]) || '_' == p[1])
+				++p;
+
+			if (0 == depth || '(' != p[1])
+				continue;
+
+			const std::string name(start, p + 1);
+
+			if (inList(name, tex_func, sizeof(tex_func) / sizeof(tex_func[0])))
+				++count.tex;
+			else
+			if (inList(name, alu_func, sizeof(alu_func) / sizeof(alu_func[0])))
+				++count.alu;
+
+			continue;
+		}
+
+		// skip number literals, along with the signs of their exponents
+		if (isdigit(*p) || ('.' == *p && isdigit(p[1]))) {
+			while (isalnum(p[1]) || '.' == p[1] ||
+				(('+' == p[1] || '-' == p[1]) && ('e' == *p || 'E' == *p)))
+				++p;
+
+			continue;
+		}
+
+		if (0 == depth)
+			continue;
+
+		if ('+' == *p || '-' == *p) {
+			// increments and decrements count as one op
+			if (p[1] == *p)
+				++p;
+
+			++count.alu;
+			continue;
+		}
+
+		if ('*' == *p || '/' == *p)
+			++count.alu;
+	}
+
+	return count;
+}
+
+std::string concatSource(
+	const util::ShaderSource& src)
+{
+	std::string str;
+
+	for (GLsizei i = 0; i < src.count(); ++i)
+		str.append(src.strings()[i], src.lengths()[i]);
+
+	return str;
+}
+
+bool writeFile(
+	const std::string& filename,
+	const char* const content)
+{
+	FILE* const f = fopen(filename.c_str(), "wb");
+
+	if (0 == f)
+		return false;
+
+	const size_t len = strlen(content);
+	const bool success = len == fwrite(content, 1, len, f);
+	fclose(f);
+
+	return success;
+}
+
+// the apps' preprocessor supplies the #version line, so drop the optimizer's
+const char* skipVersion(
+	const char* const src)
+{
+	if (strncmp(src, "#version", sizeof("#version") - 1))
+		return src;
+
+	const char* const eol = strchr(src, '\n');
+	return 0 != eol ? eol + 1 : src + strlen(src);
+}
+
+// output name of a variant: <output_dir>/<base>.<mask><ext>, e.g. opt/phong_bump_tang.5.glslf
+std::string variantFilename(
+	const char* const output_dir,
+	const char* const filename,
+	const unsigned mask)
+{
+	const char* const slash = strrchr(filename, '/');
+	const std::string base(0 != slash ? slash + 1 : filename);
+	const size_t dot = base.rfind('.');
+
+	char suffix[16];
+	snprintf(suffix, sizeof(suffix), ".%u", mask);
+
+	if (std::string::npos == dot)
+		return std::string(output_dir) + '/' + base + suffix;
+
+	return std::string(output_dir) + '/' + base.substr(0, dot) + suffix + base.substr(dot);
+}
+
+bool optimizeVariant(
+	glslopt_ctx* const ctx,
+	const glslopt_shader_type type,
+	const char* const filename,
+	const char* const output_dir,
+	const util::ShaderPermutations& permutations,
+	const unsigned mask)
+{
+	const util::ShaderSource* const src = util::preprocessShader(filename, permutations.getDefines(mask));
+
+	if (0 == src) {
+		fprintf(stderr, "error: cannot preprocess '%s'\n", filename);
+		return false;
+	}
+
+	glslopt_shader* const shader = glslopt_optimize(ctx, type, concatSource(*src).c_str(), 0);
+	const std::string output = variantFilename(output_dir, filename, mask);
+	bool success = glslopt_get_status(shader);
+
+	if (!success)
+		fprintf(stderr, "error: cannot optimize '%s' variant %u:\n%s\n", filename, mask, glslopt_get_log(shader));
+	else
+	if (!writeFile(output, skipVersion(glslopt_get_output(shader)))) {
+		fprintf(stderr, "error: cannot write '%s'\n", output.c_str());
+		success = false;
+	}
+	else {
+		const OpCount before = countOps(glslopt_get_raw_output(shader));
+		const OpCount after = countOps(glslopt_get_output(shader));
+
+		fprintf(stdout, "%s (%s): alu ops %u -> %u, tex %u -> %u\n", output.c_str(),
+			permutations.getName(mask).c_str(), before.alu, after.alu, before.tex, after.tex);
+	}
+
+	glslopt_shader_delete(shader);
+	return success;
+}
+
+void usage(
+	const char* const name)
+{
+	fprintf(stderr, "usage: %s <shader_vert> <shader_frag> <output_dir> <macro>[,<macro>..]\n", name);
+}
+
+} // namespace
+
+int main(
+	int argc,
+	char** argv)
+{
+	if (5 != argc) {
+		usage(argv[0]);
+		return 1;
+	}
+
+	std::vector< std::string > macro;
+
+	for (const char* p = argv[4]; '\0' != *p; ) {
+		const char* const comma = strchr(p, ',');
+		const size_t len = 0 != comma ? size_t(comma - p) : strlen(p);
+
+		if (0 == len) {
+			usage(argv[0]);
+			return 1;
+		}
+
+		macro.push_back(std::string(p, len));
+		p += len + (0 != comma);
+	}
+
+	std::vector< const char* > macro_str;
+
+	for (size_t i = 0; i < macro.size(); ++i)
+		macro_str.push_back(macro[i].c_str());
+
+	const util::ShaderPermutations permutations(macro.size(), &macro_str[0], &macro_str[0]);
+	glslopt_ctx* const ctx = glslopt_initialize(kGlslTargetOpenGLES20);
+	bool success = true;
+
+	for (unsigned mask = 0; mask < permutations.getVariantCount(); ++mask) {
+		success = optimizeVariant(ctx, kGlslOptShaderVertex, argv[1], argv[3], permutations, mask) && success;
+		success = optimizeVariant(ctx, kGlslOptShaderFragment, argv[2], argv[3], permutations, mask) && success;
+	}
+
+	glslopt_cleanup(ctx);
+	return success ? 0 : 1;
+}
@@ -0,0 +1,256 @@
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#include "util_bench.hpp"
+
+namespace util {
+
+const char bench_record_prefix[] = "bench-record: ";
+
+bool reduceSamples(
+	std::vector< double >& sample,
+	BenchStats& stats)
+{
+	const size_t count = sample.size();
+
+	if (0 == count)
+		return false;
+
+	std::sort(sample.begin(), sample.end());
+
+	double sum = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		sum += sample[i];
+
+	const double mean = sum / count;
+
+	double sum_sq = 0.0;
+	for (size_t i = 0; i < count; ++i)
+		sum_sq += (sample[i] - mean) * (sample[i] - mean);
+
+	// nearest-rank percentiles
+	const size_t idx_p95 = size_t(ceil(count * .95)) - 1;
+
+	stats.count = unsigned(count);
+	stats.min = sample.front();
+	stats.max = sample.back();
+	stats.mean = mean;
+	stats.median = count & 1 ? sample[count / 2] : (sample[count / 2 - 1] + sample[count / 2]) * .5;
+	stats.p95 = sample[idx_p95];
+	stats.stddev = count > 1 ? sqrt(sum_sq / (count - 1)) : 0.0;
+
+	return true;
+}
+
+BenchPhase::BenchPhase(
+	const unsigned warmup,
+	const unsigned frames)
+: num_warmup(warmup)
+, num_frames(frames)
+, frame(0)
+{
+	assert(0 != frames);
+	sample.reserve(frames);
+}
+
+void BenchPhase::reset()
+{
+	frame = 0;
+	sample.clear();
+}
+
+bool BenchPhase::addFrame(
+	const uint64_t duration_ns)
+{
+	if (complete())
+		return true;
+
+	if (frame++ >= num_warmup)
+		sample.push_back(duration_ns * 1e-6);
+
+	return complete();
+}
+
+bool BenchPhase::measuring() const
+{
+	return frame >= num_warmup;
+}
+
+bool BenchPhase::complete() const
+{
+	return frame >= num_warmup + num_frames;
+}
+
+const std::vector< double >& BenchPhase::samples() const
+{
+	return sample;
+}
+
+bool BenchPhase::getStats(
+	BenchStats& stats) const
+{
+	std::vector< double > sorted(sample);
+	return reduceSamples(sorted, stats);
+}
+
+static void appendKey(
+	std::string& dst,
+	const char* const name)
+{
+	if (!dst.empty())
+		dst += ',';
+
+	dst += '"';
+	dst += name;
+	dst += "\":";
+}
+
+static void appendNumber(
+	std::string& dst,
+	const double value)
+{
+	// json has no representation for inf and nan
+	if (isfinite(value)) {
+		char buffer[32];
+		snprintf(buffer, sizeof(buffer), "%.6g", value);
+		dst += buffer;
+	}
+	else
+		dst += "null";
+}
+
+BenchRecord& BenchRecord::param(
+	const char* const name,
+	const char* const value)
+{
+	assert(0 != name && 0 != value);
+
+	appendKey(params, name);
+	params += '"';
+	params += value;
+	params += '"';
+	return *this;
+}
+
+BenchRecord& BenchRecord::param(
+	const char* const name,
+	const double value)
+{
+	assert(0 != name);
+
+	appendKey(params, name);
+	appendNumber(params, value);
+	return *this;
+}
+
+BenchRecord& BenchRecord::metric(
+	const char* const name,
+	const double value)
+{
+	assert(0 != name);
+
+	appendKey(metrics, name);
+	appendNumber(metrics, value);
+	return *this;
+}
+
+BenchRecord& BenchRecord::metric(
+	const char* const name,
+	const BenchStats& stats)
+{
+	assert(0 != name);
+
+	const struct {
+		const char* suffix;
+		double value;
+	} field[] = {
+		{ "_min",    stats.min },
+		{ "_max",    stats.max },
+		{ "_mean",   stats.mean },
+		{ "_median", stats.median },
+		{ "_p95",    stats.p95 },
+		{ "_stddev", stats.stddev }
+	};
+
+	for (size_t i = 0; i < sizeof(field) / sizeof(field[0]); ++i)
+		metric((std::string(name) + field[i].suffix).c_str(), field[i].value);
+
+	return *this;
+}
+
+void BenchRecord::emit(
+	const char* const scene,
+	FILE* f) const
+{
+	assert(0 != scene);
+
+	fprintf(f, "%s{\"scene\":\"%s\",\"params\":{%s},\"metrics\":{%s}}\n",
+		bench_record_prefix, scene, params.c_str(), metrics.c_str());
+	fflush(f);
+}
+
+size_t parseUintList(
+	const char* const arg,
+	unsigned* const out,
+	const size_t capacity)
+{
+	assert(0 != arg && 0 != out);
+
+	size_t count = 0;
+
+	for (const char* p = arg; *p;) {
+		unsigned value;
+		int len;
+
+		if (count == capacity || 1 != sscanf(p, "%u%n", &value, &len))
+			return 0;
+
+		out[count++] = value;
+		p += len;
+
+		if (*p == '\0')
+			break;
+
+		if (*p != ',' || *++p == '\0')
+			return 0;
+	}
+
+	return count;
+}
+
+size_t parseNameList(
+	const char* const arg,
+	const char* const* const dict,
+	const size_t dict_size,
+	unsigned* const out,
+	const size_t capacity)
+{
+	assert(0 != arg && 0 != dict && 0 != out);
+
+	size_t count = 0;
+
+	for (const char* p = arg; *p; ++count) {
+		const char* const end = strchrnul(p, ',');
+		const size_t len = end - p;
+		size_t i = 0;
+
+		while (i < dict_size && (strlen(dict[i]) != len || strncmp(dict[i], p, len)))
+			++i;
+
+		if (count == capacity || i == dict_size)
+			return 0;
+
+		out[count] = unsigned(i);
+		p = end;
+
+		if (*p == ',' && *++p == '\0')
+			return 0;
+	}
+
+	return count;
+}
+
+} // namespace util
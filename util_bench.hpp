@@ -0,0 +1,111 @@
+#ifndef util_bench_H__
+#define util_bench_H__
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace util {
+
+struct BenchStats
+{
+	unsigned count;
+	double min;
+	double max;
+	double mean;
+	double median;
+	double p95;
+	double stddev;
+};
+
+// reduce a set of samples to summary statistics; samples get sorted in place
+bool reduceSamples(
+	std::vector< double >& sample,
+	BenchStats& stats);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchPhase steps a single benchmark configuration through a number of warmup frames, followed by
+// a number of measured frames, collecting one duration sample (in ms) per measured frame.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class BenchPhase
+{
+	unsigned num_warmup;
+	unsigned num_frames;
+	unsigned frame;
+	std::vector< double > sample;
+
+public:
+	BenchPhase(
+		const unsigned warmup,
+		const unsigned frames);
+
+	void reset();
+
+	// account for a frame of the given duration; return true once the measurement is complete
+	bool addFrame(
+		const uint64_t duration_ns);
+
+	bool measuring() const;
+	bool complete() const;
+
+	const std::vector< double >& samples() const;
+
+	bool getStats(
+		BenchStats& stats) const;
+};
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// BenchRecord collects the parameters and the metrics of a benchmark configuration and emits them
+// as a single-line json object, prefixed with bench_record_prefix, for the runner to pick up.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+extern const char bench_record_prefix[];
+
+class BenchRecord
+{
+	std::string params;
+	std::string metrics;
+
+public:
+	BenchRecord& param(
+		const char* const name,
+		const char* const value);
+
+	BenchRecord& param(
+		const char* const name,
+		const double value);
+
+	BenchRecord& metric(
+		const char* const name,
+		const double value);
+
+	// emit name_mean, name_median, name_p95, etc
+	BenchRecord& metric(
+		const char* const name,
+		const BenchStats& stats);
+
+	void emit(
+		const char* const scene,
+		FILE* f = stdout) const;
+};
+
+// parse a comma-separated list of unsigned integers; return number of elements parsed, 0 on error
+size_t parseUintList(
+	const char* const arg,
+	unsigned* const out,
+	const size_t capacity);
+
+// parse a comma-separated list of names from a given dictionary into dictionary indices;
+// return number of elements parsed, 0 on error
+size_t parseNameList(
+	const char* const arg,
+	const char* const* const dict,
+	const size_t dict_size,
+	unsigned* const out,
+	const size_t capacity);
+
+} // namespace util
+
+#endif // util_bench_H__
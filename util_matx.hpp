@@ -0,0 +1,95 @@
+#ifndef util_matx_H__
+#define util_matx_H__
+
+#include <stddef.h>
+#include <math.h>
+
+#include "util_misc.hpp"
+
+namespace util {
+
+// 3x3 matrix, transforming row vectors: v' = v * m
+class matx3;
+inline matx3 matx3_mul(const matx3&, const matx3&);
+
+class matx3 {
+	friend matx3 matx3_mul(const matx3&, const matx3&);
+	float m[3][3];
+
+public:
+	matx3() {}
+
+	matx3(
+		const float c0_0, const float c0_1, const float c0_2,
+		const float c1_0, const float c1_1, const float c1_2,
+		const float c2_0, const float c2_1, const float c2_2)
+	{
+		m[0][0] = c0_0;
+		m[0][1] = c0_1;
+		m[0][2] = c0_2;
+		m[1][0] = c1_0;
+		m[1][1] = c1_1;
+		m[1][2] = c1_2;
+		m[2][0] = c2_0;
+		m[2][1] = c2_1;
+		m[2][2] = c2_2;
+	}
+
+	const float (& operator[](const size_t i) const)[3] { return m[i]; }
+
+	template < size_t NUM_VECT, size_t NUM_ELEM >
+	void transform(
+		const float (& a)[NUM_VECT][NUM_ELEM],
+		float (& out)[NUM_VECT][NUM_ELEM]) const {
+
+		const size_t num_vect = NUM_VECT;
+		const size_t num_elem = 3;
+		const util::compile_assert< num_elem <= NUM_ELEM > assert_num_elem;
+
+		for (size_t j = 0; j < num_vect; ++j) {
+			float out_j[num_elem];
+			const float a_j0 = a[j][0];
+			for (size_t i = 0; i < num_elem; ++i) {
+				out_j[i] = a_j0 * m[0][i];
+			}
+			for (size_t k = 1; k < num_elem; ++k) {
+				const float a_jk = a[j][k];
+				for (size_t i = 0; i < num_elem; ++i) {
+					out_j[i] += a_jk * m[k][i];
+				}
+			}
+			for (size_t i = 0; i < num_elem; ++i)
+				out[j][i] = out_j[i];
+			for (size_t i = num_elem; i < NUM_ELEM; ++i)
+				out[j][i] = a[j][i];
+		}
+	}
+};
+
+inline matx3 matx3_mul(
+	const matx3& ma,
+	const matx3& mb)
+{
+	matx3 mc;
+	mb.transform(ma.m, mc.m);
+	return mc;
+}
+
+inline matx3 matx3_rotate(
+	const float a,
+	const float x,
+	const float y,
+	const float z)
+{
+	const float sin_a = sinf(a);
+	const float cos_a = cosf(a);
+
+	return matx3(
+		x * x + cos_a * (1 - x * x),         x * y - cos_a * (x * y) + sin_a * z, x * z - cos_a * (x * z) - sin_a * y,
+		y * x - cos_a * (y * x) - sin_a * z, y * y + cos_a * (1 - y * y),         y * z - cos_a * (y * z) + sin_a * x,
+		z * x - cos_a * (z * x) + sin_a * y, z * y - cos_a * (z * y) - sin_a * x, z * z + cos_a * (1 - z * z));
+}
+
+} // namespace util
+
+#endif // util_matx_H__
@@ -0,0 +1,272 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+#include "util_mesh.hpp"
+
+namespace util {
+
+namespace forsyth {
+
+// simulated LRU cache size and scoring parameters as per Tom Forsyth's "Linear-Speed Vertex Cache
+// Optimisation"
+static const int cache_size = 32;
+static const float cache_decay_power = 1.5f;
+static const float last_tri_score = .75f;
+static const float valence_boost_scale = 2.f;
+static const float valence_boost_power = .5f;
+
+static float vertex_score(
+	const int cache_pos,
+	const unsigned remaining_tris)
+{
+	if (0 == remaining_tris)
+		return -1.f;
+
+	float score = 0.f;
+
+	if (cache_pos >= 0) {
+		// the three most recent vertices belong to the last triangle; score them the same
+		if (cache_pos < 3)
+			score = last_tri_score;
+		else {
+			const float scaler = 1.f / (cache_size - 3);
+			score = powf(1.f - (cache_pos - 3) * scaler, cache_decay_power);
+		}
+	}
+
+	// boost vertices with few remaining triangles, to get rid of lone triangles early
+	return score + valence_boost_scale * powf(float(remaining_tris), -valence_boost_power);
+}
+
+} // namespace forsyth
+
+bool optimizeVertexCache(
+	uint32_t (* const tri)[3],
+	const size_t num_tris,
+	const size_t num_verts)
+{
+	assert(0 != tri);
+
+	if (0 == num_tris)
+		return true;
+
+	// vertex-to-triangle adjacency, in compressed-row form
+	std::vector< unsigned > tri_start(num_verts + 1, 0);
+	std::vector< unsigned > remaining(num_verts, 0);
+
+	for (size_t i = 0; i < num_tris; ++i)
+		for (unsigned j = 0; j < 3; ++j) {
+			if (tri[i][j] >= num_verts)
+				return false;
+
+			++remaining[tri[i][j]];
+		}
+
+	for (size_t i = 0; i < num_verts; ++i)
+		tri_start[i + 1] = tri_start[i] + remaining[i];
+
+	std::vector< uint32_t > vert_tris(num_tris * 3);
+	std::vector< unsigned > fill(tri_start.begin(), tri_start.end() - 1);
+
+	for (size_t i = 0; i < num_tris; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			vert_tris[fill[tri[i][j]]++] = uint32_t(i);
+
+	std::vector< int > cache_pos(num_verts, -1);
+	std::vector< float > vert_score(num_verts);
+	std::vector< float > tri_score(num_tris, 0.f);
+	std::vector< bool > tri_added(num_tris, false);
+
+	for (size_t i = 0; i < num_verts; ++i)
+		vert_score[i] = forsyth::vertex_score(-1, remaining[i]);
+
+	for (size_t i = 0; i < num_tris; ++i)
+		for (unsigned j = 0; j < 3; ++j)
+			tri_score[i] += vert_score[tri[i][j]];
+
+	std::vector< uint32_t > out(num_tris * 3);
+
+	// the LRU cache holds up to 3 extra entries while a triangle gets pushed
+	uint32_t cache[forsyth::cache_size + 3];
+	int cache_count = 0;
+
+	size_t best_tri = 0;
+	for (size_t i = 1; i < num_tris; ++i)
+		if (tri_score[i] > tri_score[best_tri])
+			best_tri = i;
+
+	size_t scan_cursor = 0;
+
+	for (size_t n = 0; n < num_tris; ++n) {
+		// emit the best triangle
+		tri_added[best_tri] = true;
+
+		for (unsigned j = 0; j < 3; ++j)
+			out[n * 3 + j] = tri[best_tri][j];
+
+		// detach it from its vertices' adjacency
+		for (unsigned j = 0; j < 3; ++j) {
+			const uint32_t v = tri[best_tri][j];
+			uint32_t* const first = &vert_tris[tri_start[v]];
+			uint32_t* const last = first + remaining[v] - 1;
+
+			for (uint32_t* t = first; t <= last; ++t)
+				if (*t == best_tri) {
+					*t = *last;
+					break;
+				}
+
+			--remaining[v];
+		}
+
+		// push its vertices to the front of the cache, most recent first
+		uint32_t new_cache[forsyth::cache_size + 3];
+		int new_count = 0;
+
+		for (unsigned j = 0; j < 3; ++j)
+			new_cache[new_count++] = tri[best_tri][j];
+
+		for (int i = 0; i < cache_count; ++i) {
+			const uint32_t v = cache[i];
+
+			if (v != tri[best_tri][0] && v != tri[best_tri][1] && v != tri[best_tri][2])
+				new_cache[new_count++] = v;
+		}
+
+		// rescore everything that was in the cache, including the evicted tail
+		for (int i = 0; i < new_count; ++i) {
+			const uint32_t v = new_cache[i];
+			const int pos = i < forsyth::cache_size ? i : -1;
+
+			cache_pos[v] = pos;
+			const float new_score = forsyth::vertex_score(pos, remaining[v]);
+			const float delta = new_score - vert_score[v];
+			vert_score[v] = new_score;
+
+			for (unsigned k = 0; k < remaining[v]; ++k)
+				tri_score[vert_tris[tri_start[v] + k]] += delta;
+		}
+
+		cache_count = new_count < forsyth::cache_size ? new_count : forsyth::cache_size;
+		memcpy(cache, new_cache, sizeof(cache[0]) * cache_count);
+
+		// the next triangle is the best one among those adjacent to the cache
+		float best_score = -1.f;
+		best_tri = num_tris;
+
+		for (int i = 0; i < cache_count; ++i) {
+			const uint32_t v = cache[i];
+
+			for (unsigned k = 0; k < remaining[v]; ++k) {
+				const uint32_t t = vert_tris[tri_start[v] + k];
+
+				if (tri_score[t] > best_score) {
+					best_score = tri_score[t];
+					best_tri = t;
+				}
+			}
+		}
+
+		// cache exhausted - resume from the next unemitted triangle
+		if (num_tris == best_tri) {
+			while (scan_cursor < num_tris && tri_added[scan_cursor])
+				++scan_cursor;
+
+			best_tri = scan_cursor;
+		}
+	}
+
+	memcpy(tri, &out[0], sizeof(tri[0]) * num_tris);
+	return true;
+}
+
+static uint32_t xorshift32(
+	uint32_t& state)
+{
+	state ^= state << 13;
+	state ^= state >> 17;
+	state ^= state << 5;
+	return state;
+}
+
+void shuffleTriangles(
+	uint32_t (* const tri)[3],
+	const size_t num_tris,
+	uint32_t seed)
+{
+	assert(0 != tri);
+	assert(0 != seed);
+
+	// Fisher-Yates
+	for (size_t i = num_tris; i > 1; --i) {
+		const size_t j = xorshift32(seed) % i;
+
+		for (unsigned k = 0; k < 3; ++k) {
+			const uint32_t t = tri[i - 1][k];
+			tri[i - 1][k] = tri[j][k];
+			tri[j][k] = t;
+		}
+	}
+}
+
+void reorderVertsByFirstUse(
+	uint32_t (* const tri)[3],
+	const size_t num_tris,
+	const size_t num_verts,
+	uint32_t* const remap)
+{
+	assert(0 != tri);
+	assert(0 != remap);
+
+	memset(remap, 0xff, sizeof(remap[0]) * num_verts);
+	uint32_t next = 0;
+
+	for (size_t i = 0; i < num_tris; ++i)
+		for (unsigned j = 0; j < 3; ++j) {
+			const uint32_t v = tri[i][j];
+			assert(v < num_verts);
+
+			if (~0U == remap[v])
+				remap[v] = next++;
+
+			tri[i][j] = remap[v];
+		}
+}
+
+double computeACMR(
+	const uint32_t (* const tri)[3],
+	const size_t num_tris,
+	const unsigned cache_size)
+{
+	assert(0 != tri);
+	assert(0 != cache_size);
+
+	if (0 == num_tris)
+		return 0.0;
+
+	std::vector< uint32_t > fifo(cache_size, ~0U);
+	unsigned head = 0;
+	size_t misses = 0;
+
+	for (size_t i = 0; i < num_tris; ++i)
+		for (unsigned j = 0; j < 3; ++j) {
+			const uint32_t v = tri[i][j];
+			bool hit = false;
+
+			for (unsigned k = 0; k < cache_size && !hit; ++k)
+				hit = fifo[k] == v;
+
+			if (!hit) {
+				fifo[head] = v;
+				head = (head + 1) % cache_size;
+				++misses;
+			}
+		}
+
+	return double(misses) / num_tris;
+}
+
+} // namespace util
@@ -0,0 +1,299 @@
+#ifndef util_mesh_H__
+#define util_mesh_H__
+
+#include <stdint.h>
+#include <stddef.h>
+#include <assert.h>
+#include <math.h>
+#include <vector>
+
+namespace util {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Polar sphere bent from a grid of rows x cols vertices; the poles get cols - 1 vertices each so
+// that every polar triangle has its own texcoord. Vertex types need to provide float pos[3],
+// nrm[3] and txc[2]; index types need to be able to represent num_verts - 1.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+inline size_t polarSphereNumVerts(
+	const int rows,
+	const int cols)
+{
+	assert(rows > 2);
+	assert(cols > 3);
+
+	return (rows - 2) * cols + 2 * (cols - 1);
+}
+
+inline size_t polarSphereNumTris(
+	const int rows,
+	const int cols)
+{
+	assert(rows > 2);
+	assert(cols > 3);
+
+	return ((rows - 3) * 2 + 2) * (cols - 1);
+}
+
+template < typename VERTEX_T >
+void fillPolarSphereVerts(
+	VERTEX_T* const arr,
+	const int rows,
+	const int cols,
+	const float r,
+	const float tile)
+{
+	assert(0 != arr);
+	assert(rows > 2);
+	assert(cols > 3);
+
+	const size_t num_verts = polarSphereNumVerts(rows, cols);
+	(void) num_verts; // read by asserts only
+	size_t ai = 0;
+
+	// north pole
+	for (int j = 0; j < cols - 1; ++j) {
+		assert(ai < num_verts);
+
+		arr[ai].pos[0] = 0.f;
+		arr[ai].pos[1] = 0.f;
+		arr[ai].pos[2] = r;
+
+		arr[ai].nrm[0] = 0.f;
+		arr[ai].nrm[1] = 0.f;
+		arr[ai].nrm[2] = 1.f;
+
+		arr[ai].txc[0] = tile * (j + .5f) / (cols - 1);
+		arr[ai].txc[1] = tile * .5f;
+		++ai;
+	}
+
+	// interior
+	for (int i = 1; i < rows - 1; ++i)
+		for (int j = 0; j < cols; ++j) {
+			assert(ai < num_verts);
+
+			const float azim = j * 2 * M_PI / (cols - 1);
+			const float decl = M_PI_2 - i * M_PI / (rows - 1);
+			const float sin_azim = sinf(azim);
+			const float cos_azim = cosf(azim);
+			const float sin_decl = sinf(decl);
+			const float cos_decl = cosf(decl);
+
+			arr[ai].pos[0] = r * cos_decl * cos_azim;
+			arr[ai].pos[1] = r * cos_decl * sin_azim;
+			arr[ai].pos[2] = r * sin_decl;
+
+			arr[ai].nrm[0] = cos_decl * cos_azim;
+			arr[ai].nrm[1] = cos_decl * sin_azim;
+			arr[ai].nrm[2] = sin_decl;
+
+			arr[ai].txc[0] = tile * j / (cols - 1);
+			arr[ai].txc[1] = tile * (rows - 1 - i) / (2 * rows - 2);
+			++ai;
+		}
+
+	// south pole
+	for (int j = 0; j < cols - 1; ++j) {
+		assert(ai < num_verts);
+
+		arr[ai].pos[0] = 0.f;
+		arr[ai].pos[1] = 0.f;
+		arr[ai].pos[2] = -r;
+
+		arr[ai].nrm[0] = 0.f;
+		arr[ai].nrm[1] = 0.f;
+		arr[ai].nrm[2] = -1.f;
+
+		arr[ai].txc[0] = tile * (j + .5f) / (cols - 1);
+		arr[ai].txc[1] = 0.f;
+		++ai;
+	}
+
+	assert(ai == num_verts);
+}
+
+template < typename INDEX_T >
+void fillPolarSphereIndices(
+	INDEX_T (* const idx)[3],
+	const int rows,
+	const int cols)
+{
+	assert(0 != idx);
+	assert(rows > 2);
+	assert(cols > 3);
+
+	const size_t num_tris = polarSphereNumTris(rows, cols);
+	(void) num_tris; // read by asserts only
+	size_t ii = 0;
+
+	// north pole
+	for (int j = 0; j < cols - 1; ++j) {
+		assert(ii < num_tris);
+		idx[ii][0] = INDEX_T(j);
+		idx[ii][1] = INDEX_T(j + cols - 1);
+		idx[ii][2] = INDEX_T(j + cols);
+		++ii;
+	}
+
+	// interior
+	for (int i = 1; i < rows - 2; ++i)
+		for (int j = 0; j < cols - 1; ++j) {
+			assert(ii < num_tris);
+			idx[ii][0] = INDEX_T(j + i * cols);
+			idx[ii][1] = INDEX_T(j + i * cols - 1);
+			idx[ii][2] = INDEX_T(j + (i + 1) * cols);
+			++ii;
+
+			assert(ii < num_tris);
+			idx[ii][0] = INDEX_T(j + (i + 1) * cols - 1);
+			idx[ii][1] = INDEX_T(j + (i + 1) * cols);
+			idx[ii][2] = INDEX_T(j + i * cols - 1);
+			++ii;
+		}
+
+	// south pole
+	for (int j = 0; j < cols - 1; ++j) {
+		assert(ii < num_tris);
+		idx[ii][0] = INDEX_T(j + (rows - 2) * cols);
+		idx[ii][1] = INDEX_T(j + (rows - 2) * cols - 1);
+		idx[ii][2] = INDEX_T(j + (rows - 2) * cols + cols - 1);
+		++ii;
+	}
+
+	assert(ii == num_tris);
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Per-vertex tangent frames of an indexed triangle mesh, from the texcoord gradients of its triangles
+// (Lengyel's method): tng[0..2] receives the unit tangent along increasing u, orthogonalized against
+// the vertex normal, and tng[3] the handedness, so that bitangent = cross(nrm, tng.xyz) * tng.w
+// points along increasing v. Vertex types need to provide float pos[3], nrm[3], txc[2] and tng[4].
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+template < typename VERTEX_T, typename INDEX_T >
+void fillTangents(
+	VERTEX_T* const arr,
+	const size_t num_verts,
+	INDEX_T (* const idx)[3],
+	const size_t num_tris)
+{
+	assert(0 != arr);
+	assert(0 != idx);
+
+	// texcoord gradients accumulated per vertex: along u into tng, along v into bitan
+	std::vector< float > bitan(num_verts * 3, 0.f);
+
+	for (size_t i = 0; i < num_verts; ++i)
+		for (unsigned k = 0; k < 4; ++k)
+			arr[i].tng[k] = 0.f;
+
+	for (size_t i = 0; i < num_tris; ++i) {
+		const size_t i0 = idx[i][0];
+		const size_t i1 = idx[i][1];
+		const size_t i2 = idx[i][2];
+
+		assert(i0 < num_verts && i1 < num_verts && i2 < num_verts);
+
+		float e1[3], e2[3];
+
+		for (unsigned k = 0; k < 3; ++k) {
+			e1[k] = arr[i1].pos[k] - arr[i0].pos[k];
+			e2[k] = arr[i2].pos[k] - arr[i0].pos[k];
+		}
+
+		const float du1 = arr[i1].txc[0] - arr[i0].txc[0];
+		const float dv1 = arr[i1].txc[1] - arr[i0].txc[1];
+		const float du2 = arr[i2].txc[0] - arr[i0].txc[0];
+		const float dv2 = arr[i2].txc[1] - arr[i0].txc[1];
+		const float det = du1 * dv2 - du2 * dv1;
+
+		// no texcoord gradients across a triangle degenerate in texture space
+		if (0.f == det)
+			continue;
+
+		const float rcp = 1.f / det;
+		const size_t tri[3] = { i0, i1, i2 };
+
+		for (unsigned k = 0; k < 3; ++k) {
+			const float sdir = (e1[k] * dv2 - e2[k] * dv1) * rcp;
+			const float tdir = (e2[k] * du1 - e1[k] * du2) * rcp;
+
+			for (unsigned j = 0; j < 3; ++j) {
+				arr[tri[j]].tng[k] += sdir;
+				bitan[tri[j] * 3 + k] += tdir;
+			}
+		}
+	}
+
+	for (size_t i = 0; i < num_verts; ++i) {
+		const float* const n = arr[i].nrm;
+		float* const t = arr[i].tng;
+
+		// Gram-Schmidt against the normal
+		const float n_dot_t = n[0] * t[0] + n[1] * t[1] + n[2] * t[2];
+
+		for (unsigned k = 0; k < 3; ++k)
+			t[k] -= n[k] * n_dot_t;
+
+		float len = sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+
+		// no usable gradient - any direction in the tangent plane will do
+		if (0.f == len) {
+			const unsigned axis = fabsf(n[0]) < fabsf(n[1]) ?
+				(fabsf(n[0]) < fabsf(n[2]) ? 0 : 2) :
+				(fabsf(n[1]) < fabsf(n[2]) ? 1 : 2);
+
+			for (unsigned k = 0; k < 3; ++k)
+				t[k] = (k == axis ? 1.f : 0.f) - n[k] * n[axis];
+
+			len = sqrtf(t[0] * t[0] + t[1] * t[1] + t[2] * t[2]);
+		}
+
+		for (unsigned k = 0; k < 3; ++k)
+			t[k] /= len;
+
+		const float b[3] = {
+			n[1] * t[2] - n[2] * t[1],
+			n[2] * t[0] - n[0] * t[2],
+			n[0] * t[1] - n[1] * t[0]
+		};
+
+		const float* const tdir = &bitan[i * 3];
+		t[3] = b[0] * tdir[0] + b[1] * tdir[1] + b[2] * tdir[2] < 0.f ? -1.f : 1.f;
+	}
+}
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Index-order utilities, operating on 32-bit triangle lists
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// reorder triangles for post-transform vertex cache locality (Forsyth's linear-speed optimizer)
+bool optimizeVertexCache(
+	uint32_t (* const tri)[3],
+	const size_t num_tris,
+	const size_t num_verts);
+
+// reorder triangles randomly; deterministic for a given seed
+void shuffleTriangles(
+	uint32_t (* const tri)[3],
+	const size_t num_tris,
+	uint32_t seed);
+
+// renumber vertices in order of first use by the triangle list, for pre-transform fetch locality;
+// remap receives the new index of each old vertex, ~0 for unreferenced vertices
+void reorderVertsByFirstUse(
+	uint32_t (* const tri)[3],
+	const size_t num_tris,
+	const size_t num_verts,
+	uint32_t* const remap);
+
+// average cache miss ratio - transformed vertices per triangle - of a FIFO post-transform cache
+double computeACMR(
+	const uint32_t (* const tri)[3],
+	const size_t num_tris,
+	const unsigned cache_size);
+
+} // namespace util
+
+#endif // util_mesh_H__
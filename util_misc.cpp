@@ -6,6 +6,7 @@
 
 #include <assert.h>
 #include <stdlib.h>
+#include <string.h>
 #include <string>
 #include <iostream>
 #include <iomanip>
@@ -27,7 +28,7 @@ public:
 	}
 };
 
-static bool setupShaderFromString(
+bool util::setupShaderFromString(
 	const GLuint shader_name,
 	const char* const source,
 	const size_t length)
@@ -97,25 +98,13 @@ bool util::setupShader(
 	return setupShaderFromString(shader_name, source(), length);
 }
 
-bool util::setupShaderWithPatch(
-	const GLuint shader_name,
-	const char* const filename,
+size_t util::patchString(
+	std::string& str,
 	const size_t patch_count,
 	const std::string* const patch)
 {
-	assert(0 != filename);
 	assert(0 != patch);
 
-	size_t length;
-	const scoped_ptr< char, generic_free > source(get_buffer_from_file(filename, length));
-
-	if (0 == source()) {
-		std::cerr << __FUNCTION__ <<
-			" failed to read shader file '" << filename << "'" << std::endl;
-		return false;
-	}
-
-	std::string src_final(source(), length);
 	size_t npatched = 0;
 
 	for (size_t i = 0; i < patch_count; ++i) {
@@ -128,20 +117,68 @@ bool util::setupShaderWithPatch(
 		const size_t len_src = patch_src.length();
 		const size_t len_dst = patch_dst.length();
 
-		std::cout << "turn: " << patch_src << "\ninto: " << patch_dst << std::endl;
-
-		for (size_t pos = src_final.find(patch_src);
+		for (size_t pos = str.find(patch_src);
 			std::string::npos != pos;
-			pos = src_final.find(patch_src, pos + len_dst)) {
+			pos = str.find(patch_src, pos + len_dst)) {
 
-			src_final.replace(pos, len_src, patch_dst);
+			str.replace(pos, len_src, patch_dst);
 			++npatched;
 		}
 	}
 
-	std::cout << "substitutions: " << npatched << std::endl;
+	return npatched;
+}
+
+uint64_t util::hashFNV1a(
+	const void* const data,
+	const size_t size,
+	const uint64_t basis)
+{
+	const uint8_t* const byte = reinterpret_cast< const uint8_t* >(data);
+	uint64_t hash = basis;
+
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= byte[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+bool util::hasExtension(
+	const char* const name)
+{
+	const char* const extensions = reinterpret_cast< const char* >(glGetString(GL_EXTENSIONS));
+	const size_t len = strlen(name);
+
+	for (const char* ext = extensions; 0 != ext && 0 != (ext = strstr(ext, name)); ext += len)
+		if ((ext == extensions || ' ' == ext[-1]) && (' ' == ext[len] || '\0' == ext[len]))
+			return true;
 
-	return setupShaderFromString(shader_name, src_final.c_str(), src_final.length());
+	return false;
+}
+
+static const char* const attr_name[util::ATTR_LOC_COUNT] = {
+	"at_Vertex",
+	"at_Normal",
+	"at_BlendWeight",
+	"at_MultiTexCoord0",
+	"at_Index",
+	"at_Tangent"
+};
+
+const char* util::getAttrName(
+	const AttrLocation loc)
+{
+	assert(loc < ATTR_LOC_COUNT);
+	return attr_name[loc];
+}
+
+void util::bindAttribLocations(
+	const GLuint prog)
+{
+	for (unsigned i = 0; i < ATTR_LOC_COUNT; ++i)
+		glBindAttribLocation(prog, i, attr_name[i]);
 }
 
 bool util::setupProgram(
@@ -165,6 +202,7 @@ bool util::setupProgram(
 
 	glAttachShader(prog, shader_vert);
 	glAttachShader(prog, shader_frag);
+	bindAttribLocations(prog);
 	glLinkProgram(prog);
 
 	GLint success = GL_FALSE;
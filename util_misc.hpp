@@ -2,6 +2,7 @@
 #define util_misc_H__
 
 #include <stdio.h>
+#include <stdint.h>
 #if PLATFORM_GL
 	#include <GL/gl.h>
 #else
@@ -21,34 +22,82 @@ struct compile_assert< true > {
 	}
 };
 
+bool setupShaderFromString(
+	const GLuint shader_name,
+	const char* const source,
+	const size_t length);
+
 bool setupShader(
 	const GLuint shader_name,
 	const char* const filename);
 
-bool setupShaderWithPatch(
-	const GLuint shader_name,
-	const char* const filename,
+// apply (src, dst) string pairs in order, each to all its non-overlapping occurrences; patches with
+// an empty or identical src are skipped; return number of substitutions
+size_t patchString(
+	std::string& str,
 	const size_t patch_count,
 	const std::string* const patch);
 
+// attribute locations fixed across all programs: bound by name ahead of linking, so that vertex state
+// set up once per mesh serves every program that draws it
+enum AttrLocation {
+	ATTR_LOC_VERTEX,
+	ATTR_LOC_NORMAL,
+	ATTR_LOC_BLENDW,
+	ATTR_LOC_TCOORD,
+	ATTR_LOC_INDEX,
+	ATTR_LOC_TANGENT,
+
+	ATTR_LOC_COUNT,
+	ATTR_LOC_FORCE_UINT = -1U
+};
+
+// shader-side name of the attribute at a fixed location
+const char* getAttrName(
+	const AttrLocation loc);
+
+// bind all fixed-location attribute names of a program ahead of its linking
+void bindAttribLocations(
+	const GLuint prog);
+
+// link a program from compiled shaders, with attributes at their fixed locations
 bool setupProgram(
 	const GLuint prog,
 	const GLuint shader_vert,
 	const GLuint shader_frag);
 
+// check the GL extension string of the current context for a whole extension name
+bool hasExtension(
+	const char* const name);
+
 bool reportGLError(FILE* file = stderr);
 bool reportEGLError(FILE* file = stderr);
 
+// monotonic time in ns
+uint64_t time_ns();
+
+// 64-bit FNV-1a; chain calls by passing the previous result as basis
+uint64_t hashFNV1a(
+	const void* const data,
+	const size_t size,
+	const uint64_t basis = 0xcbf29ce484222325ULL);
+
 } // namespace util
 
 namespace hook {
 
-bool init_resources(
+// parse the app options; runs ahead of surface creation, so that requires_depth can answer for them
+bool parse_cli(
 	const unsigned argc,
 	const char* const* argv);
 
+bool init_resources();
 bool deinit_resources();
+
+// whether the surface needs a depth buffer, under the parsed options
 bool requires_depth();
+
+// render a frame; return false to end the main loop
 bool render_frame();
 bool set_num_drawcalls(const unsigned);
 unsigned get_num_drawcalls();
@@ -0,0 +1,156 @@
+#include <assert.h>
+#include <string>
+#include <vector>
+
+#include "util_permute.hpp"
+
+namespace util {
+
+ShaderPermutations::ShaderPermutations(
+	const size_t feature_count,
+	const char* const* const feature_name,
+	const char* const* const feature_macro)
+: name(feature_name, feature_name + feature_count)
+, macro(feature_macro, feature_macro + feature_count)
+, cost(size_t(1) << feature_count, -1.0)
+, built(size_t(1) << feature_count, false)
+{
+	assert(feature_count < sizeof(unsigned) * 8);
+}
+
+unsigned ShaderPermutations::getFeatureCount() const
+{
+	return unsigned(name.size());
+}
+
+unsigned ShaderPermutations::getVariantCount() const
+{
+	return unsigned(cost.size());
+}
+
+std::string ShaderPermutations::getDefines(
+	const unsigned mask) const
+{
+	assert(mask < getVariantCount());
+
+	std::string defines;
+
+	for (size_t i = 0; i < macro.size(); ++i)
+		defines += "#define " + macro[i] + (mask >> i & 1 ? " 1\n" : " 0\n");
+
+	return defines;
+}
+
+std::string ShaderPermutations::getName(
+	const unsigned mask) const
+{
+	assert(mask < getVariantCount());
+
+	std::string str;
+
+	for (size_t i = 0; i < name.size(); ++i)
+		if (mask >> i & 1) {
+			if (!str.empty())
+				str += '+';
+
+			str += name[i];
+		}
+
+	return str.empty() ? "none" : str;
+}
+
+bool ShaderPermutations::within(
+	const unsigned mask,
+	const unsigned required,
+	const unsigned desired)
+{
+	return required == (mask & required) && 0 == (mask & ~(desired | required));
+}
+
+void ShaderPermutations::setBuilt(
+	const unsigned mask)
+{
+	assert(mask < getVariantCount());
+	built[mask] = true;
+}
+
+bool ShaderPermutations::isBuilt(
+	const unsigned mask) const
+{
+	assert(mask < getVariantCount());
+	return built[mask];
+}
+
+void ShaderPermutations::setCost(
+	const unsigned mask,
+	const double c)
+{
+	assert(mask < getVariantCount());
+	cost[mask] = c;
+}
+
+double ShaderPermutations::getCost(
+	const unsigned mask) const
+{
+	assert(mask < getVariantCount());
+	return cost[mask];
+}
+
+static unsigned countBits(
+	unsigned mask)
+{
+	unsigned count = 0;
+
+	for (; 0 != mask; mask &= mask - 1)
+		++count;
+
+	return count;
+}
+
+// whether cost a beats cost b: a known cost beats an unknown one
+static bool isCheaper(
+	const double a,
+	const double b)
+{
+	return 0.0 <= a && (0.0 > b || a < b);
+}
+
+unsigned ShaderPermutations::select(
+	const unsigned required,
+	const unsigned desired,
+	const double budget) const
+{
+	unsigned best = -1U;
+	unsigned cheapest = -1U; // of known cost
+	unsigned richest = -1U;
+
+	for (unsigned mask = 0; mask < getVariantCount(); ++mask) {
+		if (!built[mask] || !within(mask, required, desired))
+			continue;
+
+		if (-1U == richest || countBits(mask) > countBits(richest))
+			richest = mask;
+
+		if (0.0 <= cost[mask] && (-1U == cheapest || isCheaper(cost[mask], cost[cheapest])))
+			cheapest = mask;
+
+		// unknown costs only fit an unlimited budget
+		if (0.0 <= budget && (0.0 > cost[mask] || cost[mask] > budget))
+			continue;
+
+		if (-1U == best ||
+			countBits(mask) > countBits(best) ||
+			(countBits(mask) == countBits(best) && isCheaper(cost[mask], cost[best]))) {
+
+			best = mask;
+		}
+	}
+
+	if (-1U != best)
+		return best;
+
+	// nothing fits: the cheapest known, or with no cost known, as for an unlimited budget
+	return -1U != cheapest ? cheapest : richest;
+}
+
+} // namespace util
@@ -0,0 +1,75 @@
+#ifndef util_permute_H__
+#define util_permute_H__
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+namespace util {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ShaderPermutations describes the variants of a shader pair that differ by a set of on/off features,
+// each feature a macro the shaders test with #if. Variants are identified by their feature bitmask,
+// and get built from the #define block for their mask. Callers record which variants they built and
+// what each costs on the device; selection then picks, for a material's required and desired
+// features, the richest built variant that fits a cost budget, or the cheapest one if none fits.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ShaderPermutations
+{
+	std::vector< std::string > name;
+	std::vector< std::string > macro;
+	std::vector< double > cost;
+	std::vector< bool > built;
+
+public:
+	// feature names are for reports and CLIs, macros are what the shaders test
+	ShaderPermutations(
+		const size_t feature_count,
+		const char* const* const feature_name,
+		const char* const* const feature_macro);
+
+	unsigned getFeatureCount() const;
+	unsigned getVariantCount() const;
+
+	// #define block of a variant, every feature macro defined to 1 or 0
+	std::string getDefines(
+		const unsigned mask) const;
+
+	// feature names of a variant joined with '+', or "none"
+	std::string getName(
+		const unsigned mask) const;
+
+	// whether a variant has all required features and no features beyond the desired ones
+	static bool within(
+		const unsigned mask,
+		const unsigned required,
+		const unsigned desired);
+
+	void setBuilt(
+		const unsigned mask);
+
+	bool isBuilt(
+		const unsigned mask) const;
+
+	// cost of a variant in arbitrary but consistent units; negative if unknown
+	void setCost(
+		const unsigned mask,
+		const double cost);
+
+	double getCost(
+		const unsigned mask) const;
+
+	// pick among the built variants within (required, desired) the one with the most features whose
+	// cost is known not to exceed the budget - the cheapest on ties, known costs before unknown ones;
+	// with no variant under budget, the cheapest one of known cost, or the one with the most features
+	// if no cost is known; a negative budget admits any cost; return -1U if no variant is built
+	unsigned select(
+		const unsigned required,
+		const unsigned desired,
+		const double budget) const;
+};
+
+} // namespace util
+
+#endif // util_permute_H__
@@ -0,0 +1,417 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+#endif
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include <iostream>
+
+#include "util_file.hpp"
+#include "util_misc.hpp"
+#include "util_preproc.hpp"
+
+namespace util {
+
+#if PLATFORM_GLES
+static const char version_header[] = "#version 100\n";
+#elif PLATFORM_GL
+static const char version_header[] = "#version 150\n";
+#else
+#error unknown platform
+#endif
+
+struct ShaderInclude
+{
+	size_t begin;      // offset of the directive line
+	size_t end;        // offset past the directive line, including its newline
+	unsigned line;     // line number of the directive
+	std::string name;
+};
+
+struct ShaderFile
+{
+	std::string text;
+	std::vector< ShaderInclude > include;
+};
+
+static std::map< std::string, ShaderFile* > g_file;
+static std::multimap< uint64_t, ShaderSource* > g_source;
+
+static uint64_t hashString(
+	const std::string& str,
+	const uint64_t basis)
+{
+	// include the terminator, so that consecutive strings cannot alias by shifting boundaries
+	return hashFNV1a(str.c_str(), str.length() + 1, basis);
+}
+
+static bool isBlank(
+	const char c)
+{
+	return ' ' == c || '\t' == c;
+}
+
+// find the #include directives of a file, once per load
+static bool parseIncludes(
+	const std::string& filename,
+	ShaderFile& file)
+{
+	const std::string& text = file.text;
+	const size_t size = text.size();
+	unsigned line = 1;
+
+	for (size_t pos = 0; pos < size; ++line) {
+		const size_t eol = text.find('\n', pos);
+		const size_t end = std::string::npos != eol ? eol + 1 : size;
+		size_t i = pos;
+
+		while (i < end && isBlank(text[i]))
+			++i;
+
+		if (i < end && '#' == text[i]) {
+			++i;
+
+			while (i < end && isBlank(text[i]))
+				++i;
+
+			static const char directive[] = "include";
+			const size_t len_directive = sizeof(directive) - 1;
+
+			if (0 == text.compare(i, len_directive, directive) &&
+				i + len_directive < end &&
+				(isBlank(text[i + len_directive]) || '"' == text[i + len_directive])) {
+
+				i += len_directive;
+
+				while (i < end && isBlank(text[i]))
+					++i;
+
+				const size_t quote = i < end && '"' == text[i] ? text.find('"', i + 1) : std::string::npos;
+
+				if (std::string::npos == quote || quote >= end || quote == i + 1) {
+					std::cerr << __FUNCTION__ << " malformed #include at " <<
+						filename << ":" << line << std::endl;
+					return false;
+				}
+
+				ShaderInclude inc;
+				inc.begin = pos;
+				inc.end = end;
+				inc.line = line;
+				inc.name.assign(text, i + 1, quote - i - 1);
+				file.include.push_back(inc);
+			}
+		}
+
+		pos = end;
+	}
+
+	return true;
+}
+
+static const ShaderFile* loadFile(
+	const std::string& filename)
+{
+	const std::map< std::string, ShaderFile* >::const_iterator it = g_file.find(filename);
+
+	if (g_file.end() != it)
+		return it->second;
+
+	size_t length;
+	char* const buffer = get_buffer_from_file(filename.c_str(), length);
+
+	if (0 == buffer) {
+		std::cerr << __FUNCTION__ <<
+			" failed to read shader file '" << filename << "'" << std::endl;
+		return 0;
+	}
+
+	ShaderFile* const file = new ShaderFile();
+	file->text.assign(buffer, length);
+	free(buffer);
+
+	if (!parseIncludes(filename, *file)) {
+		delete file;
+		return 0;
+	}
+
+	g_file[filename] = file;
+	return file;
+}
+
+// collapse "." and "dir/.." path components, so that a file reached by different relative paths
+// is recognized as the same
+static std::string normalizePath(
+	const std::string& path)
+{
+	std::vector< std::string > comp;
+	size_t pos = 0;
+
+	while (pos <= path.size()) {
+		size_t slash = path.find('/', pos);
+
+		if (std::string::npos == slash)
+			slash = path.size();
+
+		const std::string c(path, pos, slash - pos);
+		pos = slash + 1;
+
+		if (c.empty() || "." == c)
+			continue;
+
+		if (".." == c && !comp.empty() && ".." != comp.back())
+			comp.pop_back();
+		else
+			comp.push_back(c);
+	}
+
+	std::string result('/' == path[0] ? "/" : "");
+
+	for (size_t i = 0; i < comp.size(); ++i) {
+		if (0 != i)
+			result += '/';
+
+		result += comp[i];
+	}
+
+	return result;
+}
+
+// include names are relative to the directory of the including file, unless absolute
+static std::string resolveInclude(
+	const std::string& includer,
+	const std::string& name)
+{
+	if ('/' == name[0])
+		return normalizePath(name);
+
+	const size_t slash = includer.rfind('/');
+
+	if (std::string::npos == slash)
+		return normalizePath(name);
+
+	return normalizePath(includer.substr(0, slash + 1) + name);
+}
+
+struct ShaderEmitter
+{
+	std::vector< const GLchar* >& str;
+	std::vector< GLint >& len;
+	std::vector< std::string >& file;
+	std::deque< std::string >& generated;
+	std::set< std::string > seen;
+	bool at_line_start;
+
+	ShaderEmitter(
+		std::vector< const GLchar* >& str,
+		std::vector< GLint >& len,
+		std::vector< std::string >& file,
+		std::deque< std::string >& generated)
+	: str(str)
+	, len(len)
+	, file(file)
+	, generated(generated)
+	, at_line_start(true)
+	{
+	}
+
+	void span(
+		const char* const s,
+		const size_t length)
+	{
+		if (0 == length)
+			return;
+
+		str.push_back(s);
+		len.push_back(GLint(length));
+		at_line_start = '\n' == s[length - 1];
+	}
+
+	void text(
+		const std::string& s)
+	{
+		// deque growth leaves existing elements in place - pointers into them stay valid
+		generated.push_back(s);
+		span(generated.back().c_str(), generated.back().length());
+	}
+
+	// make the following line number 'line' of source string 'source'; the letter of ESSL 1.00 has
+	// #line number the line before the next one, but drivers, Mesa among them, go by the later GLSL
+	// reading where it numbers the next line - so do we, logs may be one line off elsewhere
+	void line(
+		const unsigned line,
+		const size_t source)
+	{
+		char directive[64];
+		snprintf(directive, sizeof(directive), "%s#line %u %u\n",
+			at_line_start ? "" : "\n", line, unsigned(source));
+
+		text(directive);
+	}
+
+	bool emit(
+		const std::string& filename,
+		const unsigned depth)
+	{
+		// runaway include chains can only come from a bug in this code, given the once-only rule
+		assert(depth < 64);
+
+		const ShaderFile* const f = loadFile(filename);
+
+		if (0 == f)
+			return false;
+
+		const size_t source = file.size();
+		file.push_back(filename);
+
+		line(1, source);
+		size_t pos = 0;
+
+		for (size_t i = 0; i < f->include.size(); ++i) {
+			const ShaderInclude& inc = f->include[i];
+			const std::string target = resolveInclude(filename, inc.name);
+
+			span(f->text.c_str() + pos, inc.begin - pos);
+			pos = inc.end;
+
+			// an include seen before leaves an empty line, to keep the line count
+			if (!seen.insert(target).second) {
+				span("\n", 1);
+				continue;
+			}
+
+			if (!emit(target, depth + 1)) {
+				std::cerr << "  included from " << filename << ":" << inc.line << std::endl;
+				return false;
+			}
+
+			line(inc.line + 1, source);
+		}
+
+		span(f->text.c_str() + pos, f->text.size() - pos);
+		return true;
+	}
+};
+
+const ShaderSource* preprocessShader(
+	const char* const filename,
+	const std::string& defines)
+{
+	assert(0 != filename);
+
+	const uint64_t key = hashString(defines, hashString(filename, hashFNV1a(0, 0)));
+	typedef std::multimap< uint64_t, ShaderSource* >::const_iterator iterator;
+	const std::pair< iterator, iterator > range = g_source.equal_range(key);
+
+	for (iterator it = range.first; it != range.second; ++it)
+		if (it->second->filename == filename && it->second->defines == defines)
+			return it->second;
+
+	ShaderSource* const src = new ShaderSource();
+	src->filename = filename;
+	src->defines = defines;
+
+	ShaderEmitter emitter(src->str, src->len, src->file, src->generated);
+
+	emitter.file.push_back("<header>");
+	emitter.span(version_header, sizeof(version_header) - 1);
+	emitter.span(src->defines.c_str(), src->defines.length());
+
+	const std::string root = normalizePath(filename);
+	emitter.seen.insert(root);
+
+	if (!emitter.emit(root, 0)) {
+		delete src;
+		return 0;
+	}
+
+	uint64_t hash = hashFNV1a(0, 0);
+
+	for (size_t i = 0; i < src->str.size(); ++i)
+		hash = hashFNV1a(src->str[i], src->len[i], hash);
+
+	src->hash = hash;
+
+	g_source.insert(std::make_pair(key, src));
+	return src;
+}
+
+void clearShaderCache()
+{
+	for (std::multimap< uint64_t, ShaderSource* >::iterator it = g_source.begin(); it != g_source.end(); ++it)
+		delete it->second;
+
+	for (std::map< std::string, ShaderFile* >::iterator it = g_file.begin(); it != g_file.end(); ++it)
+		delete it->second;
+
+	g_source.clear();
+	g_file.clear();
+}
+
+bool isShaderFileLoaded(
+	const char* const filename)
+{
+	assert(0 != filename);
+	return 0 != g_file.count(normalizePath(filename));
+}
+
+// GLSL float literal that reads back as the same float
+static std::string floatLiteral(
+	const float value)
+{
+	assert(isfinite(value));
+
+	char str[32];
+	snprintf(str, sizeof(str), "%.9g", value);
+
+	std::string literal(str);
+
+	if (std::string::npos == literal.find_first_of(".e"))
+		literal += ".0";
+
+	return '-' == literal[0] ? "(" + literal + ")" : literal;
+}
+
+static std::string specDefine(
+	const char* const name,
+	const std::string& value)
+{
+	assert(0 != name);
+	return std::string("#define SPEC_") + name + " " + value + "\n";
+}
+
+SpecConstants& SpecConstants::set(
+	const char* const name,
+	const float value)
+{
+	defines += specDefine(name, floatLiteral(value));
+	return *this;
+}
+
+SpecConstants& SpecConstants::set(
+	const char* const name,
+	const int value)
+{
+	char str[16];
+	snprintf(str, sizeof(str), value < 0 ? "(%d)" : "%d", value);
+
+	defines += specDefine(name, str);
+	return *this;
+}
+
+const std::string& SpecConstants::getDefines() const
+{
+	return defines;
+}
+
+} // namespace util
@@ -0,0 +1,97 @@
+#ifndef util_preproc_H__
+#define util_preproc_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+#endif
+
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace util {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Shader preprocessor. A shader file gets prefixed with a header of the platform's #version line and
+// any caller-supplied #define block, and its #include "file" directives get resolved, relative to the
+// including file. Each file is included at most once per shader, as if it had #pragma once. Directives
+// are recognized at line starts regardless of conditional blocks - includes are unconditional.
+//
+// The result is not a single string but a list of strings for glShaderSource, most of which point
+// straight into the loaded files; #line directives between them keep compile logs referring to the
+// right file and line. Files are loaded once, and results are cached by a hash of their file name and
+// define block, so rebuilding a shader with the same defines costs a lookup.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ShaderSource
+{
+	friend const ShaderSource* preprocessShader(const char* const, const std::string&);
+
+	std::vector< const GLchar* > str;
+	std::vector< GLint > len;
+	std::vector< std::string > file;
+	std::deque< std::string > generated;
+	std::string filename;
+	std::string defines;
+	uint64_t hash;
+
+public:
+	// strings and their lengths, ready for glShaderSource
+	GLsizei count() const { return GLsizei(str.size()); }
+	const GLchar* const* strings() const { return &str[0]; }
+	const GLint* lengths() const { return &len[0]; }
+
+	// hash of the preprocessed text
+	uint64_t getHash() const { return hash; }
+
+	// files contributing to the source, by source-string number as used by #line and in compile logs;
+	// number 0 is the header
+	size_t getFileCount() const { return file.size(); }
+	const char* getFile(const size_t i) const { return file[i].c_str(); }
+};
+
+// preprocess a shader file with the given block of #define lines, which may be empty; return nil
+// on error; results stay valid until clearShaderCache
+const ShaderSource* preprocessShader(
+	const char* const filename,
+	const std::string& defines);
+
+// drop all loaded files and preprocessed results, e.g. after files changed
+void clearShaderCache();
+
+// whether a file has been loaded as a shader or an include since the last clearShaderCache, i.e.
+// whether a change to it may affect preprocessed results
+bool isShaderFileLoaded(
+	const char* const filename);
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// SpecConstants emulates specialization constants: values that stay fixed for a run get baked into
+// shaders as #define SPEC_<name> <literal>, for the compiler to fold; shaders fall back to uniforms
+// for values that are not specialized. The defines become part of the preprocessed source, so the
+// program cache keeps a binary per value set.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class SpecConstants
+{
+	std::string defines;
+
+public:
+	SpecConstants& set(
+		const char* const name,
+		const float value);
+
+	SpecConstants& set(
+		const char* const name,
+		const int value);
+
+	// #define block of all values set so far, in order of setting
+	const std::string& getDefines() const;
+};
+
+} // namespace util
+
+#endif // util_preproc_H__
@@ -0,0 +1,553 @@
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <EGL/egl.h>
+	#include <GLES2/gl2.h>
+	#include <GLES2/gl2ext.h>
+#endif
+
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <iostream>
+
+#include "util_file.hpp"
+#include "util_misc.hpp"
+#include "util_preproc.hpp"
+#include "util_progcache.hpp"
+
+#ifndef GL_KHR_parallel_shader_compile
+#define GL_KHR_parallel_shader_compile 1
+#define GL_MAX_SHADER_COMPILER_THREADS_KHR 0x91B0
+#define GL_COMPLETION_STATUS_KHR           0x91B1
+typedef void (GL_APIENTRYP PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) (GLuint count);
+#endif
+
+namespace util {
+
+#if PLATFORM_GLES && PLATFORM_GL_OES_get_program_binary
+static PFNGLGETPROGRAMBINARYOESPROC glGetProgramBinaryOES;
+static PFNGLPROGRAMBINARYOESPROC    glProgramBinaryOES;
+
+enum CacheState {
+	CACHE_UNINITIALIZED,
+	CACHE_ACTIVE,
+	CACHE_INACTIVE,
+
+	CACHE_FORCE_UINT = -1U
+};
+
+static CacheState g_cache_state = CACHE_UNINITIALIZED;
+static std::string g_cache_dir;
+static bool g_cache_dir_set;
+
+// cache entry: header followed by the program binary
+struct CacheHeader
+{
+	uint32_t magic;
+	uint32_t binary_format;
+	uint32_t binary_length;
+	uint32_t reserved;
+	uint64_t key;
+};
+
+static const uint32_t cache_magic = 0x4e494250; // 'PBIN', format v1
+
+static uint64_t hashString(
+	const std::string& str,
+	const uint64_t basis)
+{
+	// include the terminator, so that consecutive strings cannot alias by shifting boundaries
+	return hashFNV1a(str.c_str(), str.length() + 1, basis);
+}
+
+static bool makeDirectory(
+	const std::string& path)
+{
+	for (size_t pos = path.find('/', 1); ; pos = path.find('/', pos + 1)) {
+		const std::string sub(path, 0, pos);
+
+		if (0 != mkdir(sub.c_str(), 0755) && EEXIST != errno)
+			return false;
+
+		if (std::string::npos == pos)
+			return true;
+	}
+}
+
+static bool initCache()
+{
+	if (CACHE_UNINITIALIZED != g_cache_state)
+		return CACHE_ACTIVE == g_cache_state;
+
+	g_cache_state = CACHE_INACTIVE;
+
+	if (!g_cache_dir_set) {
+		const char* const xdg_cache = getenv("XDG_CACHE_HOME");
+		const char* const home = getenv("HOME");
+
+		if (0 != xdg_cache && '\0' != xdg_cache[0])
+			g_cache_dir = std::string(xdg_cache) + "/hello-gles/progcache";
+		else
+		if (0 != home && '\0' != home[0])
+			g_cache_dir = std::string(home) + "/.cache/hello-gles/progcache";
+	}
+
+	if (g_cache_dir.empty())
+		return false;
+
+	if (!hasExtension("GL_OES_get_program_binary")) {
+		std::cout << "program cache inactive: no GL_OES_get_program_binary" << std::endl;
+		return false;
+	}
+
+	GLint num_formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS_OES, &num_formats);
+
+	if (0 == num_formats) {
+		std::cout << "program cache inactive: no program binary formats" << std::endl;
+		return false;
+	}
+
+	glGetProgramBinaryOES = (PFNGLGETPROGRAMBINARYOESPROC) eglGetProcAddress("glGetProgramBinaryOES");
+	glProgramBinaryOES    = (PFNGLPROGRAMBINARYOESPROC)    eglGetProcAddress("glProgramBinaryOES");
+
+	if (0 == glGetProgramBinaryOES || 0 == glProgramBinaryOES)
+		return false;
+
+	if (!makeDirectory(g_cache_dir)) {
+		std::cerr << __FUNCTION__ << " cannot create cache directory '" << g_cache_dir << "'" << std::endl;
+		return false;
+	}
+
+	std::cout << "program cache: " << g_cache_dir << std::endl;
+	g_cache_state = CACHE_ACTIVE;
+	return true;
+}
+
+static std::string getEntryFilename(
+	const uint64_t key)
+{
+	char name[32];
+	snprintf(name, sizeof(name), "/%016llx.bin", (unsigned long long) key);
+
+	return g_cache_dir + name;
+}
+
+static bool loadProgramBinary(
+	const GLuint prog,
+	const uint64_t key)
+{
+	const std::string filename = getEntryFilename(key);
+
+	// a miss is the normal case on first launch; don't bother get_buffer_from_file with it
+	if (0 != access(filename.c_str(), R_OK))
+		return false;
+
+	size_t size;
+	char* const buffer = get_buffer_from_file(filename.c_str(), size);
+
+	if (0 == buffer)
+		return false;
+
+	const CacheHeader* const header = reinterpret_cast< const CacheHeader* >(buffer);
+	bool success = false;
+
+	if (size > sizeof(CacheHeader) &&
+		cache_magic == header->magic &&
+		key == header->key &&
+		size - sizeof(CacheHeader) == header->binary_length) {
+
+		glProgramBinaryOES(prog, header->binary_format, buffer + sizeof(CacheHeader), header->binary_length);
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(prog, GL_LINK_STATUS, &status);
+
+		// drivers may reject binaries after an update that kept the version string, or for no
+		// stated reason at all; neither is an error
+		success = GL_TRUE == status;
+		glGetError();
+	}
+
+	free(buffer);
+
+	if (!success) {
+		std::cout << "program cache evict: " << filename << std::endl;
+		unlink(filename.c_str());
+	}
+
+	return success;
+}
+
+static void storeProgramBinary(
+	const GLuint prog,
+	const uint64_t key)
+{
+	GLint length = 0;
+	glGetProgramiv(prog, GL_PROGRAM_BINARY_LENGTH_OES, &length);
+
+	if (0 >= length)
+		return;
+
+	std::vector< char > buffer(sizeof(CacheHeader) + length);
+	CacheHeader& header = *reinterpret_cast< CacheHeader* >(&buffer[0]);
+
+	GLenum format = 0;
+	GLsizei written = 0;
+	glGetProgramBinaryOES(prog, length, &written, &format, &buffer[sizeof(CacheHeader)]);
+
+	if (reportGLError() || written != length)
+		return;
+
+	header.magic = cache_magic;
+	header.binary_format = format;
+	header.binary_length = uint32_t(length);
+	header.reserved = 0;
+	header.key = key;
+
+	// write under a temporary name and rename, so that concurrent or interrupted runs never see a
+	// partial entry
+	const std::string filename = getEntryFilename(key);
+	const std::string filename_tmp = filename + ".tmp";
+
+	FILE* const f = fopen(filename_tmp.c_str(), "wb");
+
+	if (0 == f)
+		return;
+
+	const bool success = buffer.size() == fwrite(&buffer[0], 1, buffer.size(), f);
+	fclose(f);
+
+	if (!success || 0 != rename(filename_tmp.c_str(), filename.c_str())) {
+		unlink(filename_tmp.c_str());
+		return;
+	}
+
+	std::cout << "program cache store: " << filename << std::endl;
+}
+
+static uint64_t getProgramKey(
+	const ShaderSource& src_vert,
+	const ShaderSource& src_frag)
+{
+	const GLenum driver_str[] = { GL_VENDOR, GL_RENDERER, GL_VERSION };
+	uint64_t key = hashFNV1a(0, 0);
+
+	for (size_t i = 0; i < sizeof(driver_str) / sizeof(driver_str[0]); ++i) {
+		const char* const str = reinterpret_cast< const char* >(glGetString(driver_str[i]));
+		key = hashString(0 != str ? str : "", key);
+	}
+
+	const uint64_t src_hash[] = { src_vert.getHash(), src_frag.getHash() };
+	key = hashFNV1a(src_hash, sizeof(src_hash), key);
+
+	// binaries keep the attribute locations they got linked with
+	for (unsigned i = 0; i < ATTR_LOC_COUNT; ++i)
+		key = hashString(getAttrName(AttrLocation(i)), key);
+
+	return key;
+}
+
+#else
+static bool initCache()
+{
+	return false;
+}
+
+static uint64_t getProgramKey(
+	const ShaderSource&,
+	const ShaderSource&)
+{
+	return 0;
+}
+
+static bool loadProgramBinary(
+	const GLuint,
+	const uint64_t)
+{
+	return false;
+}
+
+static void storeProgramBinary(
+	const GLuint,
+	const uint64_t)
+{
+}
+
+#endif
+void setProgramCacheDir(
+	const char* const path)
+{
+#if PLATFORM_GLES && PLATFORM_GL_OES_get_program_binary
+	assert(CACHE_UNINITIALIZED == g_cache_state);
+
+	g_cache_dir = 0 != path ? path : "";
+	g_cache_dir_set = true;
+
+#endif
+}
+
+#if PLATFORM_GLES
+static PFNGLMAXSHADERCOMPILERTHREADSKHRPROC glMaxShaderCompilerThreadsKHR;
+
+#endif
+static bool g_parallel_compile;
+static bool g_parallel_compile_checked;
+
+static bool initParallelCompile()
+{
+	if (g_parallel_compile_checked)
+		return g_parallel_compile;
+
+	g_parallel_compile_checked = true;
+
+#if PLATFORM_GLES
+	if (!hasExtension("GL_KHR_parallel_shader_compile"))
+		return false;
+
+	glMaxShaderCompilerThreadsKHR = (PFNGLMAXSHADERCOMPILERTHREADSKHRPROC) eglGetProcAddress("glMaxShaderCompilerThreadsKHR");
+
+	if (0 == glMaxShaderCompilerThreadsKHR)
+		return false;
+
+	// let the driver pick the number of threads
+	glMaxShaderCompilerThreadsKHR(0xffffffff);
+	g_parallel_compile = true;
+
+#endif
+	return g_parallel_compile;
+}
+
+static void reportShaderLog(
+	const GLuint shader,
+	const ShaderSource& src)
+{
+	GLint success = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+
+	if (GL_TRUE == success)
+		return;
+
+	GLint len = 0;
+	glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &len);
+	std::vector< GLchar > log(len + 1);
+	glGetShaderInfoLog(shader, len, NULL, &log[0]);
+
+	std::cerr << "shader compile log: " << &log[0] << std::endl;
+
+	// logs refer to files by source-string number
+	for (size_t i = 0; i < src.getFileCount(); ++i)
+		std::cerr << "  source " << i << ": " << src.getFile(i) << std::endl;
+}
+
+static void reportProgramLog(
+	const GLuint prog)
+{
+	GLint len = 0;
+	glGetProgramiv(prog, GL_INFO_LOG_LENGTH, &len);
+	std::vector< GLchar > log(len + 1);
+	glGetProgramInfoLog(prog, len, NULL, &log[0]);
+
+	std::cerr << "shader link log: " << &log[0] << std::endl;
+}
+
+ProgramBatch::ProgramBatch()
+: num_cached(0)
+, t_submit(0)
+, t_submitted(0)
+{
+}
+
+bool ProgramBatch::add(
+	const GLuint prog,
+	const GLuint shader_vert,
+	const GLuint shader_frag,
+	const char* const filename_vert,
+	const char* const filename_frag,
+	const std::string& defines)
+{
+	assert(0 != filename_vert);
+	assert(0 != filename_frag);
+	assert(0 == t_submit);
+
+	if (GL_FALSE == glIsProgram(prog) ||
+		GL_FALSE == glIsShader(shader_vert) ||
+		GL_FALSE == glIsShader(shader_frag)) {
+
+		std::cerr << __FUNCTION__ <<
+			" argument is not a valid program or shader object" << std::endl;
+		return false;
+	}
+
+	Entry e;
+	e.prog = prog;
+	e.shader_vert = shader_vert;
+	e.shader_frag = shader_frag;
+	e.src_vert = preprocessShader(filename_vert, defines);
+	e.src_frag = preprocessShader(filename_frag, defines);
+	e.cached = false;
+
+	if (0 == e.src_vert || 0 == e.src_frag) {
+		std::cerr << __FUNCTION__ << " failed at preprocessShader" << std::endl;
+		return false;
+	}
+
+	e.key = getProgramKey(*e.src_vert, *e.src_frag);
+	entry.push_back(e);
+	return true;
+}
+
+bool ProgramBatch::submit()
+{
+	assert(0 == t_submit);
+	t_submit = time_ns();
+
+#if PLATFORM_GLES
+	GLboolean compiler_present = GL_FALSE;
+	glGetBooleanv(GL_SHADER_COMPILER, &compiler_present);
+
+#endif
+	const bool cache = initCache();
+	initParallelCompile();
+
+	// compile everything first, link everything next, and query nothing before finish; that leaves
+	// the driver free to work on all of it in the background
+	for (size_t i = 0; i < entry.size(); ++i) {
+		Entry& e = entry[i];
+
+		if (cache && loadProgramBinary(e.prog, e.key)) {
+			e.cached = true;
+			++num_cached;
+			continue;
+		}
+
+#if PLATFORM_GLES
+		if (GL_TRUE != compiler_present) {
+			std::cerr << "no shader compiler present (binary only)" << std::endl;
+			return false;
+		}
+
+#endif
+		// sources go as lists of strings straight from the preprocessor, not concatenated
+		glShaderSource(e.shader_vert, e.src_vert->count(), e.src_vert->strings(), e.src_vert->lengths());
+		glCompileShader(e.shader_vert);
+		glShaderSource(e.shader_frag, e.src_frag->count(), e.src_frag->strings(), e.src_frag->lengths());
+		glCompileShader(e.shader_frag);
+	}
+
+	for (size_t i = 0; i < entry.size(); ++i) {
+		const Entry& e = entry[i];
+
+		if (e.cached)
+			continue;
+
+		glAttachShader(e.prog, e.shader_vert);
+		glAttachShader(e.prog, e.shader_frag);
+		bindAttribLocations(e.prog);
+		glLinkProgram(e.prog);
+	}
+
+	t_submitted = time_ns();
+
+	if (reportGLError()) {
+		std::cerr << __FUNCTION__ << " failed submitting programs" << std::endl;
+		return false;
+	}
+
+	return true;
+}
+
+bool ProgramBatch::ready() const
+{
+	assert(0 != t_submit);
+
+	if (!g_parallel_compile)
+		return true;
+
+	for (size_t i = 0; i < entry.size(); ++i) {
+		if (entry[i].cached)
+			continue;
+
+		GLint complete = GL_FALSE;
+		glGetProgramiv(entry[i].prog, GL_COMPLETION_STATUS_KHR, &complete);
+
+		if (GL_TRUE != complete)
+			return false;
+	}
+
+	return true;
+}
+
+bool ProgramBatch::finish()
+{
+	assert(0 != t_submit);
+
+	const uint64_t t_finish = time_ns();
+	bool success = true;
+
+	for (size_t i = 0; i < entry.size(); ++i) {
+		const Entry& e = entry[i];
+
+		if (e.cached)
+			continue;
+
+		GLint linked = GL_FALSE;
+		glGetProgramiv(e.prog, GL_LINK_STATUS, &linked);
+
+		if (GL_TRUE != linked) {
+			reportShaderLog(e.shader_vert, *e.src_vert);
+			reportShaderLog(e.shader_frag, *e.src_frag);
+			reportProgramLog(e.prog);
+			success = false;
+		}
+	}
+
+	const uint64_t t_done = time_ns();
+
+	if (!success)
+		return false;
+
+	for (size_t i = 0; i < entry.size(); ++i)
+		if (!entry[i].cached)
+			storeProgramBinary(entry[i].prog, entry[i].key);
+
+	std::cout << "program batch: " << entry.size() << " programs, " << num_cached << " from cache, " <<
+		(g_parallel_compile ? "parallel" : "serial") << " compile; submit " <<
+		(t_submitted - t_submit) * 1e-6 << " ms, blocked at finish " <<
+		(t_done - t_finish) * 1e-6 << " ms" << std::endl;
+
+	// builds still pending after submit ran alongside whatever the caller did until finish; that is
+	// the wall time saved over building and checking program by program - all of it when finish had
+	// to block, up to it otherwise
+	if (num_cached < entry.size())
+		std::cout << "program batch: build overlapped other work by " <<
+			(t_done > t_finish + 100000 ? "" : "up to ") <<
+			(t_finish - t_submitted) * 1e-6 << " ms" << std::endl;
+
+	return true;
+}
+
+bool setupProgramCached(
+	const GLuint prog,
+	const GLuint shader_vert,
+	const GLuint shader_frag,
+	const char* const filename_vert,
+	const char* const filename_frag,
+	const std::string& defines)
+{
+	ProgramBatch batch;
+
+	return
+		batch.add(prog, shader_vert, shader_frag, filename_vert, filename_frag, defines) &&
+		batch.submit() &&
+		batch.finish();
+}
+
+} // namespace util
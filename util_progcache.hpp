@@ -0,0 +1,92 @@
+#ifndef util_progcache_H__
+#define util_progcache_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#if PLATFORM_GL
+	#include <GL/gl.h>
+#else
+	#include <GLES2/gl2.h>
+#endif
+
+#include <string>
+#include <vector>
+
+namespace util {
+
+class ShaderSource;
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// Program binary cache, via GL_OES_get_program_binary. Programs are keyed by a hash of their
+// preprocessed sources, the fixed attribute locations, and the driver vendor, renderer and version;
+// a hit skips compilation and linking altogether. Binaries the driver rejects get evicted, and the
+// program gets built from source. The cache is inactive on platforms and drivers without the
+// extension, where programs always get built from source.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// set the cache directory, 0 to disable the cache; default is $XDG_CACHE_HOME/hello-gles/progcache,
+// or ~/.cache/hello-gles/progcache; takes effect before the first cached program setup only
+void setProgramCacheDir(
+	const char* const path);
+
+// preprocess both shaders with the given block of #define lines, compile them and link the program,
+// going through the program cache - a batch of one; on a hit the shader objects get no source
+bool setupProgramCached(
+	const GLuint prog,
+	const GLuint shader_vert,
+	const GLuint shader_frag,
+	const char* const filename_vert,
+	const char* const filename_frag,
+	const std::string& defines = std::string());
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// ProgramBatch builds a set of programs with deferred status queries: submit kicks off compilation
+// and linking of all programs without waiting on any of them, and finish collects the results. Work
+// done between the two overlaps with the driver's compilation, which runs on multiple threads where
+// GL_KHR_parallel_shader_compile is available. Programs go through the program cache, and get linked
+// with attributes at their fixed locations (see util::bindAttribLocations).
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class ProgramBatch
+{
+	struct Entry {
+		GLuint prog;
+		GLuint shader_vert;
+		GLuint shader_frag;
+		const ShaderSource* src_vert;
+		const ShaderSource* src_frag;
+		uint64_t key;
+		bool cached;
+	};
+
+	std::vector< Entry > entry;
+	unsigned num_cached;
+	uint64_t t_submit;
+	uint64_t t_submitted;
+
+public:
+	ProgramBatch();
+
+	// preprocess the shaders of a program with the given block of #define lines, and queue it
+	bool add(
+		const GLuint prog,
+		const GLuint shader_vert,
+		const GLuint shader_frag,
+		const char* const filename_vert,
+		const char* const filename_frag,
+		const std::string& defines = std::string());
+
+	// start building all queued programs
+	bool submit();
+
+	// poll for completion without blocking; always true without GL_KHR_parallel_shader_compile
+	bool ready() const;
+
+	// wait for all programs, report failures with their logs and store new binaries in the cache;
+	// return false if any program failed
+	bool finish();
+};
+
+} // namespace util
+
+#endif // util_progcache_H__
@@ -19,7 +19,7 @@ public:
 	}
 };
 
-static size_t integral_size(
+size_t integral_size(
 	const size_t size)
 {
 	if (0 == (size & (size - 1)))
@@ -68,12 +68,12 @@ static bool fill_from_file(
 	return false;
 }
 
-static void fill_with_checker(
+void fill_with_checker(
 	pix* const buffer,
 	const unsigned stride,
 	const unsigned dim_x,
 	const unsigned dim_y,
-	const unsigned granularity = 8)
+	const unsigned granularity)
 {
 	const pix pixA(255U, 128U, 128U);
 	const pix pixB(128U, 128U, 255U);
@@ -130,6 +130,36 @@ bool setupTexture2D(
 	return success;
 }
 
+bool loadTexture2D(
+	const GLuint tex_name,
+	const char* const filename,
+	unsigned& tex_w,
+	unsigned& tex_h,
+	const bool sampleNearest)
+{
+	assert(0 != tex_name);
+	assert(0 != filename);
+
+	size_t fileSize;
+
+	// provide some guardband as pixels are of non-word-multiple size
+	scoped_ptr< pix, generic_free > tex_src(
+		reinterpret_cast< pix* >(get_buffer_from_file(filename, fileSize, integral_size(sizeof(pix)))));
+
+	if (0 == tex_src() || !fill_from_file(tex_src(), tex_w, tex_h, fileSize)) {
+		fprintf(stderr, "%s failed to read texture bitmap '%s'\n", __FUNCTION__, filename);
+		return false;
+	}
+
+	fprintf(stdout, "texture bitmap '%s' ", filename);
+	const size_t header_size = sizeof(uint32_t[2]);
+
+	const pix* const start = reinterpret_cast< pix*>(
+		reinterpret_cast< uint8_t* >(tex_src()) + header_size);
+
+	return setupTexture2D(tex_name, start, tex_w, tex_h, sampleNearest);
+}
+
 bool setupTexture2D(
 	const GLuint tex_name,
 	const char* const filename,
@@ -1,6 +1,7 @@
 #ifndef util_tex_H__
 #define util_tex_H__
 
+#include <stddef.h>
 #include <stdint.h>
 #if PLATFORM_GL
 	#include <GL/gl.h>
@@ -25,6 +26,18 @@ struct pix
 	}
 };
 
+// smallest power of two not less than the given size
+size_t integral_size(
+	const size_t size);
+
+// fill a pitched buffer with a two-tone checker of the given granularity (a power of two)
+void fill_with_checker(
+	pix* const buffer,
+	const unsigned stride,
+	const unsigned dim_x,
+	const unsigned dim_y,
+	const unsigned granularity = 8);
+
 bool setupTexture2D(
 	const GLuint tex_name,
 	const pix* const buffer,
@@ -32,6 +45,8 @@ bool setupTexture2D(
 	const unsigned tex_h,
 	const bool sampleNearest = false);
 
+// set up a texture from a raw bitmap file, or from a checker of the given dimensions if the file is
+// missing or malformed
 bool setupTexture2D(
 	const GLuint tex_name,
 	const char* const filename,
@@ -39,6 +54,15 @@ bool setupTexture2D(
 	unsigned& tex_h,
 	const bool sampleNearest = false);
 
+// as above, but fail on a missing or malformed file instead of falling back to a checker, e.g. when
+// replacing a texture in use
+bool loadTexture2D(
+	const GLuint tex_name,
+	const char* const filename,
+	unsigned& tex_w,
+	unsigned& tex_h,
+	const bool sampleNearest = false);
+
 } // namespace util
 
 #endif // util_tex_H__
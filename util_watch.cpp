@@ -0,0 +1,95 @@
+#include <sys/inotify.h>
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iostream>
+
+#include "util_watch.hpp"
+
+namespace util {
+
+FileWatcher::FileWatcher()
+: fd(-1)
+{
+}
+
+FileWatcher::~FileWatcher()
+{
+	if (-1 != fd)
+		close(fd);
+}
+
+bool FileWatcher::addDirectory(
+	const char* const path)
+{
+	assert(0 != path);
+
+	if (-1 == fd) {
+		fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+		if (-1 == fd) {
+			std::cerr << __FUNCTION__ << " failed at inotify_init1: " << strerror(errno) << std::endl;
+			return false;
+		}
+	}
+
+	const int w = inotify_add_watch(fd, path, IN_CLOSE_WRITE | IN_MOVED_TO);
+
+	if (-1 == w) {
+		std::cerr << __FUNCTION__ << " cannot watch '" << path << "': " << strerror(errno) << std::endl;
+		return false;
+	}
+
+	wd.push_back(w);
+	dir.push_back(strcmp(path, ".") ? std::string(path) + "/" : std::string());
+	return true;
+}
+
+bool FileWatcher::poll(
+	std::vector< std::string >& changed)
+{
+	changed.clear();
+
+	if (-1 == fd)
+		return false;
+
+	// inotify hands out whole events only; this fits a few dozen at a time
+	char buffer[4096] __attribute__ ((aligned(__alignof__(inotify_event))));
+
+	for (;;) {
+		const ssize_t len = read(fd, buffer, sizeof(buffer));
+
+		if (0 >= len) {
+			if (-1 == len && EAGAIN != errno && EINTR != errno)
+				std::cerr << __FUNCTION__ << " failed at read: " << strerror(errno) << std::endl;
+
+			break;
+		}
+
+		for (ssize_t pos = 0; pos < len; ) {
+			const inotify_event& event = *reinterpret_cast< const inotify_event* >(buffer + pos);
+			pos += sizeof(inotify_event) + event.len;
+
+			if (0 == event.len || (event.mask & IN_ISDIR))
+				continue;
+
+			const std::vector< int >::const_iterator it = std::find(wd.begin(), wd.end(), event.wd);
+
+			if (wd.end() == it)
+				continue;
+
+			const std::string name = dir[it - wd.begin()] + event.name;
+
+			if (changed.end() == std::find(changed.begin(), changed.end(), name))
+				changed.push_back(name);
+		}
+	}
+
+	return !changed.empty();
+}
+
+} // namespace util
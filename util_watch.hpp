@@ -0,0 +1,38 @@
+#ifndef util_watch_H__
+#define util_watch_H__
+
+#include <string>
+#include <vector>
+
+namespace util {
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+// FileWatcher reports files written in a set of directories, via inotify. Polling never blocks, so it
+// fits between frames. A file counts as changed once it is closed after writing or moved into place,
+// which covers both editors that rewrite files and those that save to a temporary and rename.
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+class FileWatcher
+{
+	int fd;
+	std::vector< int > wd;
+	std::vector< std::string > dir;
+
+public:
+	FileWatcher();
+	~FileWatcher();
+
+	// start watching a directory; files in the current directory are reported by bare name, files
+	// elsewhere prefixed with their directory as given here
+	bool addDirectory(
+		const char* const path);
+
+	// collect the names of all files changed since the last poll, each name once; return false if
+	// none changed
+	bool poll(
+		std::vector< std::string >& changed);
+};
+
+} // namespace util
+
+#endif // util_watch_H__